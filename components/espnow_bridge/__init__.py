@@ -0,0 +1,66 @@
+import esphome.codegen as cg
+from esphome.components import espnow
+import esphome.config_validation as cv
+from esphome.const import CONF_ID, CONF_LISTEN_PORT
+
+DEPENDENCIES = ["espnow", "network"]
+AUTO_LOAD = ["socket"]
+CODEOWNERS = ["@jason"]
+
+espnow_bridge_ns = cg.esphome_ns.namespace("espnow_bridge")
+ESPNowBridge = espnow_bridge_ns.class_(
+    "ESPNowBridge",
+    cg.Component,
+    cg.Parented.template(espnow.ESPNowComponent),
+    espnow.ESPNowReceivedPacketHandler,
+    espnow.ESPNowBroadcastedHandler,
+)
+
+CONF_ALLOWED_REMOTES = "allowed_remotes"
+CONF_ESPNOW_ID = "espnow_id"
+CONF_FLUSH_INTERVAL = "flush_interval"
+CONF_FORWARD_BROADCASTS = "forward_broadcasts"
+CONF_MAX_DATAGRAM_SIZE = "max_datagram_size"
+CONF_REMOTE_ADDRESS = "remote_address"
+CONF_REMOTE_PORT = "remote_port"
+
+# Must match MAX_BRIDGE_DATAGRAM_SIZE in espnow_bridge.h
+MAX_BRIDGE_DATAGRAM_SIZE = 1400
+
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(ESPNowBridge),
+        cv.GenerateID(CONF_ESPNOW_ID): cv.use_id(espnow.ESPNowComponent),
+        cv.Required(CONF_REMOTE_ADDRESS): cv.ipv4address,
+        cv.Optional(CONF_REMOTE_PORT, default=18888): cv.port,
+        # Datagrams received on this port are sent out over ESP-NOW
+        cv.Optional(CONF_LISTEN_PORT): cv.port,
+        # Hosts whose datagrams are accepted on the listen port, defaults to remote_address
+        cv.Optional(CONF_ALLOWED_REMOTES): cv.All(
+            cv.ensure_list(cv.ipv4address), cv.Length(min=1)
+        ),
+        # A batch is flushed when the next frame would not fit or it has waited this long
+        cv.Optional(CONF_MAX_DATAGRAM_SIZE, default=MAX_BRIDGE_DATAGRAM_SIZE): cv.int_range(
+            min=300, max=MAX_BRIDGE_DATAGRAM_SIZE
+        ),
+        cv.Optional(
+            CONF_FLUSH_INTERVAL, default="50ms"
+        ): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_FORWARD_BROADCASTS, default=True): cv.boolean,
+    }
+).extend(cv.COMPONENT_SCHEMA)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+    await cg.register_parented(var, config[CONF_ESPNOW_ID])
+
+    cg.add(var.set_remote(str(config[CONF_REMOTE_ADDRESS]), config[CONF_REMOTE_PORT]))
+    if CONF_LISTEN_PORT in config:
+        cg.add(var.set_listen_port(config[CONF_LISTEN_PORT]))
+        for remote in config.get(CONF_ALLOWED_REMOTES, [config[CONF_REMOTE_ADDRESS]]):
+            cg.add(var.add_allowed_remote(str(remote)))
+    cg.add(var.set_max_datagram_size(config[CONF_MAX_DATAGRAM_SIZE]))
+    cg.add(var.set_flush_interval(config[CONF_FLUSH_INTERVAL]))
+    cg.add(var.set_forward_broadcasts(config[CONF_FORWARD_BROADCASTS]))
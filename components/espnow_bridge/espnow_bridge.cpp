@@ -0,0 +1,249 @@
+#include "espnow_bridge.h"
+
+#ifdef USE_ESP32
+
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+#include "esphome/components/network/util.h"
+
+#include <cstring>
+
+namespace esphome {
+namespace espnow_bridge {
+
+static const char *const TAG = "espnow_bridge";
+
+void ESPNowBridge::setup() {
+  this->socket_ = socket::socket_ip(SOCK_DGRAM, IPPROTO_IP);
+  if (this->socket_ == nullptr) {
+    ESP_LOGE(TAG, "Could not create socket");
+    this->mark_failed();
+    return;
+  }
+  this->remote_addr_len_ = socket::set_sockaddr(reinterpret_cast<struct sockaddr *>(&this->remote_addr_),
+                                                sizeof(this->remote_addr_), this->remote_address_, this->remote_port_);
+  if (this->remote_addr_len_ == 0) {
+    ESP_LOGE(TAG, "Invalid remote address %s", this->remote_address_.c_str());
+    this->mark_failed();
+    return;
+  }
+
+  if (this->listen_port_ != 0) {
+    this->listen_socket_ = socket::socket_ip(SOCK_DGRAM, IPPROTO_IP);
+    if (this->listen_socket_ == nullptr) {
+      ESP_LOGE(TAG, "Could not create listen socket");
+      this->mark_failed();
+      return;
+    }
+    int enable = 1;
+    this->listen_socket_->setsockopt(SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    this->listen_socket_->setblocking(false);
+    struct sockaddr_storage server {};
+    socklen_t server_len = socket::set_sockaddr_any(reinterpret_cast<struct sockaddr *>(&server), sizeof(server),
+                                                    this->listen_port_);
+    if (this->listen_socket_->bind(reinterpret_cast<struct sockaddr *>(&server), server_len) != 0) {
+      ESP_LOGE(TAG, "Could not bind to port %u, errno %d", this->listen_port_, errno);
+      this->mark_failed();
+      return;
+    }
+    for (const auto &remote : this->allowed_remotes_) {
+      struct sockaddr_storage allowed {};
+      socket::set_sockaddr(reinterpret_cast<struct sockaddr *>(&allowed), sizeof(allowed), remote, 0);
+      if (allowed.ss_family != AF_INET) {
+        ESP_LOGW(TAG, "Ignoring allowed remote %s, not an IPv4 address", remote.c_str());
+        continue;
+      }
+      this->allowed_ipv4_.push_back(reinterpret_cast<struct sockaddr_in *>(&allowed)->sin_addr.s_addr);
+    }
+  }
+
+  this->parent_->register_received_handler(this);
+  if (this->forward_broadcasts_)
+    this->parent_->register_broadcasted_handler(this);
+}
+
+void ESPNowBridge::dump_config() {
+  ESP_LOGCONFIG(TAG, "ESPNow Bridge:");
+  ESP_LOGCONFIG(TAG, "  Remote: %s:%u", this->remote_address_.c_str(), this->remote_port_);
+  if (this->listen_port_ != 0) {
+    ESP_LOGCONFIG(TAG, "  Listen Port: %u", this->listen_port_);
+    for (const auto &remote : this->allowed_remotes_)
+      ESP_LOGCONFIG(TAG, "  Allowed Remote: %s", remote.c_str());
+  }
+  ESP_LOGCONFIG(TAG, "  Max Datagram Size: %zu", this->max_datagram_size_);
+  ESP_LOGCONFIG(TAG, "  Flush Interval: %" PRIu32 "ms", this->flush_interval_);
+  ESP_LOGCONFIG(TAG, "  Forward Broadcasts: %s", YESNO(this->forward_broadcasts_));
+  ESP_LOGCONFIG(TAG, "  Uplink: %" PRIu32 " forwarded, %" PRIu32 " dropped", this->forwarded_, this->dropped_);
+  ESP_LOGCONFIG(TAG, "  Downlink: %" PRIu32 " sent, %" PRIu32 " rejected", this->downlink_frames_, this->rejected_);
+}
+
+void ESPNowBridge::log_stats_() {
+  const uint32_t total = this->forwarded_ + this->dropped_ + this->downlink_frames_ + this->rejected_;
+  if (total == this->logged_total_)
+    return;
+  this->logged_total_ = total;
+  ESP_LOGD(TAG, "Uplink: %" PRIu32 " forwarded, %" PRIu32 " dropped; downlink: %" PRIu32 " sent, %" PRIu32
+           " rejected", this->forwarded_, this->dropped_, this->downlink_frames_, this->rejected_);
+}
+
+bool ESPNowBridge::is_allowed_remote_(const struct sockaddr_storage &source) const {
+  uint32_t address;
+  if (source.ss_family == AF_INET) {
+    address = reinterpret_cast<const struct sockaddr_in *>(&source)->sin_addr.s_addr;
+#if USE_NETWORK_IPV6
+  } else if (source.ss_family == AF_INET6) {
+    // A dual stack socket reports IPv4 senders as ::ffff:a.b.c.d
+    static const uint8_t V4_MAPPED_PREFIX[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF};
+    const uint8_t *bytes = reinterpret_cast<const struct sockaddr_in6 *>(&source)->sin6_addr.s6_addr;
+    if (memcmp(bytes, V4_MAPPED_PREFIX, sizeof(V4_MAPPED_PREFIX)) != 0)
+      return false;
+    memcpy(&address, bytes + sizeof(V4_MAPPED_PREFIX), sizeof(address));
+#endif
+  } else {
+    return false;
+  }
+  for (uint32_t allowed : this->allowed_ipv4_) {
+    if (allowed == address)
+      return true;
+  }
+  return false;
+}
+
+bool ESPNowBridge::on_received(const espnow::ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) {
+  this->enqueue_(info, data, size, 0);
+  // Observe only, other handlers still get the packet
+  return false;
+}
+
+bool ESPNowBridge::on_broadcasted(const espnow::ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) {
+  this->enqueue_(info, data, size, BRIDGE_FLAG_BROADCAST);
+  return false;
+}
+
+void ESPNowBridge::enqueue_(const espnow::ESPNowRecvInfo &info, const uint8_t *data, uint8_t size, uint8_t flags) {
+  if (!network::is_connected()) {
+    this->dropped_++;
+    return;
+  }
+  const size_t record_size = sizeof(ESPNowBridgeRecord) + size;
+  if (this->batch_size_ + record_size > this->max_datagram_size_ || this->batch_count_ == UINT8_MAX)
+    this->flush_();
+
+  if (this->batch_count_ == 0) {
+    // Header is filled in by flush_(), reserve its space
+    this->batch_size_ = sizeof(ESPNowBridgeHeader);
+    this->batch_started_ = millis();
+  }
+
+  ESPNowBridgeRecord record{};
+  memcpy(record.address, info.src_addr, ESP_NOW_ETH_ALEN);
+  record.rssi = info.rx_ctrl != nullptr ? info.rx_ctrl->rssi : 0;
+  record.flags = flags;
+  record.size = size;
+  memcpy(this->batch_.data() + this->batch_size_, &record, sizeof(record));
+  memcpy(this->batch_.data() + this->batch_size_ + sizeof(record), data, size);
+  this->batch_size_ += record_size;
+  this->batch_count_++;
+}
+
+void ESPNowBridge::flush_() {
+  if (this->batch_count_ == 0)
+    return;
+
+  ESPNowBridgeHeader header{};
+  header.magic[0] = BRIDGE_MAGIC_0;
+  header.magic[1] = BRIDGE_MAGIC_1;
+  header.version = BRIDGE_VERSION;
+  header.count = this->batch_count_;
+  header.sequence = this->uplink_sequence_++;
+  memcpy(this->batch_.data(), &header, sizeof(header));
+
+  ssize_t sent = this->socket_->sendto(this->batch_.data(), this->batch_size_, 0,
+                                       reinterpret_cast<struct sockaddr *>(&this->remote_addr_),
+                                       this->remote_addr_len_);
+  if (sent < 0) {
+    ESP_LOGV(TAG, "sendto failed, errno %d, dropping %u frames", errno, this->batch_count_);
+    this->dropped_ += this->batch_count_;
+  } else {
+    this->forwarded_ += this->batch_count_;
+  }
+  this->batch_size_ = 0;
+  this->batch_count_ = 0;
+}
+
+void ESPNowBridge::process_downlink_(const uint8_t *data, size_t size) {
+  if (size < sizeof(ESPNowBridgeHeader))
+    return;
+  ESPNowBridgeHeader header;
+  memcpy(&header, data, sizeof(header));
+  if (header.magic[0] != BRIDGE_MAGIC_0 || header.magic[1] != BRIDGE_MAGIC_1 || header.version != BRIDGE_VERSION) {
+    ESP_LOGV(TAG, "Ignoring datagram with bad header");
+    return;
+  }
+
+  size_t offset = sizeof(header);
+  for (uint8_t i = 0; i < header.count; i++) {
+    if (offset + sizeof(ESPNowBridgeRecord) > size)
+      break;
+    ESPNowBridgeRecord record;
+    memcpy(&record, data + offset, sizeof(record));
+    offset += sizeof(record);
+    if (offset + record.size > size || record.size > ESP_NOW_MAX_DATA_LEN) {
+      ESP_LOGW(TAG, "Truncated record in datagram %u", header.sequence);
+      break;
+    }
+    if (espnow::espnow_frame_type(data + offset, record.size) != 0) {
+      // OTA, RPC and state frames would let any host on the network act as a trusted peer
+      ESP_LOGW(TAG, "Dropping downlink frame carrying the component protocol magic");
+      this->rejected_++;
+      offset += record.size;
+      continue;
+    }
+    const uint8_t *address = record.address;
+    if (record.flags & BRIDGE_FLAG_BROADCAST)
+      address = espnow::ESPNOW_BROADCAST_ADDR;
+    esp_err_t err = this->parent_->send(address, data + offset, record.size);
+    if (err != ESP_OK) {
+      char addr_buf[MAC_ADDRESS_PRETTY_BUFFER_SIZE];
+      format_mac_addr_upper(address, addr_buf);
+      ESP_LOGW(TAG, "Sending to %s failed: %s", addr_buf, esp_err_to_name(err));
+    } else {
+      this->downlink_frames_++;
+    }
+    offset += record.size;
+  }
+}
+
+void ESPNowBridge::loop() {
+  const uint32_t now = millis();
+  if (this->batch_count_ != 0 && now - this->batch_started_ >= this->flush_interval_)
+    this->flush_();
+  if (now - this->last_stats_log_ >= BRIDGE_STATS_LOG_INTERVAL) {
+    this->last_stats_log_ = now;
+    this->log_stats_();
+  }
+
+  if (this->listen_socket_ == nullptr)
+    return;
+  // Reuse the uplink buffer size as the bound for incoming datagrams
+  uint8_t buf[MAX_BRIDGE_DATAGRAM_SIZE];
+  for (;;) {
+    struct sockaddr_storage source {};
+    socklen_t source_len = sizeof(source);
+    ssize_t len = this->listen_socket_->recvfrom(buf, sizeof(buf), reinterpret_cast<struct sockaddr *>(&source),
+                                                 &source_len);
+    if (len <= 0)
+      break;
+    if (!this->is_allowed_remote_(source)) {
+      ESP_LOGV(TAG, "Ignoring datagram from a host that is not allowed");
+      this->rejected_++;
+      continue;
+    }
+    this->process_downlink_(buf, len);
+  }
+}
+
+}  // namespace espnow_bridge
+}  // namespace esphome
+
+#endif  // USE_ESP32
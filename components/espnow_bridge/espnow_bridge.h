@@ -0,0 +1,113 @@
+#pragma once
+
+#include "esphome/components/espnow/espnow_component.h"
+
+#ifdef USE_ESP32
+
+#include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+#include "esphome/components/socket/socket.h"
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace espnow_bridge {
+
+// Largest datagram the bridge builds or accepts, stays below a typical 1500 byte MTU
+static constexpr size_t MAX_BRIDGE_DATAGRAM_SIZE = 1400;
+// How often the traffic counters are logged while they change
+static constexpr uint32_t BRIDGE_STATS_LOG_INTERVAL = 60000;
+
+static constexpr uint8_t BRIDGE_MAGIC_0 = 'E';
+static constexpr uint8_t BRIDGE_MAGIC_1 = 'B';
+static constexpr uint8_t BRIDGE_VERSION = 1;
+
+// Record flags
+static constexpr uint8_t BRIDGE_FLAG_BROADCAST = 0x01;  // Uplink: frame was broadcast; downlink: send as broadcast
+
+/// Start of every datagram in both directions, followed by `count` records.
+/// The layout is decoded by tools/espnow_bridge_listener.py, keep both in sync.
+struct __attribute__((packed)) ESPNowBridgeHeader {
+  uint8_t magic[2];
+  uint8_t version;
+  uint8_t count;      // Number of records in the datagram
+  uint16_t sequence;  // Datagram counter per direction, lets the receiver detect loss
+};
+
+/// One ESP-NOW frame inside a datagram, the payload follows directly
+struct __attribute__((packed)) ESPNowBridgeRecord {
+  uint8_t address[ESP_NOW_ETH_ALEN];  // Uplink: source address; downlink: destination address
+  int8_t rssi;                        // Uplink only, dBm
+  uint8_t flags;
+  uint8_t size;  // Payload size
+};
+
+/// Forwards ESP-NOW frames to a UDP endpoint, batching several frames per datagram, and sends frames
+/// received as datagrams on the listen port out over ESP-NOW. Only the allowed remotes may send, and frames of the
+/// component's own protocols (OTA, RPC, state, ...) are never accepted from the network.
+class ESPNowBridge : public Component,
+                     public Parented<espnow::ESPNowComponent>,
+                     public espnow::ESPNowReceivedPacketHandler,
+                     public espnow::ESPNowBroadcastedHandler {
+ public:
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::AFTER_WIFI; }
+
+  void set_remote(const std::string &address, uint16_t port) {
+    this->remote_address_ = address;
+    this->remote_port_ = port;
+  }
+  void set_listen_port(uint16_t port) { this->listen_port_ = port; }
+  void add_allowed_remote(const std::string &address) { this->allowed_remotes_.push_back(address); }
+  void set_max_datagram_size(size_t size) { this->max_datagram_size_ = size; }
+  void set_flush_interval(uint32_t interval) { this->flush_interval_ = interval; }
+  void set_forward_broadcasts(bool forward) { this->forward_broadcasts_ = forward; }
+
+  bool on_received(const espnow::ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) override;
+  bool on_broadcasted(const espnow::ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) override;
+
+ protected:
+  void enqueue_(const espnow::ESPNowRecvInfo &info, const uint8_t *data, uint8_t size, uint8_t flags);
+  void flush_();
+  void process_downlink_(const uint8_t *data, size_t size);
+  bool is_allowed_remote_(const struct sockaddr_storage &source) const;
+  void log_stats_();
+
+  std::unique_ptr<socket::Socket> socket_{nullptr};
+  std::unique_ptr<socket::Socket> listen_socket_{nullptr};
+  struct sockaddr_storage remote_addr_ {};
+  socklen_t remote_addr_len_{0};
+
+  std::string remote_address_;
+  uint16_t remote_port_{0};
+  uint16_t listen_port_{0};
+  std::vector<std::string> allowed_remotes_;
+  std::vector<uint32_t> allowed_ipv4_;  // Network byte order
+  size_t max_datagram_size_{MAX_BRIDGE_DATAGRAM_SIZE};
+  uint32_t flush_interval_{50};
+  bool forward_broadcasts_{true};
+
+  // Uplink batch being filled
+  std::array<uint8_t, MAX_BRIDGE_DATAGRAM_SIZE> batch_{};
+  size_t batch_size_{0};
+  uint8_t batch_count_{0};
+  uint32_t batch_started_{0};
+  uint16_t uplink_sequence_{0};
+
+  uint32_t forwarded_{0};        // Uplink frames sent to the remote
+  uint32_t dropped_{0};          // Uplink frames lost while offline or to a failed sendto
+  uint32_t downlink_frames_{0};  // Downlink frames handed to ESP-NOW
+  uint32_t rejected_{0};         // Downlink datagrams from unknown hosts and frames carrying the component magic
+  uint32_t last_stats_log_{0};
+  uint32_t logged_total_{0};
+};
+
+}  // namespace espnow_bridge
+}  // namespace esphome
+
+#endif  // USE_ESP32
@@ -1,8 +1,12 @@
 import esphome.codegen as cg
-from esphome.components import espnow
+import esphome.config_validation as cv
+from esphome.components import espnow, switch
+from esphome.const import CONF_ID, CONF_SWITCH_ID
+from esphome.core import HexInt
 
 DEPENDENCIES = ["espnow"]
 CODEOWNERS = ["@jason"]
+MULTI_CONF = True
 
 espnow_switch_ns = cg.esphome_ns.namespace("espnow_switch")
 
@@ -12,3 +16,35 @@ CONF_MAC_ADDRESS = "mac_address"
 CONF_RESPONSE_TOKEN = "response_token"
 CONF_RETRY_COUNT = "retry_count"
 CONF_RETRY_INTERVAL = "retry_interval"
+CONF_STATE_ID = "state_id"
+CONF_SUBSCRIBERS = "subscribers"
+
+ESPNowStateExporter = espnow_switch_ns.class_("ESPNowStateExporter", cg.Component)
+
+# 设备端：导出本地开关的状态，供 protocol: state_sync 的 espnow_switch 订阅
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(ESPNowStateExporter),
+        cv.GenerateID(CONF_ESPNOW_ID): cv.use_id(espnow.ESPNowComponent),
+        cv.Required(CONF_SWITCH_ID): cv.use_id(switch.Switch),
+        cv.Optional(CONF_STATE_ID, default=0): cv.uint16_t,
+        cv.Optional(CONF_SUBSCRIBERS, default=[]): cv.ensure_list(cv.mac_address),
+        cv.Optional(CONF_RETRY_INTERVAL, default=500): cv.int_range(min=10, max=5000),
+    }
+).extend(cv.COMPONENT_SCHEMA)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+
+    espnow_component = await cg.get_variable(config[CONF_ESPNOW_ID])
+    cg.add(var.set_espnow_component(espnow_component))
+    sw = await cg.get_variable(config[CONF_SWITCH_ID])
+    cg.add(var.set_switch(sw))
+    cg.add(var.set_state_id(config[CONF_STATE_ID]))
+    cg.add(var.set_retry_interval(config[CONF_RETRY_INTERVAL]))
+
+    # 预先配置的订阅者（也可由控制端的订阅请求动态加入）
+    for mac in config[CONF_SUBSCRIBERS]:
+        cg.add(var.add_subscriber([HexInt(x) for x in mac.parts]))
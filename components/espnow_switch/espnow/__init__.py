@@ -8,8 +8,11 @@ from esphome.const import (
     CONF_CHANNEL,
     CONF_DATA,
     CONF_ENABLE_ON_BOOT,
+    CONF_DURATION,
     CONF_ID,
+    CONF_MODE,
     CONF_ON_ERROR,
+    CONF_TIMEOUT,
     CONF_TRIGGER_ID,
     CONF_WIFI,
 )
@@ -29,6 +32,13 @@ ESPNowComponent = espnow_ns.class_("ESPNowComponent", cg.Component)
 ESPNowReceivedPacketHandler = espnow_ns.class_("ESPNowReceivedPacketHandler")
 ESPNowUnknownPeerHandler = espnow_ns.class_("ESPNowUnknownPeerHandler")
 ESPNowBroadcastedHandler = espnow_ns.class_("ESPNowBroadcastedHandler")
+ESPNowGroupHandler = espnow_ns.class_("ESPNowGroupHandler")
+
+ESPNowQuarantineMode = espnow_ns.enum("ESPNowQuarantineMode")
+QUARANTINE_MODES = {
+    "shed": ESPNowQuarantineMode.ESPNOW_QUARANTINE_SHED,
+    "defer": ESPNowQuarantineMode.ESPNOW_QUARANTINE_DEFER,
+}
 
 ESPNowRecvInfo = espnow_ns.class_("ESPNowRecvInfo")
 ESPNowRecvInfoConstRef = ESPNowRecvInfo.operator("const").operator("ref")
@@ -37,6 +47,10 @@ SendAction = espnow_ns.class_("SendAction", automation.Action)
 SetChannelAction = espnow_ns.class_("SetChannelAction", automation.Action)
 AddPeerAction = espnow_ns.class_("AddPeerAction", automation.Action)
 DeletePeerAction = espnow_ns.class_("DeletePeerAction", automation.Action)
+CaptureStartAction = espnow_ns.class_("CaptureStartAction", automation.Action)
+CaptureStopAction = espnow_ns.class_("CaptureStopAction", automation.Action)
+CaptureDumpAction = espnow_ns.class_("CaptureDumpAction", automation.Action)
+RPCCallAction = espnow_ns.class_("RPCCallAction", automation.Action)
 
 ESPNowHandlerTrigger = automation.Trigger.template(
     ESPNowRecvInfoConstRef,
@@ -44,15 +58,23 @@ ESPNowHandlerTrigger = automation.Trigger.template(
     cg.uint8,
 )
 
-OnUnknownPeerTrigger = espnow_ns.class_(
-    "OnUnknownPeerTrigger", ESPNowHandlerTrigger, ESPNowUnknownPeerHandler
-)
-OnReceiveTrigger = espnow_ns.class_(
-    "OnReceiveTrigger", ESPNowHandlerTrigger, ESPNowReceivedPacketHandler
-)
-OnBroadcastedTrigger = espnow_ns.class_(
-    "OnBroadcastedTrigger", ESPNowHandlerTrigger, ESPNowBroadcastedHandler
+# YAML triggers are not handler objects; they are rows of a fixed trigger table in ESPNowComponent
+ESPNowTriggerKind = espnow_ns.enum("ESPNowTriggerKind")
+
+# Arguments of the receive triggers and of on_rpc
+RECV_TRIGGER_ARGS = [
+    (ESPNowRecvInfoConstRef, "info"),
+    (cg.uint8.operator("const").operator("ptr"), "data"),
+    (cg.uint8, "size"),
+]
+
+esp_err_t = cg.global_ns.class_("esp_err_t")
+# on_rpc registers itself as the RPC method handler, see ESPNowRPCTrigger
+ESPNowRPCTrigger = espnow_ns.class_("ESPNowRPCTrigger", ESPNowHandlerTrigger)
+RPCResponseTrigger = automation.Trigger.template(
+    cg.uint8.operator("const").operator("ptr"), cg.uint8
 )
+RPCErrorTrigger = automation.Trigger.template(esp_err_t)
 
 
 CONF_AUTO_ADD_PEER = "auto_add_peer"
@@ -62,8 +84,44 @@ CONF_ON_UNKNOWN_PEER = "on_unknown_peer"
 CONF_ON_BROADCAST = "on_broadcast"
 CONF_CONTINUE_ON_ERROR = "continue_on_error"
 CONF_WAIT_FOR_SENT = "wait_for_sent"
+CONF_DATA_WRITER = "data_writer"
+CONF_CAPTURE = "capture"
+CONF_BUFFER_SIZE = "buffer_size"
+CONF_SNAP_LENGTH = "snap_length"
+CONF_CLEAR = "clear"
+CONF_QUARANTINE = "quarantine"
+CONF_FAILURE_THRESHOLD = "failure_threshold"
+CONF_SUPERSEDE_KEY = "supersede_key"
+CONF_GROUP = "group"
+CONF_GROUPS = "groups"
+CONF_ON_GROUP = "on_group"
+CONF_POWER_SAVE = "power_save"
+CONF_WAKE_INTERVAL = "wake_interval"
+CONF_MIN_WAKE_WINDOW = "min_wake_window"
+CONF_MAX_WAKE_WINDOW = "max_wake_window"
+CONF_IDLE_TIMEOUT = "idle_timeout"
+CONF_ANNOUNCE = "announce"
+CONF_LIVENESS = "liveness"
+CONF_LOOP_BUDGET = "loop_budget"
+CONF_WORKER_TASK = "worker_task"
+CONF_CORE = "core"
+CONF_PRIORITY = "priority"
+CONF_STACK_SIZE = "stack_size"
+CONF_MAX_PACKETS = "max_packets"
+CONF_MAX_TIME = "max_time"
+CONF_MIN_HEARTBEAT_INTERVAL = "min_heartbeat_interval"
+CONF_MAX_HEARTBEAT_INTERVAL = "max_heartbeat_interval"
+CONF_MISS_THRESHOLD = "miss_threshold"
+CONF_ON_RPC = "on_rpc"
+CONF_METHOD = "method"
+CONF_RESPONSE = "response"
+CONF_ON_RESPONSE = "on_response"
 
 MAX_ESPNOW_PACKET_SIZE = 250  # Maximum size of the payload in bytes
+ESPNOW_GROUP_HEADER_SIZE = 4  # Size of ESPNowGroupHeader prepended to group payloads
+ESPNOW_RPC_HEADER_SIZE = 7  # Size of ESPNowRPCHeader prepended to RPC requests and responses
+ESPNOW_CAPTURE_RECORD_HEADER_SIZE = 14  # Size of ESPNowCaptureRecord without its data
+ESPNOW_CAPTURE_MAX_RAM = 32 * 1024  # Largest static capture ring buffer in bytes
 
 
 def validate_channel(value):
@@ -72,6 +130,77 @@ def validate_channel(value):
     return wifi.validate_channel(value)
 
 
+def _validate_power_save(config):
+    interval = config[CONF_WAKE_INTERVAL].total_milliseconds
+    if CONF_MAX_WAKE_WINDOW not in config:
+        config[CONF_MAX_WAKE_WINDOW] = config[CONF_WAKE_INTERVAL]
+    max_window = config[CONF_MAX_WAKE_WINDOW].total_milliseconds
+    min_window = config[CONF_MIN_WAKE_WINDOW].total_milliseconds
+    if max_window > interval:
+        raise cv.Invalid(f"{CONF_MAX_WAKE_WINDOW} must not exceed {CONF_WAKE_INTERVAL}")
+    if min_window > max_window:
+        raise cv.Invalid(
+            f"{CONF_MIN_WAKE_WINDOW} must not exceed {CONF_MAX_WAKE_WINDOW}"
+        )
+    return config
+
+
+def _validate_liveness(config):
+    if config[CONF_MIN_HEARTBEAT_INTERVAL] > config[CONF_MAX_HEARTBEAT_INTERVAL]:
+        raise cv.Invalid(
+            f"{CONF_MIN_HEARTBEAT_INTERVAL} must not exceed {CONF_MAX_HEARTBEAT_INTERVAL}"
+        )
+    return config
+
+
+def _validate_capture(config):
+    size = config[CONF_BUFFER_SIZE] * (
+        ESPNOW_CAPTURE_RECORD_HEADER_SIZE + config[CONF_SNAP_LENGTH]
+    )
+    if size > ESPNOW_CAPTURE_MAX_RAM:
+        raise cv.Invalid(
+            f"The capture buffer needs {size} bytes of RAM, at most {ESPNOW_CAPTURE_MAX_RAM} "
+            f"are allowed; lower {CONF_BUFFER_SIZE} or {CONF_SNAP_LENGTH}"
+        )
+    return config
+
+
+def _validate_rpc_payload(value):
+    value = _validate_raw_data(value)
+    max_size = MAX_ESPNOW_PACKET_SIZE - ESPNOW_RPC_HEADER_SIZE
+    if len(value) > max_size:
+        raise cv.Invalid(
+            f"RPC payloads must be at most {max_size} bytes long, got {len(value)}"
+        )
+    return value
+
+
+def _validate_rpc_methods(config):
+    methods = [on_rpc[CONF_METHOD] for on_rpc in config.get(CONF_ON_RPC, [])]
+    for method in methods:
+        if methods.count(method) > 1:
+            raise cv.Invalid(
+                f"RPC method {method} is handled by more than one {CONF_ON_RPC}",
+                path=[CONF_ON_RPC],
+            )
+    return config
+
+
+def _validate_worker_task(config):
+    # The capture buffer is written from both the transmit and the receive path
+    if CONF_WORKER_TASK in config and CONF_CAPTURE in config:
+        raise cv.Invalid(f"{CONF_CAPTURE} cannot be used together with {CONF_WORKER_TASK}")
+    return config
+
+
+_wake_period = cv.All(
+    cv.positive_time_period_milliseconds,
+    cv.Range(
+        min=core.TimePeriod(milliseconds=1), max=core.TimePeriod(milliseconds=65535)
+    ),
+)
+
+
 CONFIG_SCHEMA = cv.All(
     cv.Schema(
         {
@@ -80,44 +209,161 @@ CONFIG_SCHEMA = cv.All(
             cv.Optional(CONF_ENABLE_ON_BOOT, default=True): cv.boolean,
             cv.Optional(CONF_AUTO_ADD_PEER, default=False): cv.boolean,
             cv.Optional(CONF_PEERS): cv.ensure_list(cv.mac_address),
+            cv.Optional(CONF_GROUPS): cv.ensure_list(cv.uint8_t),
+            cv.Optional(CONF_QUARANTINE, default={}): cv.Schema(
+                {
+                    # 0 disables quarantining
+                    cv.Optional(CONF_FAILURE_THRESHOLD, default=5): cv.int_range(
+                        min=0, max=255
+                    ),
+                    cv.Optional(
+                        CONF_DURATION, default="10s"
+                    ): cv.positive_time_period_milliseconds,
+                    cv.Optional(CONF_MODE, default="defer"): cv.enum(
+                        QUARANTINE_MODES, lower=True
+                    ),
+                }
+            ),
+            cv.Optional(CONF_POWER_SAVE): cv.All(
+                cv.Schema(
+                    {
+                        cv.Optional(CONF_WAKE_INTERVAL, default="100ms"): _wake_period,
+                        cv.Optional(CONF_MIN_WAKE_WINDOW, default="20ms"): _wake_period,
+                        # Defaults to the wake interval, i.e. always on while traffic flows
+                        cv.Optional(CONF_MAX_WAKE_WINDOW): _wake_period,
+                        cv.Optional(
+                            CONF_IDLE_TIMEOUT, default="2s"
+                        ): cv.positive_time_period_milliseconds,
+                        cv.Optional(CONF_ANNOUNCE, default=True): cv.boolean,
+                    }
+                ),
+                _validate_power_save,
+            ),
+            # Received packets dispatched per main loop iteration, 0 = no limit
+            cv.Optional(CONF_LOOP_BUDGET, default={}): cv.Schema(
+                {
+                    cv.Optional(CONF_MAX_PACKETS, default=0): cv.int_range(
+                        min=0, max=65535
+                    ),
+                    cv.Optional(
+                        CONF_MAX_TIME, default="4ms"
+                    ): cv.positive_time_period_microseconds,
+                }
+            ),
+            # Run the transmit path in its own task, e.g. on the second core of an ESP32-S3
+            cv.Optional(CONF_WORKER_TASK): cv.Schema(
+                {
+                    cv.Optional(CONF_CORE, default=1): cv.int_range(min=0, max=1),
+                    cv.Optional(CONF_PRIORITY, default=5): cv.int_range(min=1, max=24),
+                    cv.Optional(CONF_STACK_SIZE, default=4096): cv.int_range(
+                        min=2048, max=32768
+                    ),
+                }
+            ),
+            cv.Optional(CONF_LIVENESS, default={}): cv.All(
+                cv.Schema(
+                    {
+                        # Peers to monitor in addition to those with a binary sensor
+                        cv.Optional(CONF_PEERS): cv.ensure_list(cv.mac_address),
+                        cv.Optional(
+                            CONF_MIN_HEARTBEAT_INTERVAL, default="5s"
+                        ): cv.positive_time_period_milliseconds,
+                        cv.Optional(
+                            CONF_MAX_HEARTBEAT_INTERVAL, default="60s"
+                        ): cv.positive_time_period_milliseconds,
+                        cv.Optional(CONF_MISS_THRESHOLD, default=3): cv.int_range(
+                            min=1, max=255
+                        ),
+                    }
+                ),
+                _validate_liveness,
+            ),
+            cv.Optional(CONF_CAPTURE): cv.All(
+                cv.Schema(
+                    {
+                        cv.Optional(CONF_BUFFER_SIZE, default=32): cv.int_range(
+                            min=1, max=1024
+                        ),
+                        cv.Optional(CONF_SNAP_LENGTH, default=64): cv.int_range(
+                            min=1, max=MAX_ESPNOW_PACKET_SIZE
+                        ),
+                        cv.Optional(CONF_ENABLE_ON_BOOT, default=True): cv.boolean,
+                    }
+                ),
+                _validate_capture,
+            ),
             cv.Optional(CONF_ON_UNKNOWN_PEER): automation.validate_automation(
                 {
-                    cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(OnUnknownPeerTrigger),
+                    cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(ESPNowHandlerTrigger),
                 },
                 single=True,
             ),
             cv.Optional(CONF_ON_RECEIVE): automation.validate_automation(
                 {
-                    cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(OnReceiveTrigger),
+                    cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(ESPNowHandlerTrigger),
                     cv.Optional(CONF_ADDRESS): cv.mac_address,
                 }
             ),
             cv.Optional(CONF_ON_BROADCAST): automation.validate_automation(
                 {
-                    cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(OnBroadcastedTrigger),
+                    cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(ESPNowHandlerTrigger),
                     cv.Optional(CONF_ADDRESS): cv.mac_address,
                 }
             ),
+            cv.Optional(CONF_ON_GROUP): automation.validate_automation(
+                {
+                    cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(ESPNowHandlerTrigger),
+                    cv.Optional(CONF_GROUP): cv.uint8_t,
+                }
+            ),
+            # Answers espnow.rpc.call from other nodes; the response goes back as unicast
+            cv.Optional(CONF_ON_RPC): automation.validate_automation(
+                {
+                    cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(ESPNowRPCTrigger),
+                    cv.Required(CONF_METHOD): cv.uint8_t,
+                    cv.Optional(CONF_RESPONSE): cv.templatable(_validate_rpc_payload),
+                }
+            ),
         },
     ).extend(cv.COMPONENT_SCHEMA),
     cv.only_on_esp32,
+    _validate_worker_task,
+    _validate_rpc_methods,
 )
 
+# Set while validating an espnow.capture.* action, checked once the whole configuration is known
+KEY_CAPTURE_ACTIONS = "espnow_capture_actions"
+
+
+def _note_capture_action(config):
+    CORE.data[KEY_CAPTURE_ACTIONS] = True
+    return config
 
-async def _trigger_to_code(config):
-    if address := config.get(CONF_ADDRESS):
-        address = address.parts
-    trigger = cg.new_Pvariable(config[CONF_TRIGGER_ID], address)
-    await automation.build_automation(
-        trigger,
-        [
-            (ESPNowRecvInfoConstRef, "info"),
-            (cg.uint8.operator("const").operator("ptr"), "data"),
-            (cg.uint8, "size"),
-        ],
-        config,
-    )
-    return trigger
+
+def _final_validate(config):
+    # The capture actions only exist in C++ when the capture buffer is compiled in
+    if CORE.data.get(KEY_CAPTURE_ACTIONS) and CONF_CAPTURE not in config:
+        raise cv.Invalid(
+            f"espnow.capture.* actions require '{CONF_CAPTURE}:' to be configured",
+            path=[CONF_CAPTURE],
+        )
+    return config
+
+
+FINAL_VALIDATE_SCHEMA = _final_validate
+
+
+async def _trigger_to_code(var, kind, config, filter_key=None):
+    trigger = cg.new_Pvariable(config[CONF_TRIGGER_ID])
+    await automation.build_automation(trigger, RECV_TRIGGER_ARGS, config)
+    # Filters are emitted as literals in the table row, nothing is resolved at runtime
+    value = config.get(filter_key) if filter_key is not None else None
+    if value is None:
+        cg.add(var.add_trigger(kind, trigger))
+    elif filter_key == CONF_ADDRESS:
+        cg.add(var.add_trigger(kind, trigger, [HexInt(x) for x in value.parts]))
+    else:
+        cg.add(var.add_trigger(kind, trigger, value))
 
 
 async def to_code(config):
@@ -140,17 +386,98 @@ async def to_code(config):
     for peer in config.get(CONF_PEERS, []):
         cg.add(var.add_peer(peer.parts))
 
-    if on_receive := config.get(CONF_ON_UNKNOWN_PEER):
-        trigger = await _trigger_to_code(on_receive)
-        cg.add(var.register_unknown_peer_handler(trigger))
+    quarantine = config[CONF_QUARANTINE]
+    cg.add(var.set_quarantine_threshold(quarantine[CONF_FAILURE_THRESHOLD]))
+    cg.add(var.set_quarantine_duration(quarantine[CONF_DURATION]))
+    cg.add(var.set_quarantine_mode(quarantine[CONF_MODE]))
+
+    if power_save := config.get(CONF_POWER_SAVE):
+        cg.add(
+            var.set_power_save(
+                power_save[CONF_WAKE_INTERVAL],
+                power_save[CONF_MIN_WAKE_WINDOW],
+                power_save[CONF_MAX_WAKE_WINDOW],
+                power_save[CONF_IDLE_TIMEOUT],
+            )
+        )
+        cg.add(var.set_announce_schedule(power_save[CONF_ANNOUNCE]))
+
+    loop_budget = config[CONF_LOOP_BUDGET]
+    cg.add(
+        var.set_loop_budget(loop_budget[CONF_MAX_PACKETS], loop_budget[CONF_MAX_TIME])
+    )
+
+    if worker := config.get(CONF_WORKER_TASK):
+        cg.add_define("USE_ESPNOW_WORKER_TASK")
+        cg.add(
+            var.set_worker_task(
+                worker[CONF_CORE], worker[CONF_PRIORITY], worker[CONF_STACK_SIZE]
+            )
+        )
+
+    liveness = config[CONF_LIVENESS]
+    cg.add(
+        var.set_liveness(
+            liveness[CONF_MIN_HEARTBEAT_INTERVAL],
+            liveness[CONF_MAX_HEARTBEAT_INTERVAL],
+            liveness[CONF_MISS_THRESHOLD],
+        )
+    )
+    for peer in liveness.get(CONF_PEERS, []):
+        cg.add(var.monitor_peer([HexInt(x) for x in peer.parts]))
+
+    if capture := config.get(CONF_CAPTURE):
+        cg.add_define("USE_ESPNOW_CAPTURE")
+        cg.add_define("ESPNOW_CAPTURE_BUFFER_SIZE", capture[CONF_BUFFER_SIZE])
+        cg.add_define("ESPNOW_CAPTURE_SNAP_LENGTH", capture[CONF_SNAP_LENGTH])
+        cg.add(var.get_capture().set_enabled(capture[CONF_ENABLE_ON_BOOT]))
+
+    for group in config.get(CONF_GROUPS, []):
+        cg.add(var.join_group(group))
+
+    on_unknown_peer = config.get(CONF_ON_UNKNOWN_PEER)
+    triggers = (
+        ([on_unknown_peer] if on_unknown_peer else [])
+        + config.get(CONF_ON_RECEIVE, [])
+        + config.get(CONF_ON_BROADCAST, [])
+        + config.get(CONF_ON_GROUP, [])
+    )
+    if triggers:
+        cg.add_define("ESPNOW_TRIGGER_COUNT", len(triggers))
+
+    if on_unknown_peer:
+        await _trigger_to_code(
+            var, ESPNowTriggerKind.ESPNOW_TRIGGER_UNKNOWN_PEER, on_unknown_peer
+        )
 
     for on_receive in config.get(CONF_ON_RECEIVE, []):
-        trigger = await _trigger_to_code(on_receive)
-        cg.add(var.register_received_handler(trigger))
+        await _trigger_to_code(
+            var, ESPNowTriggerKind.ESPNOW_TRIGGER_RECEIVE, on_receive, CONF_ADDRESS
+        )
+
+    for on_broadcast in config.get(CONF_ON_BROADCAST, []):
+        await _trigger_to_code(
+            var, ESPNowTriggerKind.ESPNOW_TRIGGER_BROADCAST, on_broadcast, CONF_ADDRESS
+        )
+
+    for on_group in config.get(CONF_ON_GROUP, []):
+        await _trigger_to_code(
+            var, ESPNowTriggerKind.ESPNOW_TRIGGER_GROUP, on_group, CONF_GROUP
+        )
 
-    for on_receive in config.get(CONF_ON_BROADCAST, []):
-        trigger = await _trigger_to_code(on_receive)
-        cg.add(var.register_broadcasted_handler(trigger))
+    for on_rpc in config.get(CONF_ON_RPC, []):
+        trigger = cg.new_Pvariable(on_rpc[CONF_TRIGGER_ID], var, on_rpc[CONF_METHOD])
+        await automation.build_automation(trigger, RECV_TRIGGER_ARGS, on_rpc)
+        if (response := on_rpc.get(CONF_RESPONSE)) is None:
+            continue
+        if cg.is_template(response):
+            lambda_ = await cg.process_lambda(
+                response, RECV_TRIGGER_ARGS, return_type=byte_vector
+            )
+            cg.add(trigger.set_response_template(lambda_))
+        else:
+            data, size = _static_payload(on_rpc[CONF_TRIGGER_ID], response)
+            cg.add(trigger.set_response_static(data, size))
 
 
 # ========================================== A C T I O N S ================================================
@@ -180,6 +507,19 @@ def _validate_raw_data(value):
     )
 
 
+def _static_payload(owner_id, data):
+    """Emit a constant payload once as a static array, returns the array and its size."""
+    if isinstance(data, str):
+        data = [ord(c) for c in data]
+    if not data:
+        return cg.nullptr, 0
+    data_id = core.ID(f"{owner_id.id}_data", is_declaration=True, type=cg.uint8)
+    data_arr = cg.static_const_array(
+        data_id, cg.ArrayInitializer(*[HexInt(b) for b in data])
+    )
+    return data_arr, len(data)
+
+
 async def register_peer(var, config, args):
     peer = config[CONF_ADDRESS]
     if isinstance(peer, core.MACAddress):
@@ -198,7 +538,12 @@ PEER_SCHEMA = cv.Schema(
 
 SEND_SCHEMA = PEER_SCHEMA.extend(
     {
-        cv.Required(CONF_DATA): cv.templatable(_validate_raw_data),
+        cv.Exclusive(CONF_DATA, "payload"): cv.templatable(_validate_raw_data),
+        cv.Exclusive(CONF_DATA_WRITER, "payload"): cv.returning_lambda,
+        # Replace a still queued packet to the same peer with the same key
+        cv.Optional(CONF_SUPERSEDE_KEY): cv.int_range(min=1, max=0xFFFFFFFF),
+        # Drop the packet if it could not be sent within this time
+        cv.Optional(CONF_TIMEOUT): cv.positive_time_period_milliseconds,
         cv.Optional(CONF_ON_SENT): automation.validate_action_list,
         cv.Optional(CONF_ON_ERROR): automation.validate_action_list,
         cv.Optional(CONF_WAIT_FOR_SENT, default=True): cv.boolean,
@@ -216,6 +561,19 @@ def _validate_send_action(config):
     return config
 
 
+def _validate_group_payload(config):
+    data = config.get(CONF_DATA)
+    if isinstance(data, (str, list)):
+        max_size = MAX_ESPNOW_PACKET_SIZE - ESPNOW_GROUP_HEADER_SIZE
+        if len(data) > max_size:
+            raise cv.Invalid(
+                f"'{CONF_DATA}' must be at most {max_size} bytes long for group sends, got {len(data)}",
+                path=[CONF_DATA],
+            )
+    return config
+
+
+SEND_SCHEMA.add_extra(cv.has_exactly_one_key(CONF_DATA, CONF_DATA_WRITER))
 SEND_SCHEMA.add_extra(_validate_send_action)
 
 
@@ -236,6 +594,16 @@ SEND_SCHEMA.add_extra(_validate_send_action)
         key=CONF_DATA,
     ),
 )
+@automation.register_action(
+    "espnow.group.send",
+    SendAction,
+    SEND_SCHEMA.extend(
+        {
+            cv.Optional(CONF_ADDRESS, default="FF:FF:FF:FF:FF:FE"): cv.mac_address,
+            cv.Required(CONF_GROUP): cv.uint8_t,
+        }
+    ).add_extra(_validate_group_payload),
+)
 async def send_action(
     config: ConfigType,
     action_id: core.ID,
@@ -246,13 +614,29 @@ async def send_action(
     await cg.register_parented(var, config[CONF_ID])
 
     await register_peer(var, config, args)
-
-    data = config.get(CONF_DATA, [])
-    if isinstance(data, str):
-        data = [cg.RawExpression(f"'{c}'") for c in data]
-    templ = await cg.templatable(data, args, byte_vector, byte_vector)
-    cg.add(var.set_data(templ))
-
+    if (group := config.get(CONF_GROUP)) is not None:
+        cg.add(var.set_group(group))
+
+    if (writer := config.get(CONF_DATA_WRITER)) is not None:
+        # Lambda fills a stack buffer provided by the action and returns the payload size
+        lambda_ = await cg.process_lambda(
+            writer,
+            [(cg.uint8.operator("ptr"), "buffer"), *args],
+            return_type=cg.size_t,
+        )
+        cg.add(var.set_data_writer(lambda_))
+    elif cg.is_template(data := config[CONF_DATA]):
+        templ = await cg.templatable(data, args, byte_vector)
+        cg.add(var.set_data_template(templ))
+    else:
+        # Constant payloads are emitted once as a static array and passed by pointer
+        data_arr, size = _static_payload(action_id, data)
+        cg.add(var.set_data_static(data_arr, size))
+
+    if (key := config.get(CONF_SUPERSEDE_KEY)) is not None:
+        cg.add(var.set_supersede_key(key))
+    if (timeout := config.get(CONF_TIMEOUT)) is not None:
+        cg.add(var.set_timeout(timeout))
     cg.add(var.set_wait_for_sent(config[CONF_WAIT_FOR_SENT]))
     cg.add(var.set_continue_on_error(config[CONF_CONTINUE_ON_ERROR]))
 
@@ -318,3 +702,109 @@ async def channel_action(
     template_ = await cg.templatable(config[CONF_CHANNEL], args, cg.uint8)
     cg.add(var.set_channel(template_))
     return var
+
+
+CAPTURE_ACTION_SCHEMA = cv.All(
+    automation.maybe_simple_id(
+        {
+            cv.GenerateID(): cv.use_id(ESPNowComponent),
+        }
+    ),
+    _note_capture_action,
+)
+
+
+@automation.register_action(
+    "espnow.capture.start", CaptureStartAction, CAPTURE_ACTION_SCHEMA
+)
+@automation.register_action(
+    "espnow.capture.stop", CaptureStopAction, CAPTURE_ACTION_SCHEMA
+)
+async def capture_action(
+    config: ConfigType,
+    action_id: core.ID,
+    template_arg: cg.TemplateArguments,
+    args: list[tuple],
+):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    return var
+
+
+@automation.register_action(
+    "espnow.capture.dump",
+    CaptureDumpAction,
+    cv.All(
+        automation.maybe_simple_id(
+            {
+                cv.GenerateID(): cv.use_id(ESPNowComponent),
+                cv.Optional(CONF_CLEAR, default=False): cv.boolean,
+            }
+        ),
+        _note_capture_action,
+    ),
+)
+async def capture_dump_action(
+    config: ConfigType,
+    action_id: core.ID,
+    template_arg: cg.TemplateArguments,
+    args: list[tuple],
+):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    cg.add(var.set_clear(config[CONF_CLEAR]))
+    return var
+
+
+@automation.register_action(
+    "espnow.rpc.call",
+    RPCCallAction,
+    PEER_SCHEMA.extend(
+        {
+            cv.Required(CONF_METHOD): cv.uint8_t,
+            cv.Optional(CONF_DATA, default=[]): cv.templatable(_validate_rpc_payload),
+            # No response within this time fails the call with ESP_ERR_TIMEOUT
+            cv.Optional(CONF_TIMEOUT, default="1s"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_ON_RESPONSE): automation.validate_automation(
+                {cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(RPCResponseTrigger)},
+                single=True,
+            ),
+            cv.Optional(CONF_ON_ERROR): automation.validate_automation(
+                {cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(RPCErrorTrigger)},
+                single=True,
+            ),
+        }
+    ),
+)
+async def rpc_call_action(
+    config: ConfigType,
+    action_id: core.ID,
+    template_arg: cg.TemplateArguments,
+    args: list[tuple],
+):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    await register_peer(var, config, args)
+    cg.add(var.set_method(config[CONF_METHOD]))
+    cg.add(var.set_timeout(config[CONF_TIMEOUT]))
+
+    if cg.is_template(data := config[CONF_DATA]):
+        templ = await cg.templatable(data, args, byte_vector)
+        cg.add(var.set_data_template(templ))
+    else:
+        data_arr, size = _static_payload(action_id, data)
+        cg.add(var.set_data_static(data_arr, size))
+
+    if on_response := config.get(CONF_ON_RESPONSE):
+        trigger = cg.new_Pvariable(on_response[CONF_TRIGGER_ID])
+        cg.add(var.set_response_trigger(trigger))
+        await automation.build_automation(
+            trigger,
+            [(cg.uint8.operator("const").operator("ptr"), "data"), (cg.uint8, "size")],
+            on_response,
+        )
+    if on_error := config.get(CONF_ON_ERROR):
+        trigger = cg.new_Pvariable(on_error[CONF_TRIGGER_ID])
+        cg.add(var.set_error_trigger(trigger))
+        await automation.build_automation(trigger, [(esp_err_t, "error")], on_error)
+    return var
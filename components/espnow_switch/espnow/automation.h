@@ -7,13 +7,42 @@
 #include "esphome/core/automation.h"
 #include "esphome/core/base_automation.h"
 
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <tuple>
+
 namespace esphome::espnow {
 
+/// Number of runs of one espnow.send action that await their send report without a heap allocation;
+/// further concurrent runs still send, carrying their arguments in the callback.
+static constexpr uint8_t MAX_SEND_ACTION_RUNS = 4;
+
 template<typename... Ts> class SendAction : public Action<Ts...>, public Parented<ESPNowComponent> {
   TEMPLATABLE_VALUE(peer_address_t, address);
-  TEMPLATABLE_VALUE(std::vector<uint8_t>, data);
 
  public:
+  /// Payload known at compile time; codegen emits it as a static const array so no copy is made per run.
+  void set_data_static(const uint8_t *data, size_t size) {
+    this->static_data_ = data;
+    this->static_size_ = size;
+    this->data_func_ = nullptr;
+  }
+  /// Payload produced by a lambda returning a byte vector.
+  void set_data_template(std::function<std::vector<uint8_t>(Ts...)> func) {
+    this->data_func_ = std::move(func);
+    this->static_data_ = nullptr;
+    this->static_size_ = 0;
+  }
+  /// Payload written by a lambda directly into a caller-provided buffer of ESP_NOW_MAX_DATA_LEN bytes.
+  /// The lambda returns the number of bytes written.
+  void set_data_writer(std::function<size_t(uint8_t *, Ts...)> func) {
+    this->data_writer_ = std::move(func);
+    this->data_func_ = nullptr;
+    this->static_data_ = nullptr;
+    this->static_size_ = 0;
+  }
+
   void add_on_sent(const std::initializer_list<Action<Ts...> *> &actions) {
     this->sent_.add_actions(actions);
     if (this->flags_.wait_for_sent) {
@@ -33,33 +62,47 @@ template<typename... Ts> class SendAction : public Action<Ts...>, public Parente
     }
   }
 
+  void set_group(uint8_t group) {
+    this->group_ = group;
+    this->flags_.use_group = true;
+  }
+  void set_supersede_key(uint32_t key) { this->options_.supersede_key = key; }
+  void set_timeout(uint32_t timeout_ms) { this->options_.timeout_ms = timeout_ms; }
   void set_wait_for_sent(bool wait_for_sent) { this->flags_.wait_for_sent = wait_for_sent; }
   void set_continue_on_error(bool continue_on_error) { this->flags_.continue_on_error = continue_on_error; }
 
   void play_complex(const Ts &...x) override {
     this->num_running_++;
-    send_callback_t send_callback = [this, x...](esp_err_t status) {
-      if (status == ESP_OK) {
-        if (!this->sent_.empty()) {
-          this->sent_.play(x...);
-        } else if (this->flags_.wait_for_sent) {
-          this->play_next_(x...);
-        }
-      } else {
-        if (!this->error_.empty()) {
-          this->error_.play(x...);
-        } else if (this->flags_.wait_for_sent) {
-          if (this->flags_.continue_on_error) {
-            this->play_next_(x...);
-          } else {
-            this->stop_complex();
-          }
-        }
-      }
-    };
-    peer_address_t address = this->address_.value(x...);
-    std::vector<uint8_t> data = this->data_.value(x...);
-    esp_err_t err = this->parent_->send(address.data(), data, send_callback);
+    // The run's arguments are parked in a fixed slot and the callback only captures `this` and the slot index,
+    // which fits std::function's small buffer, so no heap allocation happens per run.
+    uint8_t slot = 0;
+    while (slot < MAX_SEND_ACTION_RUNS && this->runs_[slot].has_value())
+      slot++;
+    send_callback_t send_callback;
+    if (slot < MAX_SEND_ACTION_RUNS) {
+      this->runs_[slot].emplace(x...);
+      send_callback = [this, slot](esp_err_t status) {
+        auto args = std::move(*this->runs_[slot]);
+        this->runs_[slot].reset();
+        std::apply([this, status](auto &...xs) { this->complete_(status, xs...); }, args);
+      };
+    } else {
+      // More runs awaiting a report than slots: carry the arguments in the callback itself, which may allocate
+      send_callback = [this, args = std::tuple<std::decay_t<Ts>...>(x...)](esp_err_t status) {
+        std::apply([this, status](auto &...xs) { this->complete_(status, xs...); }, args);
+      };
+    }
+    esp_err_t err;
+    if (this->data_writer_ != nullptr) {
+      uint8_t buffer[ESP_NOW_MAX_DATA_LEN];
+      size_t size = this->data_writer_(buffer, x...);
+      err = this->send_(buffer, size, send_callback, x...);
+    } else if (this->data_func_ != nullptr) {
+      std::vector<uint8_t> data = this->data_func_(x...);
+      err = this->send_(data.data(), data.size(), send_callback, x...);
+    } else {
+      err = this->send_(this->static_data_, this->static_size_, send_callback, x...);
+    }
     if (err != ESP_OK) {
       send_callback(err);
     } else if (!this->flags_.wait_for_sent) {
@@ -76,16 +119,151 @@ template<typename... Ts> class SendAction : public Action<Ts...>, public Parente
   }
 
  protected:
+  void complete_(esp_err_t status, const Ts &...x) {
+    if (status == ESP_OK) {
+      if (!this->sent_.empty()) {
+        this->sent_.play(x...);
+      } else if (this->flags_.wait_for_sent) {
+        this->play_next_(x...);
+      }
+    } else {
+      if (!this->error_.empty()) {
+        this->error_.play(x...);
+      } else if (this->flags_.wait_for_sent) {
+        if (this->flags_.continue_on_error) {
+          this->play_next_(x...);
+        } else {
+          this->stop_complex();
+        }
+      }
+    }
+  }
+
+  esp_err_t send_(const uint8_t *data, size_t size, const send_callback_t &callback, const Ts &...x) {
+    if (this->flags_.use_group) {
+      return this->parent_->send_group(this->group_, data, size, callback, this->options_);
+    }
+    peer_address_t address = this->address_.value(x...);
+    return this->parent_->send(address.data(), data, size, callback, this->options_);
+  }
+
   ActionList<Ts...> sent_;
   ActionList<Ts...> error_;
 
+  const uint8_t *static_data_{nullptr};
+  size_t static_size_{0};
+  std::function<std::vector<uint8_t>(Ts...)> data_func_{nullptr};
+  std::function<size_t(uint8_t *, Ts...)> data_writer_{nullptr};
+  ESPNowSendOptions options_{};
+  uint8_t group_{0};
+  std::array<std::optional<std::tuple<std::decay_t<Ts>...>>, MAX_SEND_ACTION_RUNS> runs_{};
+
   struct {
     uint8_t wait_for_sent : 1;      // Wait for the send operation to complete before continuing automation
     uint8_t continue_on_error : 1;  // Continue automation even if the send operation fails
-    uint8_t reserved : 6;           // Reserved for future use
+    uint8_t use_group : 1;          // Send to group_ via multicast instead of address_
+    uint8_t reserved : 5;           // Reserved for future use
   } flags_{0};
 };
 
+/// Calls an RPC method on a peer; `on_response` gets the response payload, `on_error` the failure.
+template<typename... Ts> class RPCCallAction : public Action<Ts...>, public Parented<ESPNowComponent> {
+  TEMPLATABLE_VALUE(peer_address_t, address);
+
+ public:
+  void set_method(uint8_t method) { this->method_ = method; }
+  void set_timeout(uint32_t timeout_ms) { this->timeout_ = timeout_ms; }
+  /// Request payload known at compile time, emitted as a static const array.
+  void set_data_static(const uint8_t *data, size_t size) {
+    this->static_data_ = data;
+    this->static_size_ = size;
+    this->data_func_ = nullptr;
+  }
+  /// Request payload produced by a lambda returning a byte vector.
+  void set_data_template(std::function<std::vector<uint8_t>(Ts...)> func) {
+    this->data_func_ = std::move(func);
+    this->static_data_ = nullptr;
+    this->static_size_ = 0;
+  }
+  void set_response_trigger(Trigger<const uint8_t *, uint8_t> *trigger) { this->response_trigger_ = trigger; }
+  void set_error_trigger(Trigger<esp_err_t> *trigger) { this->error_trigger_ = trigger; }
+
+  void play(const Ts &...x) override {
+    peer_address_t address = this->address_.value(x...);
+    // The callbacks only capture `this`, which fits std::function's small buffer
+    rpc_response_callback_t on_response = [this](const uint8_t *data, uint8_t size) {
+      if (this->response_trigger_ != nullptr)
+        this->response_trigger_->trigger(data, size);
+    };
+    rpc_failure_callback_t on_failure = [this](esp_err_t error) { this->fail_(error); };
+    esp_err_t err;
+    if (this->data_func_ != nullptr) {
+      std::vector<uint8_t> data = this->data_func_(x...);
+      err = this->parent_->call(address.data(), this->method_, data.data(), data.size(), on_response, on_failure,
+                                this->timeout_);
+    } else {
+      err = this->parent_->call(address.data(), this->method_, this->static_data_, this->static_size_, on_response,
+                                on_failure, this->timeout_);
+    }
+    // call() runs no callback when the request was not queued
+    if (err != ESP_OK)
+      this->fail_(err);
+  }
+
+ protected:
+  void fail_(esp_err_t error) {
+    if (this->error_trigger_ != nullptr)
+      this->error_trigger_->trigger(error);
+  }
+
+  uint8_t method_{0};
+  uint32_t timeout_{1000};
+  const uint8_t *static_data_{nullptr};
+  size_t static_size_{0};
+  std::function<std::vector<uint8_t>(Ts...)> data_func_{nullptr};
+  Trigger<const uint8_t *, uint8_t> *response_trigger_{nullptr};
+  Trigger<esp_err_t> *error_trigger_{nullptr};
+};
+
+/// Answers RPC calls for one method from YAML: runs its actions with the request, then sends the response.
+class ESPNowRPCTrigger : public Trigger<const ESPNowRecvInfo &, const uint8_t *, uint8_t> {
+ public:
+  using response_template_t = std::function<std::vector<uint8_t>(const ESPNowRecvInfo &, const uint8_t *, uint8_t)>;
+
+  ESPNowRPCTrigger(ESPNowComponent *parent, uint8_t method) {
+    parent->register_rpc_method(
+        method, [this](const ESPNowRecvInfo &info, const uint8_t *request, uint8_t size, uint8_t *response) {
+          return this->handle_(info, request, size, response);
+        });
+  }
+  /// Response known at compile time, emitted as a static const array.
+  void set_response_static(const uint8_t *data, size_t size) {
+    this->response_data_ = data;
+    this->response_size_ = std::min(size, ESPNOW_RPC_MAX_PAYLOAD);
+  }
+  /// Response produced by a lambda from the request.
+  void set_response_template(response_template_t func) { this->response_func_ = std::move(func); }
+
+ protected:
+  size_t handle_(const ESPNowRecvInfo &info, const uint8_t *request, uint8_t size, uint8_t *response) {
+    this->trigger(info, request, size);
+    if (this->response_func_ != nullptr) {
+      std::vector<uint8_t> data = this->response_func_(info, request, size);
+      const size_t length = std::min(data.size(), ESPNOW_RPC_MAX_PAYLOAD);
+      if (length > 0)
+        memcpy(response, data.data(), length);
+      return length;
+    }
+    if (this->response_size_ > 0)
+      memcpy(response, this->response_data_, this->response_size_);
+    return this->response_size_;
+  }
+
+  const uint8_t *response_data_{nullptr};
+  size_t response_size_{0};
+  response_template_t response_func_{nullptr};
+};
+
 template<typename... Ts> class AddPeerAction : public Action<Ts...>, public Parented<ESPNowComponent> {
   TEMPLATABLE_VALUE(peer_address_t, address);
 
@@ -118,57 +296,26 @@ template<typename... Ts> class SetChannelAction : public Action<Ts...>, public P
   }
 };
 
-class OnReceiveTrigger : public Trigger<const ESPNowRecvInfo &, const uint8_t *, uint8_t>,
-                         public ESPNowReceivedPacketHandler {
+#ifdef USE_ESPNOW_CAPTURE
+template<typename... Ts> class CaptureStartAction : public Action<Ts...>, public Parented<ESPNowComponent> {
  public:
-  explicit OnReceiveTrigger(std::array<uint8_t, ESP_NOW_ETH_ALEN> address) : has_address_(true) {
-    memcpy(this->address_, address.data(), ESP_NOW_ETH_ALEN);
-  }
-
-  explicit OnReceiveTrigger() : has_address_(false) {}
-
-  bool on_received(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) override {
-    bool match = !this->has_address_ || (memcmp(this->address_, info.src_addr, ESP_NOW_ETH_ALEN) == 0);
-    if (!match)
-      return false;
-
-    this->trigger(info, data, size);
-    return false;  // Return false to continue processing other internal handlers
-  }
-
- protected:
-  bool has_address_{false};
-  const uint8_t *address_[ESP_NOW_ETH_ALEN];
+  void play(const Ts &...x) override { this->parent_->get_capture().set_enabled(true); }
 };
-class OnUnknownPeerTrigger : public Trigger<const ESPNowRecvInfo &, const uint8_t *, uint8_t>,
-                             public ESPNowUnknownPeerHandler {
+
+template<typename... Ts> class CaptureStopAction : public Action<Ts...>, public Parented<ESPNowComponent> {
  public:
-  bool on_unknown_peer(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) override {
-    this->trigger(info, data, size);
-    return false;  // Return false to continue processing other internal handlers
-  }
+  void play(const Ts &...x) override { this->parent_->get_capture().set_enabled(false); }
 };
-class OnBroadcastedTrigger : public Trigger<const ESPNowRecvInfo &, const uint8_t *, uint8_t>,
-                             public ESPNowBroadcastedHandler {
- public:
-  explicit OnBroadcastedTrigger(std::array<uint8_t, ESP_NOW_ETH_ALEN> address) : has_address_(true) {
-    memcpy(this->address_, address.data(), ESP_NOW_ETH_ALEN);
-  }
-  explicit OnBroadcastedTrigger() : has_address_(false) {}
-
-  bool on_broadcasted(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) override {
-    bool match = !this->has_address_ || (memcmp(this->address_, info.src_addr, ESP_NOW_ETH_ALEN) == 0);
-    if (!match)
-      return false;
 
-    this->trigger(info, data, size);
-    return false;  // Return false to continue processing other internal handlers
-  }
+template<typename... Ts> class CaptureDumpAction : public Action<Ts...>, public Parented<ESPNowComponent> {
+ public:
+  void set_clear(bool clear) { this->clear_ = clear; }
+  void play(const Ts &...x) override { this->parent_->dump_capture(this->clear_); }
 
  protected:
-  bool has_address_{false};
-  const uint8_t *address_[ESP_NOW_ETH_ALEN];
+  bool clear_{false};
 };
+#endif
 
 }  // namespace esphome::espnow
 
@@ -0,0 +1,44 @@
+"""ESP-NOW peer liveness binary sensors."""
+
+import esphome.codegen as cg
+from esphome.components import binary_sensor
+import esphome.config_validation as cv
+from esphome.const import (
+    CONF_ADDRESS,
+    DEVICE_CLASS_CONNECTIVITY,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+)
+from esphome.core import HexInt
+
+from .. import ESPNowComponent, espnow_ns
+
+DEPENDENCIES = ["espnow"]
+
+ESPNowPeerBinarySensor = espnow_ns.class_(
+    "ESPNowPeerBinarySensor", binary_sensor.BinarySensor, cg.Component
+)
+
+CONF_ESPNOW_ID = "espnow_id"
+
+CONFIG_SCHEMA = (
+    binary_sensor.binary_sensor_schema(
+        ESPNowPeerBinarySensor,
+        device_class=DEVICE_CLASS_CONNECTIVITY,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    )
+    .extend(
+        {
+            cv.GenerateID(CONF_ESPNOW_ID): cv.use_id(ESPNowComponent),
+            cv.Required(CONF_ADDRESS): cv.mac_address,
+        }
+    )
+    .extend(cv.COMPONENT_SCHEMA)
+)
+
+
+async def to_code(config):
+    var = await binary_sensor.new_binary_sensor(config)
+    await cg.register_component(var, config)
+    await cg.register_parented(var, config[CONF_ESPNOW_ID])
+
+    cg.add(var.set_address([HexInt(x) for x in config[CONF_ADDRESS].parts]))
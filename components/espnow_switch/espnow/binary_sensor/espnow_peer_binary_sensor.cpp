@@ -0,0 +1,28 @@
+#include "espnow_peer_binary_sensor.h"
+
+#ifdef USE_ESP32
+
+#include "esphome/core/log.h"
+
+namespace esphome::espnow {
+
+static constexpr const char *TAG = "espnow.binary_sensor";
+
+void ESPNowPeerBinarySensor::setup() {
+  this->parent_->monitor_peer(this->address_);
+  this->parent_->add_on_liveness_callback([this](const uint8_t *peer, bool alive) {
+    if (memcmp(peer, this->address_, ESP_NOW_ETH_ALEN) == 0)
+      this->publish_state(alive);
+  });
+}
+
+void ESPNowPeerBinarySensor::dump_config() {
+  char addr_buf[MAC_ADDRESS_PRETTY_BUFFER_SIZE];
+  format_mac_addr_upper(this->address_, addr_buf);
+  LOG_BINARY_SENSOR("", "ESP-NOW peer", this);
+  ESP_LOGCONFIG(TAG, "  Address: %s", addr_buf);
+}
+
+}  // namespace esphome::espnow
+
+#endif  // USE_ESP32
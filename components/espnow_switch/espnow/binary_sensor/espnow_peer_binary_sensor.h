@@ -0,0 +1,28 @@
+#pragma once
+
+#include "../espnow_component.h"
+
+#ifdef USE_ESP32
+
+#include "esphome/components/binary_sensor/binary_sensor.h"
+#include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+
+namespace esphome::espnow {
+
+/// Reports whether a peer is alive, see ESPNowPeerLiveness. Stays unknown until the peer is first heard
+/// from or declared down.
+class ESPNowPeerBinarySensor : public binary_sensor::BinarySensor, public Component, public Parented<ESPNowComponent> {
+ public:
+  void setup() override;
+  void dump_config() override;
+
+  void set_address(peer_address_t address) { memcpy(this->address_, address.data(), ESP_NOW_ETH_ALEN); }
+
+ protected:
+  uint8_t address_[ESP_NOW_ETH_ALEN]{0};
+};
+
+}  // namespace esphome::espnow
+
+#endif  // USE_ESP32
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+
+#if defined(USE_ESP32) && defined(USE_ESPNOW_CAPTURE)
+
+#include "esphome/core/hal.h"
+
+#include <esp_now.h>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace esphome::espnow {
+
+#ifndef ESPNOW_CAPTURE_BUFFER_SIZE
+#define ESPNOW_CAPTURE_BUFFER_SIZE 32
+#endif
+#ifndef ESPNOW_CAPTURE_SNAP_LENGTH
+#define ESPNOW_CAPTURE_SNAP_LENGTH 64
+#endif
+
+enum ESPNowCaptureDirection : uint8_t {
+  /** Frame received from a peer. */
+  CAPTURE_RX = 0,
+  /** Frame handed to esp_now_send(). */
+  CAPTURE_TX = 1,
+  /** Send report for a previously transmitted frame. */
+  CAPTURE_TX_STATUS = 2,
+};
+
+/// One captured frame. The layout is the on-wire format of the dump and is decoded by
+/// tools/espnow_capture_to_pcap.py, so keep both in sync when changing it.
+struct __attribute__((packed)) ESPNowCaptureRecord {
+  uint32_t timestamp_us;               // micros() when the frame was processed
+  uint8_t address[ESP_NOW_ETH_ALEN];   // Source address for RX, destination address for TX
+  int8_t rssi;                         // RSSI in dBm for RX, 0 otherwise
+  uint8_t direction;                   // ESPNowCaptureDirection
+  uint8_t status;                      // 0 on success, 1 on failure
+  uint8_t size;                        // Original payload size, may exceed the captured length
+  uint8_t data[ESPNOW_CAPTURE_SNAP_LENGTH];  // First bytes of the payload
+};
+
+/// Fixed size ring buffer of captured frames, overwriting the oldest record when full.
+/// Only accessed from the main loop, so no locking is needed.
+class ESPNowCapture {
+ public:
+  void set_enabled(bool enabled) { this->enabled_ = enabled; }
+  bool is_enabled() const { return this->enabled_; }
+  /// Hold recording while a dump walks the buffer, so the records do not shift under it.
+  void set_paused(bool paused) { this->paused_ = paused; }
+
+  inline void record(ESPNowCaptureDirection direction, const uint8_t *address, int8_t rssi, bool failed,
+                     const uint8_t *data, uint8_t size) {
+    if (!this->enabled_ || this->paused_)
+      return;
+    ESPNowCaptureRecord &rec = this->records_[this->head_];
+    rec.timestamp_us = micros();
+    memcpy(rec.address, address, ESP_NOW_ETH_ALEN);
+    rec.rssi = rssi;
+    rec.direction = direction;
+    rec.status = failed ? 1 : 0;
+    rec.size = size;
+    uint8_t captured = size < ESPNOW_CAPTURE_SNAP_LENGTH ? size : ESPNOW_CAPTURE_SNAP_LENGTH;
+    if (captured > 0)
+      memcpy(rec.data, data, captured);
+
+    this->head_ = (this->head_ + 1) % ESPNOW_CAPTURE_BUFFER_SIZE;
+    if (this->count_ < ESPNOW_CAPTURE_BUFFER_SIZE) {
+      this->count_++;
+    } else {
+      this->overwritten_++;
+    }
+  }
+
+  /// Number of records currently held.
+  size_t size() const { return this->count_; }
+  /// Number of records lost to wrap-around since the last clear().
+  uint32_t get_overwritten() const { return this->overwritten_; }
+
+  /// Access records from the oldest (index 0) to the newest.
+  const ESPNowCaptureRecord &at(size_t index) const {
+    size_t start = (this->head_ + ESPNOW_CAPTURE_BUFFER_SIZE - this->count_) % ESPNOW_CAPTURE_BUFFER_SIZE;
+    return this->records_[(start + index) % ESPNOW_CAPTURE_BUFFER_SIZE];
+  }
+
+  void clear() {
+    this->head_ = 0;
+    this->count_ = 0;
+    this->overwritten_ = 0;
+  }
+
+ protected:
+  std::array<ESPNowCaptureRecord, ESPNOW_CAPTURE_BUFFER_SIZE> records_{};
+  size_t head_{0};
+  size_t count_{0};
+  uint32_t overwritten_{0};
+  bool enabled_{true};
+  bool paused_{false};
+};
+
+}  // namespace esphome::espnow
+
+#endif  // USE_ESP32 && USE_ESPNOW_CAPTURE
@@ -6,6 +6,7 @@
 
 #include "esphome/core/application.h"
 #include "esphome/core/defines.h"
+#include "esphome/core/hal.h"
 #include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
 
@@ -15,6 +16,9 @@
 #include <esp_now.h>
 #include <esp_random.h>
 #include <esp_wifi.h>
+#include <algorithm>
+#include <cinttypes>
+#include <cstddef>
 #include <cstring>
 #include <memory>
 
@@ -26,8 +30,21 @@ namespace esphome::espnow {
 
 static constexpr const char *TAG = "espnow";
 
-static const esp_err_t CONFIG_ESPNOW_WAKE_WINDOW = 50;
-static const esp_err_t CONFIG_ESPNOW_WAKE_INTERVAL = 100;
+#ifdef USE_ESPNOW_WORKER_TASK
+// Longest the worker task sleeps without a notification
+static constexpr uint32_t ESPNOW_WORKER_IDLE_MS = 10;
+#endif
+
+// Window over which the time spent in loop() is summed up and logged
+static constexpr uint32_t ESPNOW_LOOP_STATS_INTERVAL_MS = 60000;
+
+// A peer schedule is trusted this long after the peer was last heard; after that clock drift makes
+// the prediction useless and packets are sent immediately again
+static constexpr uint32_t ESPNOW_SCHEDULE_STALE_MS = 60000;
+#ifdef USE_ESPNOW_CAPTURE
+// Capture records logged per loop() iteration while a dump is in progress
+static constexpr size_t ESPNOW_CAPTURE_DUMP_PER_LOOP = 8;
+#endif
 
 ESPNowComponent *global_esp_now = nullptr;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
 
@@ -43,6 +60,14 @@ static const LogString *espnow_error_to_str(esp_err_t error) {
       return LOG_STR("Peer address not set");
     case ESP_ERR_ESPNOW_PEER_NOT_PAIRED:
       return LOG_STR("Peer address not paired");
+    case ESP_ERR_ESPNOW_PEER_QUARANTINED:
+      return LOG_STR("Peer quarantined");
+    case ESP_ERR_ESPNOW_SUPERSEDED:
+      return LOG_STR("Superseded by newer packet");
+    case ESP_ERR_ESPNOW_EXPIRED:
+      return LOG_STR("Expired before sending");
+    case ESP_ERR_ESPNOW_PEER_DOWN:
+      return LOG_STR("Peer down");
     case ESP_ERR_ESPNOW_NOT_INIT:
       return LOG_STR("Not init");
     case ESP_ERR_ESPNOW_ARG:
@@ -70,32 +95,42 @@ void on_send_report(const esp_now_send_info_t *info, esp_now_send_status_t statu
 void on_send_report(const uint8_t *mac_addr, esp_now_send_status_t status)
 #endif
 {
-  // Allocate an event from the pool
-  ESPNowPacket *packet = global_esp_now->receive_packet_pool_.allocate();
-  if (packet == nullptr) {
+  // Send reports have their own pool so a burst of completions cannot starve received packets
+  ESPNowSendReport *report = global_esp_now->send_report_pool_.allocate();
+  if (report == nullptr) {
     // No events available - queue is full or we're out of memory
-    global_esp_now->receive_packet_queue_.increment_dropped_count();
+    global_esp_now->send_report_queue_.increment_dropped_count();
     return;
   }
 
-// Load new packet data (replaces previous packet)
 #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 5, 0)
-  packet->load_sent_data(info->des_addr, status);
+  report->load(info->des_addr, status);
 #else
-  packet->load_sent_data(mac_addr, status);
+  report->load(mac_addr, status);
 #endif
 
-  // Push the packet to the queue
-  global_esp_now->receive_packet_queue_.push(packet);
+  // Push the report to the queue
+  global_esp_now->send_report_queue_.push(report);
   // Push always because we're the only producer and the pool ensures we never exceed queue size
 
+#ifdef USE_ESPNOW_WORKER_TASK
+  // The worker task consumes send reports, the main loop only hears about completed packets
+  xTaskNotifyGive(global_esp_now->worker_task_handle_);
+#else
   // Wake main loop immediately to process ESP-NOW send event instead of waiting for select() timeout
 #if defined(USE_SOCKET_SELECT_SUPPORT) && defined(USE_WAKE_LOOP_THREADSAFE)
   App.wake_loop_threadsafe();
 #endif
+#endif
 }
 
 void on_data_received(const esp_now_recv_info_t *info, const uint8_t *data, int size) {
+  // Reject multicast frames for groups we are not a member of before they take a receive slot
+  if (memcmp(info->des_addr, ESPNOW_MULTICAST_ADDR, ESP_NOW_ETH_ALEN) == 0 &&
+      !global_esp_now->accepts_multicast_(data, size)) {
+    return;
+  }
+
   // Allocate an event from the pool
   ESPNowPacket *packet = global_esp_now->receive_packet_pool_.allocate();
   if (packet == nullptr) {
@@ -137,6 +172,55 @@ void ESPNowComponent::dump_config() {
                 own_addr_buf, version, this->wifi_channel_);
 #ifdef USE_WIFI
   ESP_LOGCONFIG(TAG, "  Wi-Fi enabled: %s", YESNO(this->is_wifi_enabled()));
+#endif
+  ESP_LOGCONFIG(TAG,
+                "  Quarantine:\n"
+                "    Failure threshold: %u\n"
+                "    Duration: %" PRIu32 " ms\n"
+                "    Mode: %s",
+                this->quarantine_threshold_, this->quarantine_duration_,
+                this->quarantine_mode_ == ESPNOW_QUARANTINE_SHED ? "shed" : "defer");
+#ifdef USE_ESPNOW_WORKER_TASK
+  ESP_LOGCONFIG(TAG,
+                "  Worker task:\n"
+                "    Core: %u\n"
+                "    Priority: %u\n"
+                "    Stack size: %" PRIu32,
+                this->worker_core_, this->worker_priority_, this->worker_stack_size_);
+#endif
+  ESP_LOGCONFIG(TAG,
+                "  Loop budget:\n"
+                "    Packets: %u\n"
+                "    Time: %" PRIu32 " us",
+                this->loop_budget_packets_, this->loop_budget_us_);
+  ESP_LOGCONFIG(TAG,
+                "  Liveness:\n"
+                "    Heartbeat interval: %" PRIu32 "-%" PRIu32 " ms\n"
+                "    Miss threshold: %u",
+                this->heartbeat_min_interval_, this->heartbeat_max_interval_, this->liveness_miss_threshold_);
+  for (const auto &entry : this->liveness_) {
+    if (!entry.in_use)
+      continue;
+    char addr_buf[MAC_ADDRESS_PRETTY_BUFFER_SIZE];
+    format_mac_addr_upper(entry.address, addr_buf);
+    ESP_LOGCONFIG(TAG, "    Monitored peer: %s", addr_buf);
+  }
+  if (this->power_save_) {
+    ESP_LOGCONFIG(TAG,
+                  "  Power save:\n"
+                  "    Wake interval: %u ms\n"
+                  "    Wake window: %u-%u ms\n"
+                  "    Idle timeout: %" PRIu32 " ms\n"
+                  "    Announce schedule: %s",
+                  this->wake_interval_, this->min_wake_window_, this->max_wake_window_, this->wake_idle_timeout_,
+                  YESNO(this->announce_schedule_));
+  }
+#ifdef USE_ESPNOW_CAPTURE
+  ESP_LOGCONFIG(TAG,
+                "  Capture: %s\n"
+                "    Buffer size: %u records\n"
+                "    Snap length: %u bytes",
+                ONOFF(this->capture_.is_enabled()), ESPNOW_CAPTURE_BUFFER_SIZE, ESPNOW_CAPTURE_SNAP_LENGTH);
 #endif
 }
 
@@ -155,6 +239,13 @@ void ESPNowComponent::setup() {
   ESP_ERROR_CHECK(esp_netif_init());
 #endif
 
+  this->next_correlation_id_ = static_cast<uint16_t>(esp_random());
+
+#ifdef USE_DEEP_SLEEP
+  // Deep sleep builds always duty cycle the radio, with fixed defaults unless power_save is configured
+  this->power_save_ = true;
+#endif
+
   if (this->enable_on_boot_) {
     this->enable_();
   } else {
@@ -181,7 +272,7 @@ void ESPNowComponent::enable_() {
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
     ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
-    ESP_ERROR_CHECK(esp_wifi_set_ps(WIFI_PS_NONE));
+    ESP_ERROR_CHECK(esp_wifi_set_ps(this->power_save_ ? WIFI_PS_MIN_MODEM : WIFI_PS_NONE));
     ESP_ERROR_CHECK(esp_wifi_start());
     ESP_ERROR_CHECK(esp_wifi_disconnect());
 
@@ -212,16 +303,34 @@ void ESPNowComponent::enable_() {
 
   esp_wifi_get_mac(WIFI_IF_STA, this->own_address_);
 
-#ifdef USE_DEEP_SLEEP
-  esp_now_set_wake_window(CONFIG_ESPNOW_WAKE_WINDOW);
-  esp_wifi_connectionless_module_set_wake_interval(CONFIG_ESPNOW_WAKE_INTERVAL);
-#endif
-
   this->state_ = ESPNOW_STATE_ENABLED;
 
+#ifdef USE_ESPNOW_WORKER_TASK
+  if (this->worker_task_handle_ == nullptr) {
+    BaseType_t created = xTaskCreatePinnedToCore(worker_task_, "espnow", this->worker_stack_size_, this,
+                                                 this->worker_priority_, &this->worker_task_handle_,
+                                                 this->worker_core_);
+    if (created != pdPASS) {
+      ESP_LOGE(TAG, "Could not create worker task");
+      this->worker_task_handle_ = nullptr;
+      this->mark_failed();
+      return;
+    }
+  }
+#endif
+
   for (auto peer : this->peers_) {
     this->add_peer(peer.address);
   }
+
+  if (this->power_save_) {
+    esp_wifi_connectionless_module_set_wake_interval(this->wake_interval_);
+    this->wake_epoch_ = millis();
+    // Start wide so the first exchanges after boot are not delayed
+    this->wake_window_ = 0;
+    this->last_activity_ = millis();
+    this->apply_wake_window_(this->max_wake_window_);
+  }
 }
 
 void ESPNowComponent::disable() {
@@ -260,6 +369,7 @@ void ESPNowComponent::apply_wifi_channel() {
 }
 
 void ESPNowComponent::loop() {
+  const uint32_t loop_start = micros();
 #ifdef USE_WIFI
   if (wifi::global_wifi_component != nullptr && wifi::global_wifi_component->is_connected()) {
     int32_t new_channel = wifi::global_wifi_component->get_wifi_channel();
@@ -269,74 +379,73 @@ void ESPNowComponent::loop() {
     }
   }
 #endif
-  // Process received packets
-  ESPNowPacket *packet = this->receive_packet_queue_.pop();
-  while (packet != nullptr) {
-    switch (packet->type_) {
-      case ESPNowPacket::RECEIVED: {
-        const ESPNowRecvInfo info = packet->get_receive_info();
-        if (!esp_now_is_peer_exist(info.src_addr)) {
-          bool handled = false;
-          for (auto *handler : this->unknown_peer_handlers_) {
-            if (handler->on_unknown_peer(info, packet->packet_.receive.data, packet->packet_.receive.size)) {
-              handled = true;
-              break;  // If a handler returns true, stop processing further handlers
-            }
-          }
-          if (!handled && this->auto_add_peer_) {
-            this->add_peer(info.src_addr);
-          }
-        }
-        // Intentionally left as if instead of else in case the peer is added above
-        if (esp_now_is_peer_exist(info.src_addr)) {
-#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERBOSE
-          char src_buf[MAC_ADDRESS_PRETTY_BUFFER_SIZE];
-          char dst_buf[MAC_ADDRESS_PRETTY_BUFFER_SIZE];
-          char hex_buf[format_hex_pretty_size(ESP_NOW_MAX_DATA_LEN)];
-          format_mac_addr_upper(info.src_addr, src_buf);
-          format_mac_addr_upper(info.des_addr, dst_buf);
-          ESP_LOGV(TAG, "<<< [%s -> %s] %s", src_buf, dst_buf,
-                   format_hex_pretty_to(hex_buf, packet->packet_.receive.data, packet->packet_.receive.size));
-#endif
-          if (memcmp(info.des_addr, ESPNOW_BROADCAST_ADDR, ESP_NOW_ETH_ALEN) == 0) {
-            for (auto *handler : this->broadcasted_handlers_) {
-              if (handler->on_broadcasted(info, packet->packet_.receive.data, packet->packet_.receive.size))
-                break;  // If a handler returns true, stop processing further handlers
-            }
-          } else {
-            for (auto *handler : this->received_handlers_) {
-              if (handler->on_received(info, packet->packet_.receive.data, packet->packet_.receive.size))
-                break;  // If a handler returns true, stop processing further handlers
-            }
-          }
-        }
-        break;
-      }
-      case ESPNowPacket::SENT: {
-#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERBOSE
-        char addr_buf[MAC_ADDRESS_PRETTY_BUFFER_SIZE];
-        format_mac_addr_upper(packet->packet_.sent.address, addr_buf);
-        ESP_LOGV(TAG, ">>> [%s] %s", addr_buf, LOG_STR_ARG(espnow_error_to_str(packet->packet_.sent.status)));
-#endif
-        if (this->current_send_packet_ != nullptr) {
-          this->current_send_packet_->callback_(packet->packet_.sent.status);
-          this->send_packet_pool_.release(this->current_send_packet_);
-          this->current_send_packet_ = nullptr;  // Reset current packet after sending
-        }
-        break;
-      }
-      default:
-        break;
+#ifdef USE_ESPNOW_WORKER_TASK
+  // The worker task transmits; only the completions come back here, to run the callbacks
+  ESPNowSendPacket *done = this->send_done_queue_.pop();
+  while (done != nullptr) {
+    if (done->transmitted_)
+      this->note_delivery_(done->address_, done->status_ == ESP_OK);
+    if (done->callback_ != nullptr) {
+      done->callback_(done->status_);
     }
+    this->send_packet_pool_.release(done);
+    done = this->send_done_queue_.pop();
+  }
+  if (this->worker_warning_.exchange(false))
+    this->status_momentary_warning("send-failed");
+#else
+  // Completions deferred out of send(); a callback sending again defers to the next iteration
+  ESPNowSendPacket *deferred = this->deferred_head_;
+  this->deferred_head_ = nullptr;
+  this->deferred_tail_ = nullptr;
+  while (deferred != nullptr) {
+    ESPNowSendPacket *next = deferred->next_;
+    deferred->next_ = nullptr;
+    this->complete_packet_(deferred, deferred->status_);
+    deferred = next;
+  }
+  // Process send reports first so the next queued packet can go out as early as possible
+  this->process_send_reports_();
+#endif
+
+  // Process received packets within the budget, so a burst cannot stall the other components.
+  // Whatever is left stays queued for the next iteration.
+  uint16_t processed = 0;
+  while (this->loop_budget_packets_ == 0 || processed < this->loop_budget_packets_) {
+    // At least one packet per iteration, so the queue always makes progress
+    if (processed != 0 && this->loop_budget_us_ != 0 && micros() - loop_start >= this->loop_budget_us_)
+      break;
+    ESPNowPacket *packet = this->receive_packet_queue_.pop();
+    if (packet == nullptr)
+      break;
+    this->process_received_packet_(packet);
     // Return the packet to the pool
     this->receive_packet_pool_.release(packet);
-    packet = this->receive_packet_queue_.pop();
+    processed++;
+  }
+  // Come back without the usual loop delay while a backlog remains
+  const bool backlog = !this->receive_packet_queue_.empty();
+  if (backlog && !this->loop_backlog_) {
+    this->high_freq_.start();
+  } else if (!backlog && this->loop_backlog_) {
+    this->high_freq_.stop();
   }
+  this->loop_backlog_ = backlog;
+
+  this->check_rpc_timeouts_();
+  this->check_liveness_();
+  this->update_wake_window_();
+#ifdef USE_ESPNOW_CAPTURE
+  if (this->capture_dumping_)
+    this->dump_capture_step_();
+#endif
 
+#ifndef USE_ESPNOW_WORKER_TASK
   // Process sending packet queue
-  if (this->current_send_packet_ == nullptr) {
+  if (this->send_lanes_.current() == nullptr) {
     this->send_();
   }
+#endif
 
   // Log dropped received packets periodically
   uint16_t received_dropped = this->receive_packet_queue_.get_and_reset_dropped_count();
@@ -344,13 +453,264 @@ void ESPNowComponent::loop() {
     ESP_LOGW(TAG, "Dropped %u received packets due to buffer overflow", received_dropped);
   }
 
+  // Log dropped send reports periodically
+  uint16_t reports_dropped = this->send_report_queue_.get_and_reset_dropped_count();
+  if (reports_dropped > 0) {
+    ESP_LOGW(TAG, "Dropped %u send reports due to buffer overflow", reports_dropped);
+  }
+
   // Log dropped send packets periodically
-  uint16_t send_dropped = this->send_packet_queue_.get_and_reset_dropped_count();
+  const uint16_t send_dropped = this->send_dropped_.exchange(0);
   if (send_dropped > 0) {
     ESP_LOGW(TAG, "Dropped %u send packets due to buffer overflow", send_dropped);
   }
+
+  this->record_loop_time_(micros() - loop_start, processed, backlog);
+}
+
+void ESPNowComponent::record_loop_time_(uint32_t elapsed_us, uint16_t packets, bool backlog) {
+  ESPNowLoopStats &stats = this->loop_stats_;
+  stats.loops++;
+  stats.packets += packets;
+  stats.total_us += elapsed_us;
+  if (elapsed_us > stats.max_us)
+    stats.max_us = elapsed_us;
+  if (backlog)
+    stats.deferred++;
+
+  const uint32_t now = millis();
+  if (now - this->loop_stats_start_ < ESPNOW_LOOP_STATS_INTERVAL_MS)
+    return;
+  if (stats.packets != 0) {
+    ESP_LOGD(TAG,
+             "Processing: %" PRIu32 " packets, %" PRIu32 " us total, %" PRIu32 " us max per loop, %" PRIu32
+             " loops with backlog",
+             stats.packets, stats.total_us, stats.max_us, stats.deferred);
+  }
+  this->last_loop_stats_ = stats;
+  stats = ESPNowLoopStats{};
+  this->loop_stats_start_ = now;
 }
 
+void ESPNowComponent::process_send_reports_() {
+  ESPNowSendReport *report = this->send_report_queue_.pop();
+  while (report != nullptr) {
+    this->process_send_report_(report);
+    this->send_report_pool_.release(report);
+    report = this->send_report_queue_.pop();
+  }
+}
+
+#ifdef USE_ESPNOW_WORKER_TASK
+void ESPNowComponent::worker_task_(void *param) {
+  auto *self = static_cast<ESPNowComponent *>(param);
+  while (true) {
+    // Woken by send() and by send reports; the timeout covers packet deadlines and quarantine expiry
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ESPNOW_WORKER_IDLE_MS));
+    self->process_send_reports_();
+    ESPNowSendPacket *packet = self->send_request_queue_.pop();
+    while (packet != nullptr) {
+      if (packet->drop_lane_) {
+        // Posted by del_peer(); the request goes back to the main loop to be released
+        self->fail_packets_(self->send_lanes_.drop(packet->address_), ESP_ERR_ESPNOW_NOT_FOUND);
+        self->complete_packet_(packet, ESP_OK);
+      } else {
+        esp_err_t err = self->queue_packet_(packet);
+        if (err != ESP_OK)
+          self->complete_packet_(packet, err);
+      }
+      packet = self->send_request_queue_.pop();
+    }
+    if (self->send_lanes_.current() == nullptr)
+      self->send_();
+  }
+}
+#endif
+
+void ESPNowComponent::momentary_warning_(const char *name) {
+#ifdef USE_ESPNOW_WORKER_TASK
+  // The scheduler behind status_momentary_warning() belongs to the main loop
+  if (xTaskGetCurrentTaskHandle() == this->worker_task_handle_) {
+    this->worker_warning_ = true;
+    return;
+  }
+#endif
+  this->status_momentary_warning(name);
+}
+
+void ESPNowComponent::process_received_packet_(ESPNowPacket *packet) {
+  switch (packet->type_) {
+    case ESPNowPacket::RECEIVED: {
+      const ESPNowRecvInfo info = packet->get_receive_info();
+#ifdef USE_ESPNOW_CAPTURE
+      this->capture_.record(CAPTURE_RX, info.src_addr, packet->packet_.receive.rx_ctrl.rssi, false,
+                            packet->packet_.receive.data, packet->packet_.receive.size);
+#endif
+      if (!esp_now_is_peer_exist(info.src_addr)) {
+        this->fire_triggers_(ESPNOW_TRIGGER_UNKNOWN_PEER, info, packet->packet_.receive.data,
+                             packet->packet_.receive.size);
+        bool handled = false;
+        for (auto *handler : this->unknown_peer_handlers_) {
+          if (handler->on_unknown_peer(info, packet->packet_.receive.data, packet->packet_.receive.size)) {
+            handled = true;
+            break;  // If a handler returns true, stop processing further handlers
+          }
+        }
+        if (!handled && this->auto_add_peer_) {
+          this->add_peer(info.src_addr);
+        }
+      }
+      // Intentionally left as if instead of else in case the peer is added above
+      if (esp_now_is_peer_exist(info.src_addr)) {
+        // Any frame proves the peer is awake right now
+        this->peer_schedules_.heard(info.src_addr, millis());
+        ESPNowLinkQuality *link = this->acquire_link_(info.src_addr);
+        link->add_rssi(packet->packet_.receive.rx_ctrl.rssi);
+        link->last_update = millis();
+        this->note_peer_alive_(info.src_addr);
+        if (espnow_frame_type(packet->packet_.receive.data, packet->packet_.receive.size) != ESPNOW_FRAME_SCHEDULE)
+          this->note_activity_();
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERBOSE
+        char src_buf[MAC_ADDRESS_PRETTY_BUFFER_SIZE];
+        char dst_buf[MAC_ADDRESS_PRETTY_BUFFER_SIZE];
+        char hex_buf[format_hex_pretty_size(ESP_NOW_MAX_DATA_LEN)];
+        format_mac_addr_upper(info.src_addr, src_buf);
+        format_mac_addr_upper(info.des_addr, dst_buf);
+        ESP_LOGV(TAG, "<<< [%s -> %s] %s", src_buf, dst_buf,
+                 format_hex_pretty_to(hex_buf, packet->packet_.receive.data, packet->packet_.receive.size));
+#endif
+        if (this->handle_frame_(info, packet->packet_.receive.data, packet->packet_.receive.size)) {
+          // Consumed by one of the component's own protocols
+        } else if (memcmp(info.des_addr, ESPNOW_BROADCAST_ADDR, ESP_NOW_ETH_ALEN) == 0) {
+          this->fire_triggers_(ESPNOW_TRIGGER_BROADCAST, info, packet->packet_.receive.data,
+                               packet->packet_.receive.size);
+          for (auto *handler : this->broadcasted_handlers_) {
+            if (handler->on_broadcasted(info, packet->packet_.receive.data, packet->packet_.receive.size))
+              break;  // If a handler returns true, stop processing further handlers
+          }
+        } else {
+          this->fire_triggers_(ESPNOW_TRIGGER_RECEIVE, info, packet->packet_.receive.data,
+                               packet->packet_.receive.size);
+          for (auto *handler : this->received_handlers_) {
+            if (handler->on_received(info, packet->packet_.receive.data, packet->packet_.receive.size))
+              break;  // If a handler returns true, stop processing further handlers
+          }
+        }
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+void ESPNowComponent::process_send_report_(ESPNowSendReport *report) {
+#ifdef USE_ESPNOW_CAPTURE
+  this->capture_.record(CAPTURE_TX_STATUS, report->address_, 0, report->status_ != ESP_NOW_SEND_SUCCESS, nullptr, 0);
+#endif
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERBOSE
+  char addr_buf[MAC_ADDRESS_PRETTY_BUFFER_SIZE];
+  format_mac_addr_upper(report->address_, addr_buf);
+  ESP_LOGV(TAG, ">>> [%s] %s", addr_buf, LOG_STR_ARG(espnow_error_to_str(report->status_)));
+#endif
+  if (this->send_lanes_.current() == nullptr) {
+    return;
+  }
+  // Update the peer state before running the callback, so a send issued from the callback sees it
+  ESPNowPacketLanes::Lane *lane;
+  ESPNowSendPacket *packet = this->send_lanes_.finish(&lane);
+  const bool success = report->status_ == ESP_NOW_SEND_SUCCESS;
+#ifndef USE_ESPNOW_WORKER_TASK
+  // With the worker task the main loop does this when it picks up the completed packet
+  this->note_delivery_(report->address_, success);
+#endif
+  if (lane != nullptr) {
+    const bool unicast = memcmp(lane->address, ESPNOW_BROADCAST_ADDR, ESP_NOW_ETH_ALEN) != 0 &&
+                         memcmp(lane->address, ESPNOW_MULTICAST_ADDR, ESP_NOW_ETH_ALEN) != 0;
+    const auto outcome = this->send_lanes_.report(lane, success, unicast, millis(), this->quarantine_threshold_,
+                                                  this->quarantine_duration_);
+    if (outcome == ESPNowPacketLanes::OUTCOME_RECOVERED) {
+      char addr_buf[MAC_ADDRESS_PRETTY_BUFFER_SIZE];
+      format_mac_addr_upper(lane->address, addr_buf);
+      ESP_LOGI(TAG, "Peer %s reachable again, leaving quarantine", addr_buf);
+    } else if (outcome == ESPNowPacketLanes::OUTCOME_QUARANTINED) {
+      char addr_buf[MAC_ADDRESS_PRETTY_BUFFER_SIZE];
+      format_mac_addr_upper(lane->address, addr_buf);
+      ESP_LOGW(TAG, "Peer %s quarantined for %" PRIu32 " ms after %u failed sends", addr_buf,
+               this->quarantine_duration_, lane->consecutive_failures);
+      if (this->quarantine_mode_ == ESPNOW_QUARANTINE_SHED) {
+        this->fail_packets_(this->send_lanes_.take(lane), ESP_ERR_ESPNOW_PEER_QUARANTINED);
+      }
+    }
+  }
+
+  this->complete_packet_(packet, report->status_, true);
+}
+
+void ESPNowComponent::note_delivery_(const uint8_t *peer, bool success) {
+  // Broadcast and multicast frames are never acknowledged, they say nothing about a link
+  if (memcmp(peer, ESPNOW_BROADCAST_ADDR, ESP_NOW_ETH_ALEN) == 0 ||
+      memcmp(peer, ESPNOW_MULTICAST_ADDR, ESP_NOW_ETH_ALEN) == 0)
+    return;
+  ESPNowLinkQuality *link = this->acquire_link_(peer);
+  link->add_delivery(success);
+  link->last_update = millis();
+  if (success) {
+    this->note_peer_alive_(peer);
+  } else {
+    this->note_peer_missed_(peer);
+  }
+}
+
+void ESPNowComponent::complete_packet_(ESPNowSendPacket *packet, esp_err_t status, bool transmitted) {
+#ifdef USE_ESPNOW_WORKER_TASK
+  // Callbacks belong to main loop components; hand the packet back instead of running it here
+  packet->status_ = status;
+  packet->transmitted_ = transmitted;
+  this->send_done_queue_.push(packet);
+#if defined(USE_SOCKET_SELECT_SUPPORT) && defined(USE_WAKE_LOOP_THREADSAFE)
+  App.wake_loop_threadsafe();
+#endif
+#else
+  if (packet->callback_ != nullptr) {
+    packet->callback_(status);
+  }
+  this->send_packet_pool_.release(packet);
+#endif
+}
+
+void ESPNowComponent::defer_completion_(ESPNowSendPacket *packet, esp_err_t status) {
+#ifdef USE_ESPNOW_WORKER_TASK
+  // The worker task already hands every completion to the main loop
+  this->complete_packet_(packet, status);
+#else
+  packet->status_ = status;
+  packet->next_ = nullptr;
+  if (this->deferred_tail_ == nullptr) {
+    this->deferred_head_ = packet;
+  } else {
+    this->deferred_tail_->next_ = packet;
+  }
+  this->deferred_tail_ = packet;
+#endif
+}
+
+void ESPNowComponent::fail_packets_(ESPNowSendPacket *packets, esp_err_t err) {
+  while (packets != nullptr) {
+    ESPNowSendPacket *next = packets->next_;
+    packets->next_ = nullptr;
+    this->complete_packet_(packets, err);
+    packets = next;
+  }
+}
+
+#ifndef USE_ESPNOW_WORKER_TASK
+bool ESPNowComponent::is_peer_quarantined(const uint8_t *peer) {
+  const auto *lane = this->send_lanes_.find(peer);
+  return lane != nullptr && lane->is_quarantined(millis());
+}
+#endif
+
 uint8_t ESPNowComponent::get_wifi_channel() {
   wifi_second_chan_t dummy;
   esp_wifi_get_channel(&this->wifi_channel_, &dummy);
@@ -358,7 +718,7 @@ uint8_t ESPNowComponent::get_wifi_channel() {
 }
 
 esp_err_t ESPNowComponent::send(const uint8_t *peer_address, const uint8_t *payload, size_t size,
-                                const send_callback_t &callback) {
+                                const send_callback_t &callback, const ESPNowSendOptions &options) {
   if (this->state_ != ESPNOW_STATE_ENABLED) {
     return ESP_ERR_ESPNOW_NOT_INIT;
   } else if (this->is_failed()) {
@@ -370,7 +730,8 @@ esp_err_t ESPNowComponent::send(const uint8_t *peer_address, const uint8_t *payl
   } else if (size > ESP_NOW_MAX_DATA_LEN) {
     return ESP_ERR_ESPNOW_DATA_SIZE;
   } else if (!esp_now_is_peer_exist(peer_address)) {
-    if (memcmp(peer_address, ESPNOW_BROADCAST_ADDR, ESP_NOW_ETH_ALEN) == 0 || this->auto_add_peer_) {
+    if (memcmp(peer_address, ESPNOW_BROADCAST_ADDR, ESP_NOW_ETH_ALEN) == 0 ||
+        memcmp(peer_address, ESPNOW_MULTICAST_ADDR, ESP_NOW_ETH_ALEN) == 0 || this->auto_add_peer_) {
       esp_err_t err = this->add_peer(peer_address);
       if (err != ESP_OK) {
         return err;
@@ -379,43 +740,539 @@ esp_err_t ESPNowComponent::send(const uint8_t *peer_address, const uint8_t *payl
       return ESP_ERR_ESPNOW_PEER_NOT_PAIRED;
     }
   }
+  const uint8_t frame_type = espnow_frame_type(payload, size);
+  // Heartbeats are how a down peer is noticed coming back, everything else fails fast
+  if (frame_type != ESPNOW_FRAME_HEARTBEAT && this->is_peer_down(peer_address)) {
+    return ESP_ERR_ESPNOW_PEER_DOWN;
+  }
+  if (frame_type != ESPNOW_FRAME_SCHEDULE && frame_type != ESPNOW_FRAME_HEARTBEAT)
+    this->note_activity_();
   // Allocate a packet from the pool
   ESPNowSendPacket *packet = this->send_packet_pool_.allocate();
   if (packet == nullptr) {
-    this->send_packet_queue_.increment_dropped_count();
+    this->send_dropped_++;
     ESP_LOGE(TAG, "Failed to allocate send packet from pool");
     this->status_momentary_warning("send-packet-pool-full");
     return ESP_ERR_ESPNOW_NO_MEM;
   }
   // Load the packet data
   packet->load_data(peer_address, payload, size, callback);
-  // Push the packet to the send queue
-  this->send_packet_queue_.push(packet);
+  packet->supersede_key_ = options.supersede_key;
+  packet->deadline_ = options.timeout_ms == 0 ? 0 : (millis() + options.timeout_ms) | 1;
+  packet->next_ = nullptr;
+  packet->drop_lane_ = false;
+#ifdef USE_ESPNOW_WORKER_TASK
+  // The worker task owns the send lanes, errors while queueing reach the callback
+  this->send_request_queue_.push(packet);
+  xTaskNotifyGive(this->worker_task_handle_);
   return ESP_OK;
+#else
+  esp_err_t err = this->queue_packet_(packet);
+  if (err != ESP_OK) {
+    // Not queued, the returned error is the only answer the caller gets
+    this->send_packet_pool_.release(packet);
+  }
+  return err;
+#endif
+}
+
+esp_err_t ESPNowComponent::queue_packet_(ESPNowSendPacket *packet) {
+  ESPNowSendPacket *displaced;
+  switch (this->send_lanes_.enqueue(packet, millis(), this->quarantine_mode_ == ESPNOW_QUARANTINE_SHED, &displaced)) {
+    case ESPNowPacketLanes::NO_LANE:
+      this->send_dropped_++;
+      ESP_LOGE(TAG, "No free send lane, too many peers with queued packets");
+      this->momentary_warning_("send-lane-full");
+      return ESP_ERR_ESPNOW_NO_MEM;
+    case ESPNowPacketLanes::QUARANTINED:
+      return ESP_ERR_ESPNOW_PEER_QUARANTINED;
+    case ESPNowPacketLanes::QUEUED_SUPERSEDED:
+      // Not from inside send(): the callback belongs to another sender and may call send() itself
+      this->defer_completion_(displaced, ESP_ERR_ESPNOW_SUPERSEDED);
+      return ESP_OK;
+    case ESPNowPacketLanes::QUEUED_EVICTED:
+      // The peer's oldest packet made room rather than letting one peer occupy the shared pool
+      this->send_dropped_++;
+      this->defer_completion_(displaced, ESP_ERR_ESPNOW_NO_MEM);
+      return ESP_OK;
+    default:
+      return ESP_OK;
+  }
 }
 
 void ESPNowComponent::send_() {
-  ESPNowSendPacket *packet = this->send_packet_queue_.pop();
+  // Serve peers round-robin, one packet per turn, skipping quarantined ones and sleeping ones
+  ESPNowSendPacket *packet = this->send_lanes_.next(
+      millis(),
+      [this](const uint8_t *peer, uint32_t now) {
+        return this->peer_schedules_.is_awake(peer, now, ESPNOW_SCHEDULE_STALE_MS);
+      },
+      [this](ESPNowSendPacket *expired) { this->complete_packet_(expired, ESP_ERR_ESPNOW_EXPIRED); });
   if (packet == nullptr) {
     return;  // No packets to send
   }
 
-  this->current_send_packet_ = packet;
   esp_err_t err = esp_now_send(packet->address_, packet->data_, packet->size_);
+#ifdef USE_ESPNOW_CAPTURE
+  this->capture_.record(CAPTURE_TX, packet->address_, 0, err != ESP_OK, packet->data_, packet->size_);
+#endif
   if (err != ESP_OK) {
     char addr_buf[MAC_ADDRESS_PRETTY_BUFFER_SIZE];
     format_mac_addr_upper(packet->address_, addr_buf);
     ESP_LOGE(TAG, "Failed to send packet to %s - %s", addr_buf, LOG_STR_ARG(espnow_error_to_str(err)));
-    if (packet->callback_ != nullptr) {
-      packet->callback_(err);
+    this->send_lanes_.finish();  // Nothing in flight any more
+    this->momentary_warning_("send-failed");
+    this->complete_packet_(packet, err);
+    return;
+  }
+}
+
+esp_err_t ESPNowComponent::call(const uint8_t *peer_address, uint8_t method, const uint8_t *payload, size_t size,
+                                const rpc_response_callback_t &on_response, const rpc_failure_callback_t &on_failure,
+                                uint32_t timeout_ms) {
+  if (size > ESPNOW_RPC_MAX_PAYLOAD) {
+    return ESP_ERR_ESPNOW_DATA_SIZE;
+  }
+  ESPNowPendingRPC *pending = nullptr;
+  for (auto &slot : this->pending_rpcs_) {
+    if (!slot.in_use) {
+      pending = &slot;
+      break;
     }
-    this->status_momentary_warning("send-failed");
-    this->send_packet_pool_.release(packet);
-    this->current_send_packet_ = nullptr;  // Reset current packet
+  }
+  if (pending == nullptr) {
+    ESP_LOGW(TAG, "Too many pending RPC calls");
+    this->status_momentary_warning("rpc-table-full");
+    return ESP_ERR_ESPNOW_NO_MEM;
+  }
+
+  const uint16_t correlation_id = this->next_correlation_id_++;
+  memcpy(pending->address, peer_address, ESP_NOW_ETH_ALEN);
+  pending->correlation_id = correlation_id;
+  pending->deadline = millis() + timeout_ms;
+  pending->on_response = on_response;
+  pending->on_failure = on_failure;
+  pending->in_use = true;
+
+  uint8_t frame[ESP_NOW_MAX_DATA_LEN];
+  ESPNowRPCHeader header{};
+  header.frame.init(ESPNOW_FRAME_RPC_REQUEST);
+  header.correlation_id = correlation_id;
+  header.method = method;
+  header.status = ESPNOW_RPC_OK;
+  memcpy(frame, &header, sizeof(header));
+  if (size > 0) {
+    memcpy(frame + sizeof(header), payload, size);
+  }
+
+  esp_err_t err = this->send(peer_address, frame, sizeof(header) + size, [this, correlation_id](esp_err_t status) {
+    if (status == ESP_OK)
+      return;
+    // The request never reached the peer, so no response will come
+    for (auto &slot : this->pending_rpcs_) {
+      if (slot.in_use && slot.correlation_id == correlation_id) {
+        this->finish_rpc_(&slot, status, nullptr, 0);
+        break;
+      }
+    }
+  });
+  if (err != ESP_OK) {
+    *pending = ESPNowPendingRPC{};
+  }
+  return err;
+}
+
+bool ESPNowComponent::handle_frame_(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) {
+  const uint8_t type = espnow_frame_type(data, size);
+  switch (type) {
+    case 0:
+      return false;
+    case ESPNOW_FRAME_RPC_REQUEST:
+      this->handle_rpc_request_(info, data, size);
+      return true;
+    case ESPNOW_FRAME_RPC_RESPONSE:
+      this->handle_rpc_response_(info, data, size);
+      return true;
+    case ESPNOW_FRAME_GROUP:
+      this->handle_group_frame_(info, data, size);
+      return true;
+    case ESPNOW_FRAME_SCHEDULE:
+      this->handle_schedule_frame_(info, data, size);
+      return true;
+    case ESPNOW_FRAME_HEARTBEAT:
+      // Nothing to do, receiving it already counted as proof of life
+      return true;
+    default: {
+      // Every handler registered for the type sees the frame, e.g. several switches sharing one protocol
+      bool handled = false;
+      for (auto &entry : this->frame_handlers_) {
+        if (entry.first == type) {
+          entry.second->on_frame(info, data, size);
+          handled = true;
+        }
+      }
+      return handled;
+    }
+  }
+}
+
+void ESPNowComponent::handle_rpc_request_(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) {
+  if (size < sizeof(ESPNowRPCHeader))
+    return;
+  ESPNowRPCHeader request;
+  memcpy(&request, data, sizeof(request));
+
+  uint8_t frame[ESP_NOW_MAX_DATA_LEN];
+  ESPNowRPCHeader response{};
+  response.frame.init(ESPNOW_FRAME_RPC_RESPONSE);
+  response.correlation_id = request.correlation_id;
+  response.method = request.method;
+  response.status = ESPNOW_RPC_UNKNOWN_METHOD;
+
+  size_t response_size = 0;
+  for (auto &entry : this->rpc_methods_) {
+    if (entry.first != request.method)
+      continue;
+    response_size = entry.second(info, data + sizeof(request), size - sizeof(request), frame + sizeof(response));
+    if (response_size > ESPNOW_RPC_MAX_PAYLOAD)
+      response_size = ESPNOW_RPC_MAX_PAYLOAD;
+    response.status = ESPNOW_RPC_OK;
+    break;
+  }
+  memcpy(frame, &response, sizeof(response));
+
+  // Always answer the caller directly instead of broadcasting
+  esp_err_t err = this->send(info.src_addr, frame, sizeof(response) + response_size);
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "Failed to queue RPC response - %s", LOG_STR_ARG(espnow_error_to_str(err)));
+  }
+}
+
+void ESPNowComponent::handle_rpc_response_(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) {
+  if (size < sizeof(ESPNowRPCHeader))
+    return;
+  ESPNowRPCHeader response;
+  memcpy(&response, data, sizeof(response));
+
+  for (auto &slot : this->pending_rpcs_) {
+    if (!slot.in_use || slot.correlation_id != response.correlation_id ||
+        memcmp(slot.address, info.src_addr, ESP_NOW_ETH_ALEN) != 0)
+      continue;
+    esp_err_t error = response.status == ESPNOW_RPC_OK ? ESP_OK : ESP_ERR_NOT_SUPPORTED;
+    this->finish_rpc_(&slot, error, data + sizeof(response), size - sizeof(response));
+    return;
+  }
+  ESP_LOGV(TAG, "Ignoring late or unknown RPC response %u", response.correlation_id);
+}
+
+esp_err_t ESPNowComponent::send_group(uint8_t group, const uint8_t *payload, size_t size,
+                                      const send_callback_t &callback, const ESPNowSendOptions &options) {
+  if (size > ESPNOW_GROUP_MAX_PAYLOAD) {
+    return ESP_ERR_ESPNOW_DATA_SIZE;
+  }
+  uint8_t frame[ESP_NOW_MAX_DATA_LEN];
+  ESPNowGroupHeader header{};
+  header.frame.init(ESPNOW_FRAME_GROUP);
+  header.group = group;
+  memcpy(frame, &header, sizeof(header));
+  if (size > 0) {
+    memcpy(frame + sizeof(header), payload, size);
+  }
+  return this->send(ESPNOW_MULTICAST_ADDR, frame, sizeof(header) + size, callback, options);
+}
+
+bool ESPNowComponent::accepts_multicast_(const uint8_t *data, int size) const {
+  if (size < static_cast<int>(sizeof(ESPNowGroupHeader)) ||
+      espnow_frame_type(data, static_cast<uint8_t>(size)) != ESPNOW_FRAME_GROUP)
+    return false;
+  return this->is_group_member(data[offsetof(ESPNowGroupHeader, group)]);
+}
+
+void ESPNowComponent::handle_group_frame_(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) {
+  if (size < sizeof(ESPNowGroupHeader))
     return;
+  const uint8_t group = data[offsetof(ESPNowGroupHeader, group)];
+  if (!this->is_group_member(group))
+    return;  // Left the group after the frame was queued
+  this->fire_triggers_(ESPNOW_TRIGGER_GROUP, info, data + sizeof(ESPNowGroupHeader), size - sizeof(ESPNowGroupHeader),
+                       group);
+  for (auto *handler : this->group_handlers_) {
+    if (handler->on_group(info, group, data + sizeof(ESPNowGroupHeader), size - sizeof(ESPNowGroupHeader)))
+      break;  // If a handler returns true, stop processing further handlers
+  }
+}
+
+void ESPNowComponent::fire_triggers_(ESPNowTriggerKind kind, const ESPNowRecvInfo &info, const uint8_t *data,
+                                     uint8_t size, uint8_t group) {
+  for (size_t i = 0; i < this->num_triggers_; i++) {
+    const ESPNowTriggerEntry &entry = this->triggers_[i];
+    if (entry.matches(kind, info.src_addr, group))
+      entry.trigger->trigger(info, data, size);
   }
 }
 
+void ESPNowComponent::handle_schedule_frame_(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) {
+  if (size < sizeof(ESPNowScheduleHeader))
+    return;
+  ESPNowScheduleHeader header;
+  memcpy(&header, data, sizeof(header));
+  this->peer_schedules_.announce(info.src_addr, header.wake_interval, header.wake_window, header.window_offset,
+                                 millis());
+}
+
+ESPNowLinkQuality *ESPNowComponent::acquire_link_(const uint8_t *peer) {
+  const uint32_t now = millis();
+  ESPNowLinkQuality *oldest = &this->links_[0];
+  for (auto &link : this->links_) {
+    if (link.in_use && memcmp(link.address, peer, ESP_NOW_ETH_ALEN) == 0)
+      return &link;
+  }
+  for (auto &link : this->links_) {
+    if (!link.in_use) {
+      oldest = &link;
+      break;
+    }
+    if (now - link.last_update > now - oldest->last_update)
+      oldest = &link;
+  }
+  *oldest = ESPNowLinkQuality{};
+  memcpy(oldest->address, peer, ESP_NOW_ETH_ALEN);
+  oldest->in_use = true;
+  oldest->last_update = now;
+  return oldest;
+}
+
+const ESPNowLinkQuality *ESPNowComponent::get_link_quality(const uint8_t *peer) const {
+  for (const auto &link : this->links_) {
+    if (link.in_use && memcmp(link.address, peer, ESP_NOW_ETH_ALEN) == 0)
+      return &link;
+  }
+  return nullptr;
+}
+
+void ESPNowComponent::monitor_peer(const uint8_t *peer) {
+  if (this->find_liveness_(peer) != nullptr)
+    return;
+  for (auto &entry : this->liveness_) {
+    if (entry.in_use)
+      continue;
+    entry = ESPNowPeerLiveness{};
+    memcpy(entry.address, peer, ESP_NOW_ETH_ALEN);
+    entry.interval = this->heartbeat_min_interval_;
+    entry.last_seen = millis();
+    entry.in_use = true;
+    return;
+  }
+  char addr_buf[MAC_ADDRESS_PRETTY_BUFFER_SIZE];
+  format_mac_addr_upper(peer, addr_buf);
+  ESP_LOGW(TAG, "Too many monitored peers, not monitoring %s", addr_buf);
+}
+
+ESPNowPeerLiveness *ESPNowComponent::find_liveness_(const uint8_t *peer) {
+  for (auto &entry : this->liveness_) {
+    if (entry.in_use && memcmp(entry.address, peer, ESP_NOW_ETH_ALEN) == 0)
+      return &entry;
+  }
+  return nullptr;
+}
+
+ESPNowPeerState ESPNowComponent::get_peer_state(const uint8_t *peer) const {
+  for (const auto &entry : this->liveness_) {
+    if (entry.in_use && memcmp(entry.address, peer, ESP_NOW_ETH_ALEN) == 0)
+      return entry.state;
+  }
+  return ESPNOW_PEER_UNKNOWN;
+}
+
+void ESPNowComponent::note_peer_alive_(const uint8_t *peer) {
+  ESPNowPeerLiveness *entry = this->find_liveness_(peer);
+  if (entry == nullptr)
+    return;
+  entry->last_seen = millis();
+  entry->misses = 0;
+  this->set_peer_state_(entry, ESPNOW_PEER_ALIVE);
+}
+
+void ESPNowComponent::note_peer_missed_(const uint8_t *peer) {
+  ESPNowPeerLiveness *entry = this->find_liveness_(peer);
+  if (entry == nullptr)
+    return;
+  if (entry->misses < UINT8_MAX)
+    entry->misses++;
+  if (entry->state == ESPNOW_PEER_DOWN)
+    return;
+  // Check again soon instead of waiting out a long interval
+  entry->interval = this->heartbeat_min_interval_;
+  if (entry->misses >= this->liveness_miss_threshold_)
+    this->set_peer_state_(entry, ESPNOW_PEER_DOWN);
+}
+
+void ESPNowComponent::set_peer_state_(ESPNowPeerLiveness *entry, ESPNowPeerState state) {
+  if (entry->state == state)
+    return;
+  entry->state = state;
+  char addr_buf[MAC_ADDRESS_PRETTY_BUFFER_SIZE];
+  format_mac_addr_upper(entry->address, addr_buf);
+  if (state == ESPNOW_PEER_DOWN) {
+    ESP_LOGW(TAG, "Peer %s is down after %u unacknowledged sends", addr_buf, entry->misses);
+    // Sends to the peer fail until a heartbeat gets through, so probe at the fastest rate
+    entry->interval = this->heartbeat_min_interval_;
+#ifndef USE_ESPNOW_WORKER_TASK
+    // With the worker task the lanes are not ours to touch; queued packets fail on their own
+    auto *lane = this->send_lanes_.find(entry->address);
+    if (lane != nullptr)
+      this->fail_packets_(this->send_lanes_.take(lane), ESP_ERR_ESPNOW_PEER_DOWN);
+#endif
+  } else {
+    ESP_LOGI(TAG, "Peer %s is up", addr_buf);
+    entry->interval = this->heartbeat_min_interval_;
+  }
+  this->liveness_callback_.call(entry->address, state == ESPNOW_PEER_ALIVE);
+}
+
+void ESPNowComponent::check_liveness_() {
+  const uint32_t now = millis();
+  for (auto &entry : this->liveness_) {
+    if (!entry.in_use || entry.probe_in_flight)
+      continue;
+    // Traffic in either direction since the last heartbeat postpones the next one
+    const uint32_t quiet_since =
+        static_cast<int32_t>(entry.last_probe - entry.last_seen) > 0 ? entry.last_probe : entry.last_seen;
+    if (now - quiet_since < entry.interval)
+      continue;
+#ifndef USE_ESPNOW_WORKER_TASK
+    // Queued traffic gets acknowledged as well, a heartbeat would add nothing
+    if (this->send_lanes_.is_busy(entry.address))
+      continue;
+#endif
+    if (!esp_now_is_peer_exist(entry.address))
+      continue;
+
+    ESPNowHeartbeatHeader header{};
+    header.frame.init(ESPNOW_FRAME_HEARTBEAT);
+    ESPNowPeerLiveness *probed = &entry;
+    entry.last_probe = now;
+    entry.probe_in_flight = true;
+    esp_err_t err = this->send(
+        entry.address, reinterpret_cast<const uint8_t *>(&header), sizeof(header),
+        [this, probed](esp_err_t status) {
+          probed->probe_in_flight = false;
+          // A peer that keeps answering is probed less and less often
+          if (status == ESP_OK && probed->state == ESPNOW_PEER_ALIVE)
+            probed->interval = std::min(probed->interval * 2, this->heartbeat_max_interval_);
+        });
+    if (err != ESP_OK)
+      entry.probe_in_flight = false;
+  }
+}
+
+void ESPNowComponent::note_activity_() {
+  if (!this->power_save_)
+    return;
+  this->last_activity_ = millis();
+  if (this->wake_window_ < this->max_wake_window_)
+    this->apply_wake_window_(this->max_wake_window_);
+}
+
+void ESPNowComponent::update_wake_window_() {
+  if (!this->power_save_ || this->wake_window_ <= this->min_wake_window_)
+    return;
+  const uint32_t now = millis();
+  if (now - this->last_activity_ < this->wake_idle_timeout_)
+    return;
+  // Step down gradually, so a burst shortly after going idle still finds a fairly wide window
+  this->last_activity_ = now;
+  this->apply_wake_window_(std::max<uint16_t>(this->min_wake_window_, this->wake_window_ / 2));
+}
+
+void ESPNowComponent::apply_wake_window_(uint16_t window) {
+  if (window == this->wake_window_)
+    return;
+  esp_err_t err = esp_now_set_wake_window(window);
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "esp_now_set_wake_window failed: %s", esp_err_to_name(err));
+    return;
+  }
+  ESP_LOGV(TAG, "Wake window %u -> %u ms", this->wake_window_, window);
+  this->wake_window_ = window;
+  if (this->announce_schedule_) {
+    ESPNowScheduleHeader header{};
+    header.frame.init(ESPNOW_FRAME_SCHEDULE);
+    header.wake_interval = this->wake_interval_;
+    header.wake_window = window;
+    header.window_offset = (millis() - this->wake_epoch_) % this->wake_interval_;
+    this->send(ESPNOW_BROADCAST_ADDR, reinterpret_cast<const uint8_t *>(&header), sizeof(header));
+  }
+}
+
+void ESPNowComponent::finish_rpc_(ESPNowPendingRPC *pending, esp_err_t error, const uint8_t *data, uint8_t size) {
+  // Free the slot before running the callbacks so they can issue new calls
+  rpc_response_callback_t on_response = std::move(pending->on_response);
+  rpc_failure_callback_t on_failure = std::move(pending->on_failure);
+  *pending = ESPNowPendingRPC{};
+
+  if (error == ESP_OK) {
+    if (on_response != nullptr)
+      on_response(data, size);
+  } else if (on_failure != nullptr) {
+    on_failure(error);
+  }
+}
+
+void ESPNowComponent::check_rpc_timeouts_() {
+  const uint32_t now = millis();
+  for (auto &slot : this->pending_rpcs_) {
+    if (slot.in_use && static_cast<int32_t>(now - slot.deadline) >= 0) {
+      this->finish_rpc_(&slot, ESP_ERR_TIMEOUT, nullptr, 0);
+    }
+  }
+}
+
+#ifdef USE_ESPNOW_CAPTURE
+void ESPNowComponent::dump_capture(bool clear) {
+  if (this->capture_dumping_) {
+    ESP_LOGW(TAG, "Capture dump already in progress");
+    return;
+  }
+  this->capture_dump_next_ = 0;
+  this->capture_dump_count_ = this->capture_.size();
+  this->capture_dump_clear_ = clear;
+  this->capture_dumping_ = true;
+  this->capture_.set_paused(true);
+  ESP_LOGI(TAG, "ESPNOWCAP-BEGIN snap=%u records=%u overwritten=%" PRIu32, ESPNOW_CAPTURE_SNAP_LENGTH,
+           (unsigned) this->capture_dump_count_, this->capture_.get_overwritten());
+}
+
+void ESPNowComponent::dump_capture_step_() {
+  static constexpr size_t HEADER_SIZE = offsetof(ESPNowCaptureRecord, data);
+  char hex_buf[(HEADER_SIZE + ESPNOW_CAPTURE_SNAP_LENGTH) * 2 + 1];
+
+  // A few records per iteration, a full buffer would otherwise hold the loop for the whole dump
+  const size_t end = std::min(this->capture_dump_next_ + ESPNOW_CAPTURE_DUMP_PER_LOOP, this->capture_dump_count_);
+  for (size_t i = this->capture_dump_next_; i < end; i++) {
+    const ESPNowCaptureRecord &rec = this->capture_.at(i);
+    const uint8_t *raw = reinterpret_cast<const uint8_t *>(&rec);
+    size_t captured = rec.size < ESPNOW_CAPTURE_SNAP_LENGTH ? rec.size : ESPNOW_CAPTURE_SNAP_LENGTH;
+    size_t len = HEADER_SIZE + captured;
+    for (size_t j = 0; j < len; j++) {
+      hex_buf[j * 2] = format_hex_char(raw[j] >> 4);
+      hex_buf[j * 2 + 1] = format_hex_char(raw[j] & 0x0F);
+    }
+    hex_buf[len * 2] = '\0';
+    ESP_LOGI(TAG, "ESPNOWCAP:%s", hex_buf);
+  }
+  this->capture_dump_next_ = end;
+  if (end < this->capture_dump_count_)
+    return;
+
+  ESP_LOGI(TAG, "ESPNOWCAP-END");
+  if (this->capture_dump_clear_)
+    this->capture_.clear();
+  this->capture_.set_paused(false);
+  this->capture_dumping_ = false;
+}
+#endif
+
 esp_err_t ESPNowComponent::add_peer(const uint8_t *peer) {
   if (this->state_ != ESPNOW_STATE_ENABLED || this->is_failed()) {
     return ESP_ERR_ESPNOW_NOT_INIT;
@@ -477,6 +1334,23 @@ esp_err_t ESPNowComponent::del_peer(const uint8_t *peer) {
       break;
     }
   }
+#ifdef USE_ESPNOW_WORKER_TASK
+  // The worker task owns the send lanes, it drops the queue in order with the send requests before this call
+  ESPNowSendPacket *request = this->send_packet_pool_.allocate();
+  if (request == nullptr) {
+    // Without a request the queued packets still fail one by one, esp_now_send() no longer knows the peer
+    return ESP_OK;
+  }
+  memcpy(request->address_, peer, ESP_NOW_ETH_ALEN);
+  request->size_ = 0;
+  request->callback_ = nullptr;
+  request->next_ = nullptr;
+  request->drop_lane_ = true;
+  this->send_request_queue_.push(request);
+  xTaskNotifyGive(this->worker_task_handle_);
+#else
+  this->fail_packets_(this->send_lanes_.drop(peer), ESP_ERR_ESPNOW_NOT_FOUND);
+#endif
   return ESP_OK;
 }
 
@@ -6,18 +6,30 @@
 #ifdef USE_ESP32
 
 #include "esphome/core/event_pool.h"
+#include "esphome/core/helpers.h"
 #include "esphome/core/lock_free_queue.h"
+#include "espnow_capture.h"
+#include "espnow_frame.h"
 #include "espnow_packet.h"
+#include "espnow_send_lanes.h"
 
 #include <esp_idf_version.h>
 
 #include <esp_mac.h>
 #include <esp_now.h>
 
+#ifdef USE_ESPNOW_WORKER_TASK
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
 #include <array>
+#include <atomic>
+#include <cmath>
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace esphome::espnow {
@@ -25,9 +37,50 @@ namespace esphome::espnow {
 // Maximum size of the ESPNow event queue - must be power of 2 for lock-free queue
 static constexpr size_t MAX_ESP_NOW_SEND_QUEUE_SIZE = 16;
 static constexpr size_t MAX_ESP_NOW_RECEIVE_QUEUE_SIZE = 16;
+static constexpr size_t MAX_ESP_NOW_SEND_REPORT_QUEUE_SIZE = 8;
+// Maximum number of RPC calls waiting for a response
+static constexpr size_t MAX_ESP_NOW_PENDING_RPC = 8;
+// Number of peers whose link quality is tracked
+static constexpr size_t MAX_ESP_NOW_LINKS = 8;
+// Number of peers whose liveness is monitored
+static constexpr size_t MAX_ESP_NOW_MONITORED_PEERS = 8;
 
 using peer_address_t = std::array<uint8_t, ESP_NOW_ETH_ALEN>;
 
+// Number of YAML triggers (on_receive, on_broadcast, ...), counted by the code generator
+#ifndef ESPNOW_TRIGGER_COUNT
+#define ESPNOW_TRIGGER_COUNT 0
+#endif
+
+using ESPNowHandlerTrigger = Trigger<const ESPNowRecvInfo &, const uint8_t *, uint8_t>;
+
+enum ESPNowTriggerKind : uint8_t {
+  ESPNOW_TRIGGER_RECEIVE = 0,
+  ESPNOW_TRIGGER_BROADCAST,
+  ESPNOW_TRIGGER_UNKNOWN_PEER,
+  ESPNOW_TRIGGER_GROUP,
+};
+
+/// One row of the trigger table generated from YAML. The filters are build time constants, so dispatch is
+/// a plain scan over a fixed array without virtual calls or heap allocated handler lists.
+struct ESPNowTriggerEntry {
+  ESPNowHandlerTrigger *trigger{nullptr};
+  ESPNowTriggerKind kind{ESPNOW_TRIGGER_RECEIVE};
+  bool has_filter{false};
+  uint8_t group{0};                      // Group filter for ESPNOW_TRIGGER_GROUP
+  uint8_t address[ESP_NOW_ETH_ALEN]{0};  // Source address filter for the other kinds
+
+  bool matches(ESPNowTriggerKind packet_kind, const uint8_t *src_addr, uint8_t packet_group) const {
+    if (this->kind != packet_kind)
+      return false;
+    if (!this->has_filter)
+      return true;
+    if (this->kind == ESPNOW_TRIGGER_GROUP)
+      return this->group == packet_group;
+    return memcmp(this->address, src_addr, ESP_NOW_ETH_ALEN) == 0;
+  }
+};
+
 enum class ESPNowTriggers : uint8_t {
   TRIGGER_NONE = 0,
   ON_NEW_PEER = 1,
@@ -46,6 +99,117 @@ enum ESPNowState : uint8_t {
   ESPNOW_STATE_ENABLED,
 };
 
+enum ESPNowQuarantineMode : uint8_t {
+  /** Sends to a quarantined peer fail immediately and queued packets are dropped. */
+  ESPNOW_QUARANTINE_SHED = 0,
+  /** Sends to a quarantined peer stay queued until the quarantine expires. */
+  ESPNOW_QUARANTINE_DEFER,
+};
+
+static_assert(ESPNOW_LANE_ADDR_LEN == ESP_NOW_ETH_ALEN, "Send lanes keep ESP-NOW peer addresses");
+using ESPNowPacketLanes = ESPNowSendLanes<ESPNowSendPacket>;
+
+/// Link quality towards one peer, updated incrementally on every send report and received frame.
+/// All averages are exponentially weighted, so the estimate follows the link without keeping history.
+struct ESPNowLinkQuality {
+  // Weight of a new delivery sample; 1/8 settles within roughly 20 sends
+  static constexpr float DELIVERY_ALPHA = 0.125f;
+  // Weights of the fast and slow RSSI averages, their difference is the trend
+  static constexpr float RSSI_FAST_ALPHA = 0.25f;
+  static constexpr float RSSI_SLOW_ALPHA = 0.03125f;
+
+  uint8_t address[ESP_NOW_ETH_ALEN]{0};
+  float delivery_ratio{NAN};  // Share of acknowledged unicast sends
+  float rssi{NAN};            // Fast average of the RSSI of received frames, dBm
+  float rssi_slow{NAN};       // Slow average of the same samples
+  uint32_t sent{0};
+  uint32_t failed{0};
+  uint32_t last_update{0};  // millis() of the last sample
+  bool in_use{false};
+
+  void add_delivery(bool success) {
+    const float sample = success ? 1.0f : 0.0f;
+    if (std::isnan(this->delivery_ratio)) {
+      this->delivery_ratio = sample;
+    } else {
+      this->delivery_ratio += DELIVERY_ALPHA * (sample - this->delivery_ratio);
+    }
+    this->sent++;
+    if (!success)
+      this->failed++;
+  }
+  void add_rssi(int8_t value) {
+    if (std::isnan(this->rssi)) {
+      this->rssi = this->rssi_slow = value;
+      return;
+    }
+    this->rssi += RSSI_FAST_ALPHA * (value - this->rssi);
+    this->rssi_slow += RSSI_SLOW_ALPHA * (value - this->rssi_slow);
+  }
+
+  /// Expected transmissions per delivered frame (1 on a perfect link), NAN before the first send
+  float get_etx() const {
+    if (std::isnan(this->delivery_ratio))
+      return NAN;
+    return this->delivery_ratio < 0.01f ? 100.0f : 1.0f / this->delivery_ratio;
+  }
+  /// RSSI trend in dB, negative while the link is getting weaker
+  float get_rssi_trend() const { return this->rssi - this->rssi_slow; }
+};
+
+enum ESPNowPeerState : uint8_t {
+  /** Nothing heard from the peer since it started being monitored. */
+  ESPNOW_PEER_UNKNOWN = 0,
+  /** A frame or an acknowledgement arrived recently. */
+  ESPNOW_PEER_ALIVE,
+  /** Several sends in a row went unacknowledged; sends fail fast with ESP_ERR_ESPNOW_PEER_DOWN. */
+  ESPNOW_PEER_DOWN,
+};
+
+/// Liveness of a monitored peer. Every received frame and every acknowledged send is proof of life, so
+/// heartbeats are only sent while there is no other traffic, at an interval that grows while the peer stays up.
+struct ESPNowPeerLiveness {
+  uint8_t address[ESP_NOW_ETH_ALEN]{0};
+  uint32_t last_seen{0};   // millis() of the last proof of life
+  uint32_t last_probe{0};  // millis() of the last heartbeat
+  uint32_t interval{0};    // Current heartbeat interval
+  uint8_t misses{0};       // Consecutive unacknowledged sends
+  ESPNowPeerState state{ESPNOW_PEER_UNKNOWN};
+  bool probe_in_flight{false};
+  bool in_use{false};
+};
+
+/// Time spent in ESPNowComponent::loop(), summed over a reporting window
+struct ESPNowLoopStats {
+  uint32_t total_us{0};
+  uint32_t max_us{0};  // Longest single iteration
+  uint32_t loops{0};
+  uint32_t packets{0};   // Received packets dispatched to handlers and triggers
+  uint32_t deferred{0};  // Iterations that left packets queued because the budget ran out
+};
+
+/// Called with the response payload of a successful RPC call
+using rpc_response_callback_t = std::function<void(const uint8_t *data, uint8_t size)>;
+/// Called when an RPC call fails: ESP_ERR_TIMEOUT if no response arrived in time,
+/// ESP_ERR_NOT_SUPPORTED if the peer has no handler for the method, or the send error
+using rpc_failure_callback_t = std::function<void(esp_err_t error)>;
+/// Handles an RPC request, writes the response into `response` (up to ESPNOW_RPC_MAX_PAYLOAD bytes)
+/// and returns its size
+using rpc_handler_t =
+    std::function<size_t(const ESPNowRecvInfo &info, const uint8_t *request, uint8_t size, uint8_t *response)>;
+
+static constexpr size_t ESPNOW_RPC_MAX_PAYLOAD = ESP_NOW_MAX_DATA_LEN - sizeof(ESPNowRPCHeader);
+static constexpr size_t ESPNOW_GROUP_MAX_PAYLOAD = ESP_NOW_MAX_DATA_LEN - sizeof(ESPNowGroupHeader);
+
+struct ESPNowPendingRPC {
+  uint8_t address[ESP_NOW_ETH_ALEN]{0};
+  uint16_t correlation_id{0};
+  uint32_t deadline{0};  // millis() after which the call times out
+  bool in_use{false};
+  rpc_response_callback_t on_response{nullptr};
+  rpc_failure_callback_t on_failure{nullptr};
+};
+
 struct ESPNowPeer {
   uint8_t address[ESP_NOW_ETH_ALEN];  // MAC address of the peer
 
@@ -76,6 +240,30 @@ class ESPNowReceivedPacketHandler {
   /// @return true if the packet was handled, false otherwise
   virtual bool on_received(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) = 0;
 };
+/// Handler interface for receiving ESPNow packets sent to a group this node is a member of
+/// Components should inherit from this class to handle incoming ESPNow data
+class ESPNowGroupHandler {
+ public:
+  /// Called when a packet for one of the joined groups is received
+  /// @param info Information about the received packet (sender MAC, etc.)
+  /// @param group Group id the packet was sent to
+  /// @param data Pointer to the received data payload, without the group header
+  /// @param size Size of the received data in bytes
+  /// @return true if the packet was handled, false otherwise
+  virtual bool on_group(const ESPNowRecvInfo &info, uint8_t group, const uint8_t *data, uint8_t size) = 0;
+};
+
+/// Handler interface for frames of a protocol built on top of ESPNowComponent (see espnow_frame.h)
+/// Components should inherit from this class and register for their frame type
+class ESPNowFrameHandler {
+ public:
+  /// Called when a frame of the registered type is received from a known peer
+  /// @param info Information about the received packet (sender MAC, etc.)
+  /// @param data Pointer to the whole frame, including the ESPNowFrameHeader
+  /// @param size Size of the frame in bytes
+  virtual void on_frame(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) = 0;
+};
+
 /// Handler interface for receiving broadcasted ESPNow packets
 /// Components should inherit from this class to handle incoming ESPNow data
 class ESPNowBroadcastedHandler {
@@ -114,6 +302,67 @@ class ESPNowComponent : public Component {
 
   void set_auto_add_peer(bool value) { this->auto_add_peer_ = value; }
 
+  void set_quarantine_threshold(uint8_t failures) { this->quarantine_threshold_ = failures; }
+  void set_quarantine_duration(uint32_t duration_ms) { this->quarantine_duration_ = duration_ms; }
+  void set_quarantine_mode(ESPNowQuarantineMode mode) { this->quarantine_mode_ = mode; }
+#ifndef USE_ESPNOW_WORKER_TASK
+  /// Whether sends to this peer are currently held back after repeated delivery failures. Not available with
+  /// the worker task, which owns the send lanes.
+  bool is_peer_quarantined(const uint8_t *peer);
+#endif
+
+  /// Duty cycle the radio while Wi-Fi is not connected. The wake window is widened to `max_window` ms on
+  /// traffic and halved after every `idle_timeout` ms without traffic, down to `min_window` ms.
+  void set_power_save(uint16_t interval, uint16_t min_window, uint16_t max_window, uint32_t idle_timeout) {
+    this->power_save_ = true;
+    this->wake_interval_ = interval;
+    this->min_wake_window_ = min_window;
+    this->max_wake_window_ = max_window;
+    this->wake_idle_timeout_ = idle_timeout;
+  }
+  /// Broadcast the wake schedule whenever it changes, so senders can time their transmissions
+  void set_announce_schedule(bool announce) { this->announce_schedule_ = announce; }
+  uint16_t get_wake_window() const { return this->wake_window_; }
+
+  /// Link quality estimate for a peer, nullptr if nothing was sent to or received from it yet
+  const ESPNowLinkQuality *get_link_quality(const uint8_t *peer) const;
+
+  /// Limit the received packets dispatched per loop() iteration, by count and by time (0 = no limit).
+  /// The rest is handled in the following iterations, which then run without the usual loop delay.
+  void set_loop_budget(uint16_t max_packets, uint32_t max_time_us) {
+    this->loop_budget_packets_ = max_packets;
+    this->loop_budget_us_ = max_time_us;
+  }
+#ifdef USE_ESPNOW_WORKER_TASK
+  /// Run the transmit path (send lanes, retries, quarantine, send reports) in its own FreeRTOS task.
+  /// Handlers and callbacks still run on the main loop.
+  void set_worker_task(uint8_t core, uint8_t priority, uint32_t stack_size) {
+    this->worker_core_ = core;
+    this->worker_priority_ = priority;
+    this->worker_stack_size_ = stack_size;
+  }
+#endif
+  /// Statistics of the last complete reporting window
+  const ESPNowLoopStats &get_loop_stats() const { return this->last_loop_stats_; }
+
+  /// Heartbeats to idle monitored peers start at `min_interval` ms and double up to `max_interval` ms while
+  /// the peer answers. A peer is down after `miss_threshold` unacknowledged sends in a row.
+  void set_liveness(uint32_t min_interval, uint32_t max_interval, uint8_t miss_threshold) {
+    this->heartbeat_min_interval_ = min_interval;
+    this->heartbeat_max_interval_ = max_interval;
+    this->liveness_miss_threshold_ = miss_threshold;
+  }
+  /// Start tracking the liveness of a peer and probing it while idle
+  void monitor_peer(const uint8_t *peer);
+  void monitor_peer(peer_address_t address) { this->monitor_peer(address.data()); }
+  /// ESPNOW_PEER_UNKNOWN for peers that are not monitored
+  ESPNowPeerState get_peer_state(const uint8_t *peer) const;
+  bool is_peer_down(const uint8_t *peer) const { return this->get_peer_state(peer) == ESPNOW_PEER_DOWN; }
+  /// Called with the peer address and `true` when a monitored peer comes up, `false` when it goes down
+  void add_on_liveness_callback(std::function<void(const uint8_t *, bool)> &&callback) {
+    this->liveness_callback_.add(std::move(callback));
+  }
+
   void enable();
   void disable();
   bool is_disabled() const { return this->state_ == ESPNOW_STATE_DISABLED; };
@@ -121,10 +370,12 @@ class ESPNowComponent : public Component {
   bool is_wifi_enabled();
 
   /// @brief Queue a packet to be sent to a specific peer address.
-  /// This method will add the packet to the internal queue and
+  /// This method will add the packet to the queue of that peer and
   /// call the callback when the packet is sent.
   /// Only one packet will be sent at any given time and the next one will not be sent until
-  /// the previous one has been acknowledged or failed.
+  /// the previous one has been acknowledged or failed. Peers with queued packets are served
+  /// round-robin, and peers that keep failing are quarantined for a while.
+  /// Must be called from the main loop.
   /// @param peer_address MAC address of the peer to send the packet to
   /// @param payload Data payload to send
   /// @param callback Callback to call when the send operation is complete
@@ -134,7 +385,63 @@ class ESPNowComponent : public Component {
     return this->send(peer_address, payload.data(), payload.size(), callback);
   }
   esp_err_t send(const uint8_t *peer_address, const uint8_t *payload, size_t size,
-                 const send_callback_t &callback = nullptr);
+                 const send_callback_t &callback = nullptr) {
+    return this->send(peer_address, payload, size, callback, ESPNowSendOptions{});
+  }
+  /// @brief Queue a packet with supersession and expiry settings, see ESPNowSendOptions.
+  /// Use a supersede key for state commands where only the latest value matters.
+  esp_err_t send(const uint8_t *peer_address, const uint8_t *payload, size_t size, const send_callback_t &callback,
+                 const ESPNowSendOptions &options);
+
+  /// @brief Call a method on a peer and wait for its response without blocking.
+  /// The request is sent as unicast with a fresh correlation id. Exactly one of the callbacks is run:
+  /// `on_response` when the matching response arrives, `on_failure` on timeout or send failure.
+  /// @return ESP_OK if the request was queued, otherwise an error and no callback will be run
+  esp_err_t call(const uint8_t *peer_address, uint8_t method, const uint8_t *payload, size_t size,
+                 const rpc_response_callback_t &on_response, const rpc_failure_callback_t &on_failure,
+                 uint32_t timeout_ms = 1000);
+  /// @brief Queue a packet for all members of a group.
+  /// The packet is sent once to ESPNOW_MULTICAST_ADDR with a small group header; nodes that are not a
+  /// member of `group` drop it in the receive callback. At most ESPNOW_GROUP_MAX_PAYLOAD bytes.
+  esp_err_t send_group(uint8_t group, const uint8_t *payload, size_t size, const send_callback_t &callback = nullptr,
+                       const ESPNowSendOptions &options = ESPNowSendOptions{});
+  void join_group(uint8_t group) { this->groups_[group / 32] |= (1UL << (group % 32)); }
+  void leave_group(uint8_t group) { this->groups_[group / 32] &= ~(1UL << (group % 32)); }
+  bool is_group_member(uint8_t group) const { return (this->groups_[group / 32] & (1UL << (group % 32))) != 0; }
+
+  /// Register the handler answering RPC calls for `method`. The response is sent back as unicast.
+  void register_rpc_method(uint8_t method, rpc_handler_t handler) {
+    this->rpc_methods_.emplace_back(method, std::move(handler));
+  }
+
+#ifdef USE_ESPNOW_CAPTURE
+  ESPNowCapture &get_capture() { return this->capture_; }
+  /// Log the capture buffer as hex records that tools/espnow_capture_to_pcap.py converts to pcap.
+  /// The records are logged over several loop() iterations; recording pauses until the dump is complete.
+  void dump_capture(bool clear = false);
+#endif
+
+  /// Add a YAML trigger to the trigger table, optionally filtered by source address or group.
+  /// Only called from generated code; components use the register_*_handler() methods below.
+  void add_trigger(ESPNowTriggerKind kind, ESPNowHandlerTrigger *trigger) {
+    ESPNowTriggerEntry &entry = this->triggers_[this->num_triggers_++];
+    entry.trigger = trigger;
+    entry.kind = kind;
+  }
+  void add_trigger(ESPNowTriggerKind kind, ESPNowHandlerTrigger *trigger, peer_address_t address) {
+    ESPNowTriggerEntry &entry = this->triggers_[this->num_triggers_++];
+    entry.trigger = trigger;
+    entry.kind = kind;
+    entry.has_filter = true;
+    memcpy(entry.address, address.data(), ESP_NOW_ETH_ALEN);
+  }
+  void add_trigger(ESPNowTriggerKind kind, ESPNowHandlerTrigger *trigger, uint8_t group) {
+    ESPNowTriggerEntry &entry = this->triggers_[this->num_triggers_++];
+    entry.trigger = trigger;
+    entry.kind = kind;
+    entry.has_filter = true;
+    entry.group = group;
+  }
 
   void register_received_handler(ESPNowReceivedPacketHandler *handler) { this->received_handlers_.push_back(handler); }
   void register_unknown_peer_handler(ESPNowUnknownPeerHandler *handler) {
@@ -143,6 +450,10 @@ class ESPNowComponent : public Component {
   void register_broadcasted_handler(ESPNowBroadcastedHandler *handler) {
     this->broadcasted_handlers_.push_back(handler);
   }
+  void register_group_handler(ESPNowGroupHandler *handler) { this->group_handlers_.push_back(handler); }
+  void register_frame_handler(ESPNowFrameType type, ESPNowFrameHandler *handler) {
+    this->frame_handlers_.emplace_back(type, handler);
+  }
 
  protected:
   friend void on_data_received(const esp_now_recv_info_t *info, const uint8_t *data, int size);
@@ -154,20 +465,134 @@ class ESPNowComponent : public Component {
 
   void enable_();
   void send_();
-
+  void process_send_reports_();
+  void process_send_report_(ESPNowSendReport *report);
+  /// Put a loaded packet on the queue of its peer. Runs on the worker task when there is one.
+  esp_err_t queue_packet_(ESPNowSendPacket *packet);
+  /// Hand a packet that left the send path back with its result and free it
+  void complete_packet_(ESPNowSendPacket *packet, esp_err_t status, bool transmitted = false);
+  /// Link quality and liveness bookkeeping for a unicast send report
+  void note_delivery_(const uint8_t *peer, bool success);
+  void momentary_warning_(const char *name);
+#ifdef USE_ESPNOW_WORKER_TASK
+  static void worker_task_(void *param);
+#endif
+  void process_received_packet_(ESPNowPacket *packet);
+  void record_loop_time_(uint32_t elapsed_us, uint16_t packets, bool backlog);
+  /// Complete a list of packets chained through next_, as taken off a send lane
+  void fail_packets_(ESPNowSendPacket *packets, esp_err_t err);
+  /// Complete a packet from loop() instead of right away, for completions triggered inside send()
+  void defer_completion_(ESPNowSendPacket *packet, esp_err_t status);
+  /// Handle frames of the component's own protocols, returns true if the frame was consumed
+  bool handle_frame_(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size);
+  void handle_rpc_request_(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size);
+  void handle_rpc_response_(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size);
+  void finish_rpc_(ESPNowPendingRPC *pending, esp_err_t error, const uint8_t *data, uint8_t size);
+  void check_rpc_timeouts_();
+  void handle_group_frame_(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size);
+  void fire_triggers_(ESPNowTriggerKind kind, const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size,
+                      uint8_t group = 0);
+  void handle_schedule_frame_(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size);
+  /// Link entry for a peer, replacing the least recently updated one if the table is full
+  ESPNowLinkQuality *acquire_link_(const uint8_t *peer);
+  ESPNowPeerLiveness *find_liveness_(const uint8_t *peer);
+  /// Proof of life: a frame from the peer or an acknowledged send to it
+  void note_peer_alive_(const uint8_t *peer);
+  void note_peer_missed_(const uint8_t *peer);
+  void set_peer_state_(ESPNowPeerLiveness *entry, ESPNowPeerState state);
+  /// Send heartbeats to monitored peers without recent traffic
+  void check_liveness_();
+  /// Traffic keeps the wake window wide; shrink it again once idle
+  void note_activity_();
+  void update_wake_window_();
+  void apply_wake_window_(uint16_t window);
+  /// Called from the receive callback: whether a multicast frame is for one of our groups
+  bool accepts_multicast_(const uint8_t *data, int size) const;
+
+  std::array<ESPNowTriggerEntry, ESPNOW_TRIGGER_COUNT> triggers_{};
+  size_t num_triggers_{0};
+  // Handlers registered at runtime by other components
   std::vector<ESPNowUnknownPeerHandler *> unknown_peer_handlers_;
   std::vector<ESPNowReceivedPacketHandler *> received_handlers_;
   std::vector<ESPNowBroadcastedHandler *> broadcasted_handlers_;
+  std::vector<ESPNowGroupHandler *> group_handlers_;
+  std::vector<std::pair<uint8_t, ESPNowFrameHandler *>> frame_handlers_;
 
   std::vector<ESPNowPeer> peers_{};
 
+  std::vector<std::pair<uint8_t, rpc_handler_t>> rpc_methods_{};
+  std::array<ESPNowPendingRPC, MAX_ESP_NOW_PENDING_RPC> pending_rpcs_{};
+  uint16_t next_correlation_id_{0};
+
+  uint32_t groups_[8]{0};  // Bit set of joined group ids
+
+  ESPNowPeerSchedules peer_schedules_{};
+  std::array<ESPNowLinkQuality, MAX_ESP_NOW_LINKS> links_{};
+  std::array<ESPNowPeerLiveness, MAX_ESP_NOW_MONITORED_PEERS> liveness_{};
+  CallbackManager<void(const uint8_t *, bool)> liveness_callback_{};
+  uint32_t heartbeat_min_interval_{5000};
+  uint32_t heartbeat_max_interval_{60000};
+  uint8_t liveness_miss_threshold_{3};
+  uint16_t wake_interval_{100};
+  uint16_t min_wake_window_{50};
+  uint16_t max_wake_window_{50};
+  uint16_t wake_window_{0};  // Currently applied window, 0 before enable
+  uint32_t wake_idle_timeout_{2000};
+  uint32_t wake_epoch_{0};  // millis() when the wake interval was applied, wake windows start every interval from it
+  uint32_t last_activity_{0};
+  bool power_save_{false};
+  bool announce_schedule_{false};
+
   uint8_t own_address_[ESP_NOW_ETH_ALEN]{0};
   LockFreeQueue<ESPNowPacket, MAX_ESP_NOW_RECEIVE_QUEUE_SIZE> receive_packet_queue_{};
   EventPool<ESPNowPacket, MAX_ESP_NOW_RECEIVE_QUEUE_SIZE> receive_packet_pool_{};
 
-  LockFreeQueue<ESPNowSendPacket, MAX_ESP_NOW_SEND_QUEUE_SIZE> send_packet_queue_{};
+  LockFreeQueue<ESPNowSendReport, MAX_ESP_NOW_SEND_REPORT_QUEUE_SIZE> send_report_queue_{};
+  EventPool<ESPNowSendReport, MAX_ESP_NOW_SEND_REPORT_QUEUE_SIZE> send_report_pool_{};
+
   EventPool<ESPNowSendPacket, MAX_ESP_NOW_SEND_QUEUE_SIZE> send_packet_pool_{};
-  ESPNowSendPacket *current_send_packet_{nullptr};  // Currently sending packet, nullptr if none
+  // Owned by the transmit path: the main loop, or the worker task when there is one
+  ESPNowPacketLanes send_lanes_{};
+  std::atomic<uint16_t> send_dropped_{0};
+
+#ifdef USE_ESPNOW_WORKER_TASK
+  // Single producer, single consumer in each direction: main loop -> worker and worker -> main loop
+  LockFreeQueue<ESPNowSendPacket, MAX_ESP_NOW_SEND_QUEUE_SIZE> send_request_queue_{};
+  LockFreeQueue<ESPNowSendPacket, MAX_ESP_NOW_SEND_QUEUE_SIZE> send_done_queue_{};
+  TaskHandle_t worker_task_handle_{nullptr};
+  std::atomic<bool> worker_warning_{false};
+  uint32_t worker_stack_size_{4096};
+  uint8_t worker_core_{1};
+  uint8_t worker_priority_{5};
+#endif
+
+  uint16_t loop_budget_packets_{0};
+  uint32_t loop_budget_us_{0};
+  bool loop_backlog_{false};
+  HighFrequencyLoopRequester high_freq_;
+  ESPNowLoopStats loop_stats_{};
+  ESPNowLoopStats last_loop_stats_{};
+  uint32_t loop_stats_start_{0};
+
+  uint32_t quarantine_duration_{10000};
+  uint8_t quarantine_threshold_{5};
+  ESPNowQuarantineMode quarantine_mode_{ESPNOW_QUARANTINE_DEFER};
+
+#ifndef USE_ESPNOW_WORKER_TASK
+  // Completions waiting for the next loop(), linked through next_
+  ESPNowSendPacket *deferred_head_{nullptr};
+  ESPNowSendPacket *deferred_tail_{nullptr};
+#endif
+
+#ifdef USE_ESPNOW_CAPTURE
+  void dump_capture_step_();
+
+  ESPNowCapture capture_{};
+  size_t capture_dump_next_{0};
+  size_t capture_dump_count_{0};
+  bool capture_dumping_{false};
+  bool capture_dump_clear_{false};
+#endif
 
   uint8_t wifi_channel_{0};
   ESPNowState state_{ESPNOW_STATE_OFF};
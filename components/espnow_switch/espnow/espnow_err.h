@@ -13,6 +13,10 @@ static const esp_err_t ESP_ERR_ESPNOW_OWN_ADDRESS = (ESP_ERR_ESPNOW_CMP_BASE + 2
 static const esp_err_t ESP_ERR_ESPNOW_DATA_SIZE = (ESP_ERR_ESPNOW_CMP_BASE + 3);
 static const esp_err_t ESP_ERR_ESPNOW_PEER_NOT_SET = (ESP_ERR_ESPNOW_CMP_BASE + 4);
 static const esp_err_t ESP_ERR_ESPNOW_PEER_NOT_PAIRED = (ESP_ERR_ESPNOW_CMP_BASE + 5);
+static const esp_err_t ESP_ERR_ESPNOW_PEER_QUARANTINED = (ESP_ERR_ESPNOW_CMP_BASE + 6);
+static const esp_err_t ESP_ERR_ESPNOW_SUPERSEDED = (ESP_ERR_ESPNOW_CMP_BASE + 7);
+static const esp_err_t ESP_ERR_ESPNOW_EXPIRED = (ESP_ERR_ESPNOW_CMP_BASE + 8);
+static const esp_err_t ESP_ERR_ESPNOW_PEER_DOWN = (ESP_ERR_ESPNOW_CMP_BASE + 9);
 
 }  // namespace esphome::espnow
 
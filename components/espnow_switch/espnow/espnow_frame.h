@@ -0,0 +1,77 @@
+#pragma once
+
+#ifdef USE_ESP32
+
+#include <cstdint>
+#include <cstring>
+
+namespace esphome::espnow {
+
+/// Frames of the protocols implemented by ESPNowComponent itself (RPC, ...) start with this
+/// two byte magic followed by the frame type, so they can be told apart from raw application payloads.
+static constexpr uint8_t ESPNOW_FRAME_MAGIC_0 = 0xE5;
+static constexpr uint8_t ESPNOW_FRAME_MAGIC_1 = 0x4E;
+
+enum ESPNowFrameType : uint8_t {
+  ESPNOW_FRAME_RPC_REQUEST = 0x01,
+  ESPNOW_FRAME_RPC_RESPONSE = 0x02,
+  ESPNOW_FRAME_GROUP = 0x03,
+  ESPNOW_FRAME_OTA = 0x04,
+  ESPNOW_FRAME_STATE = 0x05,
+  ESPNOW_FRAME_SCHEDULE = 0x06,
+  ESPNOW_FRAME_HEARTBEAT = 0x07,
+};
+
+struct __attribute__((packed)) ESPNowFrameHeader {
+  uint8_t magic[2];
+  uint8_t type;  // ESPNowFrameType
+
+  void init(ESPNowFrameType frame_type) {
+    this->magic[0] = ESPNOW_FRAME_MAGIC_0;
+    this->magic[1] = ESPNOW_FRAME_MAGIC_1;
+    this->type = frame_type;
+  }
+};
+
+enum ESPNowRPCStatus : uint8_t {
+  ESPNOW_RPC_OK = 0,
+  ESPNOW_RPC_UNKNOWN_METHOD = 1,
+};
+
+struct __attribute__((packed)) ESPNowRPCHeader {
+  ESPNowFrameHeader frame;
+  uint16_t correlation_id;  // Chosen by the caller, echoed in the response
+  uint8_t method;           // Method id registered on the receiver
+  uint8_t status;           // ESPNowRPCStatus, only meaningful in responses
+};
+
+/// Header of a frame sent to ESPNOW_MULTICAST_ADDR, the payload follows directly
+struct __attribute__((packed)) ESPNowGroupHeader {
+  ESPNowFrameHeader frame;
+  uint8_t group;  // Group id, receivers that are not a member drop the frame
+};
+
+/// Wake schedule of a duty-cycled node, broadcast whenever it changes
+struct __attribute__((packed)) ESPNowScheduleHeader {
+  ESPNowFrameHeader frame;
+  uint16_t wake_interval;  // Milliseconds between wake ups, 0 if the radio is always on
+  uint16_t wake_window;    // Milliseconds the radio stays on after each wake up
+  uint16_t window_offset;  // Milliseconds since the sender's current wake window started
+};
+
+/// Liveness probe to an otherwise idle peer. It carries nothing beyond the frame header: the MAC layer
+/// acknowledgement proves the receiver alive to the sender, and the frame itself does the same the other way.
+struct __attribute__((packed)) ESPNowHeartbeatHeader {
+  ESPNowFrameHeader frame;
+};
+
+/// Returns the frame type if the payload carries a component frame header, 0 otherwise.
+inline uint8_t espnow_frame_type(const uint8_t *data, uint8_t size) {
+  if (size < sizeof(ESPNowFrameHeader) || data[0] != ESPNOW_FRAME_MAGIC_0 || data[1] != ESPNOW_FRAME_MAGIC_1)
+    return 0;
+  return data[2];
+}
+
+}  // namespace esphome::espnow
+
+#endif  // USE_ESP32
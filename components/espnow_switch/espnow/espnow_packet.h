@@ -33,12 +33,21 @@ struct ESPNowRecvInfo {
 
 using send_callback_t = std::function<void(esp_err_t)>;
 
+/// Optional per-send settings
+struct ESPNowSendOptions {
+  /// When non-zero, a packet still queued for the same peer with the same key is replaced by the new
+  /// payload instead of queueing behind it. Its callback receives ESP_ERR_ESPNOW_SUPERSEDED.
+  uint32_t supersede_key{0};
+  /// When non-zero, the packet is dropped with ESP_ERR_ESPNOW_EXPIRED if it could not be
+  /// transmitted within this many milliseconds.
+  uint32_t timeout_ms{0};
+};
+
 class ESPNowPacket {
  public:
   // NOLINTNEXTLINE(readability-identifier-naming)
   enum esp_now_packet_type_t : uint8_t {
     RECEIVED,
-    SENT,
   };
 
   // Constructor for received data
@@ -46,16 +55,6 @@ class ESPNowPacket {
     this->init_received_data_(info, data, size);
   };
 
-#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 5, 0)
-  // Constructor for sent data
-  ESPNowPacket(const esp_now_send_info_t *info, esp_now_send_status_t status) {
-    this->init_sent_data_(info->src_addr, status);
-  }
-#else
-  // Constructor for sent data
-  ESPNowPacket(const uint8_t *mac_addr, esp_now_send_status_t status) { this->init_sent_data_(mac_addr, status); }
-#endif
-
   // Default constructor for pre-allocation in pool
   ESPNowPacket() {}
 
@@ -66,11 +65,6 @@ class ESPNowPacket {
     this->init_received_data_(info, data, size);
   }
 
-  void load_sent_data(const uint8_t *mac_addr, esp_now_send_status_t status) {
-    this->type_ = SENT;
-    this->init_sent_data_(mac_addr, status);
-  }
-
   // Disable copy to prevent double-delete
   ESPNowPacket(const ESPNowPacket &) = delete;
   ESPNowPacket &operator=(const ESPNowPacket &) = delete;
@@ -83,12 +77,6 @@ class ESPNowPacket {
       uint8_t size;                        // Size of the received data
       WifiPacketRxControl rx_ctrl;         // Status of the received packet
     } receive;
-
-    // NOLINTNEXTLINE(readability-identifier-naming)
-    struct sent_data {
-      uint8_t address[ESP_NOW_ETH_ALEN];
-      esp_now_send_status_t status;
-    } sent;
   } packet_;
 
   esp_now_packet_type_t type_;
@@ -108,11 +96,28 @@ class ESPNowPacket {
 
     this->packet_.receive.info.rx_ctrl = reinterpret_cast<wifi_pkt_rx_ctrl_t *>(&this->packet_.receive.rx_ctrl);
   }
+};
 
-  void init_sent_data_(const uint8_t *mac_addr, esp_now_send_status_t status) {
-    memcpy(this->packet_.sent.address, mac_addr, ESP_NOW_ETH_ALEN);
-    this->packet_.sent.status = status;
+/// Completion event for a transmitted frame. Kept separate from ESPNowPacket so that
+/// send reports use their own small queue and never take a full-size receive slot.
+class ESPNowSendReport {
+ public:
+  // Default constructor for pre-allocation in pool
+  ESPNowSendReport() {}
+
+  void release() {}
+
+  // Disable copy to prevent double-delete
+  ESPNowSendReport(const ESPNowSendReport &) = delete;
+  ESPNowSendReport &operator=(const ESPNowSendReport &) = delete;
+
+  void load(const uint8_t *mac_addr, esp_now_send_status_t status) {
+    memcpy(this->address_, mac_addr, ESP_NOW_ETH_ALEN);
+    this->status_ = status;
   }
+
+  uint8_t address_[ESP_NOW_ETH_ALEN]{0};                 // Destination address of the sent frame
+  esp_now_send_status_t status_{ESP_NOW_SEND_SUCCESS};  // Delivery status reported by the driver
 };
 
 class ESPNowSendPacket {
@@ -148,6 +153,12 @@ class ESPNowSendPacket {
   uint8_t data_[ESP_NOW_MAX_DATA_LEN]{0};  // Data to send
   uint8_t size_{0};                        // Size of the data to send, must be <= ESP_NOW_MAX_DATA_LEN
   send_callback_t callback_{nullptr};      // Callback to call when the send operation is complete
+  ESPNowSendPacket *next_{nullptr};        // Next packet queued for the same peer
+  uint32_t supersede_key_{0};              // Key used to replace stale queued packets, 0 if none
+  uint32_t deadline_{0};                   // millis() after which the packet is dropped, 0 if none
+  esp_err_t status_{ESP_OK};               // Result handed back to the main loop (worker task, deferred completion)
+  bool transmitted_{false};                // Whether status_ is a delivery report from the driver
+  bool drop_lane_{false};                  // Not a frame: asks the worker task to drop the peer's queue
 
  private:
   void init_data_(const uint8_t *peer_address, const uint8_t *payload, size_t size) {
@@ -0,0 +1,342 @@
+#pragma once
+
+// Per-peer send queues and the predicted wake windows of duty-cycled peers. Kept free of ESPHome and ESP-IDF
+// dependencies so the transmit path can be exercised on a Linux host (see tests/espnow_send).
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
+namespace esphome::espnow {
+
+// Length of a peer MAC address, ESP_NOW_ETH_ALEN
+static constexpr size_t ESPNOW_LANE_ADDR_LEN = 6;
+// Number of peers that can have packets queued at the same time
+static constexpr size_t MAX_ESP_NOW_SEND_LANES = 8;
+// Maximum number of packets queued for a single peer, so one peer cannot hold the whole send pool
+static constexpr uint8_t MAX_ESP_NOW_SEND_LANE_DEPTH = 4;
+// Number of duty-cycled peers whose wake schedule is remembered
+static constexpr size_t MAX_ESP_NOW_PEER_SCHEDULES = 8;
+
+/// Transmit queue of a single peer. Packets are chained through their next_ member.
+template<typename Packet> struct ESPNowSendLane {
+  uint8_t address[ESPNOW_LANE_ADDR_LEN]{0};
+  Packet *head{nullptr};
+  Packet *tail{nullptr};
+  uint8_t length{0};
+  uint8_t consecutive_failures{0};
+  uint32_t quarantine_until{0};  // millis() when the quarantine ends, 0 if not quarantined
+  bool in_use{false};
+
+  bool is_quarantined(uint32_t now) const {
+    return this->quarantine_until != 0 && static_cast<int32_t>(this->quarantine_until - now) > 0;
+  }
+};
+
+/// The send lanes of all peers, served round-robin with one packet in flight at a time. Only the transmit path
+/// touches them: the main loop, or the worker task when there is one. Packets need address_, next_,
+/// supersede_key_ and deadline_ members.
+template<typename Packet> class ESPNowSendLanes {
+ public:
+  using Lane = ESPNowSendLane<Packet>;
+
+  enum Queued : uint8_t {
+    QUEUED,             // Appended to the peer's queue
+    QUEUED_SUPERSEDED,  // Took the place of a queued packet with the same supersede key, which is displaced
+    QUEUED_EVICTED,     // Appended after the peer's oldest packet was displaced to make room
+    NO_LANE,            // Every lane holds packets for other peers
+    QUARANTINED,        // The peer is quarantined and quarantined peers shed their packets
+  };
+
+  enum Outcome : uint8_t {
+    OUTCOME_DELIVERED,
+    OUTCOME_RECOVERED,  // Delivered, and the peer left its quarantine
+    OUTCOME_FAILED,
+    OUTCOME_QUARANTINED,  // Failed, and the peer entered quarantine
+  };
+
+  Lane *find(const uint8_t *peer) {
+    for (auto &lane : this->lanes_) {
+      if (lane.in_use && memcmp(lane.address, peer, ESPNOW_LANE_ADDR_LEN) == 0)
+        return &lane;
+    }
+    return nullptr;
+  }
+
+  /// Lane of a peer, taking over a free or idle one if the peer has none
+  Lane *acquire(const uint8_t *peer, uint32_t now) {
+    Lane *lane = this->find(peer);
+    if (lane != nullptr)
+      return lane;
+
+    // Prefer an unused lane, then an idle one without failure history, then any idle one
+    Lane *idle = nullptr;
+    for (auto &candidate : this->lanes_) {
+      if (!candidate.in_use) {
+        lane = &candidate;
+        break;
+      }
+      if (candidate.head != nullptr || &candidate == this->current_lane_ || candidate.is_quarantined(now))
+        continue;
+      if (idle == nullptr || (candidate.consecutive_failures == 0 && idle->consecutive_failures != 0))
+        idle = &candidate;
+    }
+    if (lane == nullptr)
+      lane = idle;
+    if (lane == nullptr)
+      return nullptr;
+
+    *lane = Lane{};
+    memcpy(lane->address, peer, ESPNOW_LANE_ADDR_LEN);
+    lane->in_use = true;
+    return lane;
+  }
+
+  /// Queue a packet for its peer. A packet pushed out of the queue to make place is returned through
+  /// `displaced`; the caller completes it.
+  Queued enqueue(Packet *packet, uint32_t now, bool shed_quarantined, Packet **displaced) {
+    *displaced = nullptr;
+    Lane *lane = this->acquire(packet->address_, now);
+    if (lane == nullptr)
+      return NO_LANE;
+    if (shed_quarantined && lane->is_quarantined(now))
+      return QUARANTINED;
+    if (packet->supersede_key_ != 0) {
+      // Latest value wins: the new packet takes the place of the stale one, keeping its position in the queue
+      Packet **link = &lane->head;
+      for (Packet *queued = lane->head; queued != nullptr; link = &queued->next_, queued = queued->next_) {
+        if (queued->supersede_key_ != packet->supersede_key_)
+          continue;
+        packet->next_ = queued->next_;
+        *link = packet;
+        if (lane->tail == queued)
+          lane->tail = packet;
+        queued->next_ = nullptr;
+        *displaced = queued;
+        return QUEUED_SUPERSEDED;
+      }
+    }
+    Queued result = QUEUED;
+    if (lane->length >= MAX_ESP_NOW_SEND_LANE_DEPTH) {
+      // Drop the oldest packet of this peer rather than letting it occupy the shared pool
+      Packet *oldest = lane->head;
+      lane->head = oldest->next_;
+      if (lane->head == nullptr)
+        lane->tail = nullptr;
+      lane->length--;
+      oldest->next_ = nullptr;
+      *displaced = oldest;
+      result = QUEUED_EVICTED;
+    }
+    packet->next_ = nullptr;
+    if (lane->tail == nullptr) {
+      lane->head = packet;
+    } else {
+      lane->tail->next_ = packet;
+    }
+    lane->tail = packet;
+    lane->length++;
+    return result;
+  }
+
+  /// Take the next packet to transmit: one per peer and turn, skipping quarantined peers and peers `is_awake`
+  /// predicts asleep. Packets past their deadline go to `expire` instead of being sent. The returned packet is in
+  /// flight until finish().
+  template<typename Awake, typename Expire> Packet *next(uint32_t now, Awake &&is_awake, Expire &&expire) {
+    for (size_t i = 0; i < MAX_ESP_NOW_SEND_LANES; i++) {
+      size_t index = (this->next_lane_ + i) % MAX_ESP_NOW_SEND_LANES;
+      Lane &candidate = this->lanes_[index];
+      if (!candidate.in_use || candidate.is_quarantined(now) || !is_awake(candidate.address, now))
+        continue;
+      while (candidate.head != nullptr) {
+        Packet *head = candidate.head;
+        candidate.head = head->next_;
+        if (candidate.head == nullptr)
+          candidate.tail = nullptr;
+        candidate.length--;
+        head->next_ = nullptr;
+        if (head->deadline_ != 0 && static_cast<int32_t>(now - head->deadline_) >= 0) {
+          // Too late to be useful, drop it without spending airtime
+          expire(head);
+          continue;
+        }
+        this->current_packet_ = head;
+        this->current_lane_ = &candidate;
+        this->next_lane_ = (index + 1) % MAX_ESP_NOW_SEND_LANES;
+        return head;
+      }
+    }
+    return nullptr;
+  }
+
+  /// Packet in flight, nullptr if none
+  Packet *current() const { return this->current_packet_; }
+
+  /// End the transmission in flight; returns its packet and, through `lane`, its lane
+  Packet *finish(Lane **lane = nullptr) {
+    Packet *packet = this->current_packet_;
+    if (lane != nullptr)
+      *lane = this->current_lane_;
+    this->current_packet_ = nullptr;
+    this->current_lane_ = nullptr;
+    return packet;
+  }
+
+  /// Account a delivery report. Failures only count for unicast, broadcast and multicast are never acknowledged.
+  Outcome report(Lane *lane, bool success, bool unicast, uint32_t now, uint8_t threshold, uint32_t duration) {
+    if (success) {
+      const bool recovered = lane->quarantine_until != 0;
+      lane->consecutive_failures = 0;
+      lane->quarantine_until = 0;
+      return recovered ? OUTCOME_RECOVERED : OUTCOME_DELIVERED;
+    }
+    if (!unicast)
+      return OUTCOME_FAILED;
+    if (lane->consecutive_failures < UINT8_MAX)
+      lane->consecutive_failures++;
+    if (threshold == 0 || lane->consecutive_failures < threshold)
+      return OUTCOME_FAILED;
+    lane->quarantine_until = now + duration;
+    if (lane->quarantine_until == 0)
+      lane->quarantine_until = 1;  // 0 means not quarantined
+    return OUTCOME_QUARANTINED;
+  }
+
+  /// Detach the queue of a lane, returned as a list chained through next_
+  Packet *take(Lane *lane) {
+    Packet *packets = lane->head;
+    lane->head = nullptr;
+    lane->tail = nullptr;
+    lane->length = 0;
+    return packets;
+  }
+
+  /// Detach the queue of a peer and free its lane, which stays until the report if a packet of it is in flight
+  Packet *drop(const uint8_t *peer) {
+    Lane *lane = this->find(peer);
+    if (lane == nullptr)
+      return nullptr;
+    Packet *packets = this->take(lane);
+    if (lane != this->current_lane_)
+      lane->in_use = false;
+    return packets;
+  }
+
+  /// Whether the peer has packets queued or in flight
+  bool is_busy(const uint8_t *peer) {
+    Lane *lane = this->find(peer);
+    return lane != nullptr && (lane->head != nullptr || lane == this->current_lane_);
+  }
+
+ protected:
+  std::array<Lane, MAX_ESP_NOW_SEND_LANES> lanes_{};
+  Packet *current_packet_{nullptr};  // Packet being transmitted, nullptr if none
+  Lane *current_lane_{nullptr};      // Lane of the packet being transmitted
+  uint8_t next_lane_{0};             // Round-robin position for the next lane to serve
+};
+
+/// Wake schedule announced by a duty-cycled peer. The announcement carries the peer's offset into its current
+/// wake window, which anchors the predicted windows at their start. Every other frame from the peer is sent while
+/// its radio is on and only corrects drift.
+struct ESPNowPeerSchedule {
+  uint8_t address[ESPNOW_LANE_ADDR_LEN]{0};
+  uint16_t wake_interval{0};  // 0 if the peer is always on
+  uint16_t wake_window{0};
+  uint32_t anchor{0};      // millis() at the start of one of the peer's wake windows
+  uint32_t last_heard{0};  // millis() when the peer was last heard
+  bool in_use{false};
+
+  bool is_awake(uint32_t now) const {
+    if (this->wake_interval == 0 || this->wake_window >= this->wake_interval)
+      return true;
+    return (now - this->anchor) % this->wake_interval < this->wake_window;
+  }
+  /// The peer was heard at `now`, so its radio was on. Moves the prediction by the least amount that puts `now`
+  /// inside a wake window.
+  void heard(uint32_t now) {
+    this->last_heard = now;
+    if (this->wake_interval == 0 || this->wake_window >= this->wake_interval)
+      return;
+    const uint32_t phase = (now - this->anchor) % this->wake_interval;
+    if (phase < this->wake_window)
+      return;
+    if (phase - this->wake_window < this->wake_interval - phase) {
+      this->anchor += phase - this->wake_window + 1;  // The window started later than predicted
+    } else {
+      this->anchor -= this->wake_interval - phase;  // The window started earlier than predicted
+    }
+  }
+};
+
+/// Wake schedules of duty-cycled peers. The main loop records them as frames arrive while the transmit path reads
+/// them, from the worker task when there is one, so every access holds the lock.
+class ESPNowPeerSchedules {
+ public:
+  /// Schedule announced by a peer `offset` ms into one of its wake windows. An always-on schedule forgets the peer.
+  void announce(const uint8_t *peer, uint16_t interval, uint16_t window, uint16_t offset, uint32_t now) {
+    std::lock_guard<std::mutex> guard(this->lock_);
+    ESPNowPeerSchedule *schedule = this->find_(peer);
+    if (interval == 0 || window >= interval) {
+      // Always on, nothing to predict
+      if (schedule != nullptr)
+        *schedule = ESPNowPeerSchedule{};
+      return;
+    }
+    if (schedule == nullptr) {
+      // Take a free slot, or replace the peer heard from least recently
+      schedule = &this->schedules_[0];
+      for (auto &slot : this->schedules_) {
+        if (!slot.in_use) {
+          schedule = &slot;
+          break;
+        }
+        if (now - slot.last_heard > now - schedule->last_heard)
+          schedule = &slot;
+      }
+      memcpy(schedule->address, peer, ESPNOW_LANE_ADDR_LEN);
+      schedule->in_use = true;
+    }
+    schedule->wake_interval = interval;
+    schedule->wake_window = window;
+    // Anchor at the start of the window the announcement was sent in, not at its arrival
+    schedule->anchor = now - offset % interval;
+    schedule->last_heard = now;
+  }
+
+  /// Any frame proves the peer is awake right now
+  void heard(const uint8_t *peer, uint32_t now) {
+    std::lock_guard<std::mutex> guard(this->lock_);
+    ESPNowPeerSchedule *schedule = this->find_(peer);
+    if (schedule != nullptr)
+      schedule->heard(now);
+  }
+
+  /// Whether the peer is predicted to be awake, always true for peers without a schedule or one not refreshed
+  /// within `stale_ms`
+  bool is_awake(const uint8_t *peer, uint32_t now, uint32_t stale_ms) const {
+    std::lock_guard<std::mutex> guard(this->lock_);
+    const ESPNowPeerSchedule *schedule = this->find_(peer);
+    if (schedule == nullptr || now - schedule->last_heard > stale_ms)
+      return true;
+    return schedule->is_awake(now);
+  }
+
+ protected:
+  ESPNowPeerSchedule *find_(const uint8_t *peer) {
+    for (auto &schedule : this->schedules_) {
+      if (schedule.in_use && memcmp(schedule.address, peer, ESPNOW_LANE_ADDR_LEN) == 0)
+        return &schedule;
+    }
+    return nullptr;
+  }
+  const ESPNowPeerSchedule *find_(const uint8_t *peer) const {
+    return const_cast<ESPNowPeerSchedules *>(this)->find_(peer);
+  }
+
+  mutable std::mutex lock_;
+  std::array<ESPNowPeerSchedule, MAX_ESP_NOW_PEER_SCHEDULES> schedules_{};
+};
+
+}  // namespace esphome::espnow
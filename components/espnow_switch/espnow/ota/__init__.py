@@ -0,0 +1,73 @@
+"""ESP-NOW platform for the ota component."""
+
+from esphome import automation
+import esphome.codegen as cg
+from esphome.components.ota import BASE_OTA_SCHEMA, OTAComponent, ota_to_code
+import esphome.config_validation as cv
+from esphome.const import CONF_ID, CONF_PARTITION
+from esphome.core import HexInt
+
+from .. import ESPNowComponent, espnow_ns
+
+DEPENDENCIES = ["espnow"]
+AUTO_LOAD = ["md5"]
+
+ESPNowFrameHandler = espnow_ns.class_("ESPNowFrameHandler")
+ESPNowOTAComponent = espnow_ns.class_(
+    "ESPNowOTAComponent", OTAComponent, ESPNowFrameHandler
+)
+ESPNowOTAPushAction = espnow_ns.class_("ESPNowOTAPushAction", automation.Action)
+
+CONF_ESPNOW_ID = "espnow_id"
+CONF_ALLOWED_SENDERS = "allowed_senders"
+CONF_TARGETS = "targets"
+
+MAX_TARGETS = 4
+
+CONFIG_SCHEMA = (
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(ESPNowOTAComponent),
+            cv.GenerateID(CONF_ESPNOW_ID): cv.use_id(ESPNowComponent),
+            # Flashing is unauthenticated apart from the sender address, so the senders must be listed
+            cv.Required(CONF_ALLOWED_SENDERS): cv.All(
+                cv.ensure_list(cv.mac_address), cv.Length(min=1)
+            ),
+        }
+    )
+    .extend(BASE_OTA_SCHEMA)
+    .extend(cv.COMPONENT_SCHEMA)
+)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await ota_to_code(var, config)
+    await cg.register_component(var, config)
+    await cg.register_parented(var, config[CONF_ESPNOW_ID])
+
+    for sender in config[CONF_ALLOWED_SENDERS]:
+        cg.add(var.add_allowed_sender([HexInt(x) for x in sender.parts]))
+
+
+@automation.register_action(
+    "espnow.ota.push",
+    ESPNowOTAPushAction,
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.use_id(ESPNowOTAComponent),
+            cv.Required(CONF_TARGETS): cv.All(
+                cv.ensure_list(cv.mac_address), cv.Length(min=1, max=MAX_TARGETS)
+            ),
+            cv.Optional(CONF_PARTITION): cv.string_strict,
+        }
+    ),
+)
+async def ota_push_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    for target in config[CONF_TARGETS]:
+        cg.add(var.add_target([HexInt(x) for x in target.parts]))
+    if CONF_PARTITION in config:
+        cg.add(var.set_partition(config[CONF_PARTITION]))
+    return var
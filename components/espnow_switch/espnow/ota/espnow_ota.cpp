@@ -0,0 +1,501 @@
+#include "espnow_ota.h"
+
+#ifdef USE_ESP32
+
+#include "esphome/components/md5/md5.h"
+#include "esphome/core/application.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+#include <esp_image_format.h>
+#include <esp_ota_ops.h>
+#include <esp_random.h>
+
+#include <cinttypes>
+#include <cstring>
+
+namespace esphome::espnow {
+
+static constexpr const char *TAG = "espnow.ota";
+
+// Receiver gives up when the sender stays silent this long
+static constexpr uint32_t ESPNOW_OTA_RECEIVE_TIMEOUT = 10000;
+// Time spent hashing the pushed image per loop iteration
+static constexpr uint32_t ESPNOW_OTA_HASH_BUDGET_MS = 8;
+// Flash read size while hashing
+static constexpr size_t ESPNOW_OTA_HASH_READ_SIZE = 1024;
+
+static_assert(sizeof(ESPNowOTAData) + ESPNOW_OTA_CHUNK_SIZE <= ESP_NOW_MAX_DATA_LEN, "OTA chunks must fit one frame");
+
+void ESPNowOTAComponent::setup() {
+  this->parent_->register_frame_handler(ESPNOW_FRAME_OTA, this);
+  for (auto &address : this->allowed_senders_) {
+    this->parent_->add_peer(address);
+  }
+}
+
+void ESPNowOTAComponent::dump_config() {
+  ESP_LOGCONFIG(TAG,
+                "ESP-NOW OTA:\n"
+                "  Chunk size: %u bytes\n"
+                "  Window: %u chunks",
+                ESPNOW_OTA_CHUNK_SIZE, ESPNOW_OTA_WINDOW);
+  for (auto &address : this->allowed_senders_) {
+    char addr_buf[MAC_ADDRESS_PRETTY_BUFFER_SIZE];
+    format_mac_addr_upper(address.data(), addr_buf);
+    ESP_LOGCONFIG(TAG, "  Allowed sender: %s", addr_buf);
+  }
+}
+
+void ESPNowOTAComponent::loop() {
+  const uint32_t now = millis();
+  if (this->receive_.state.is_active() && now - this->receive_.last_frame_ms > ESPNOW_OTA_RECEIVE_TIMEOUT) {
+    this->abort_receive_("sender timed out");
+  }
+
+  if (!this->push_active_)
+    return;
+  if (this->push_hashing_) {
+    this->hash_step_();
+    return;
+  }
+  bool running = false;
+  for (size_t i = 0; i < this->num_targets_; i++) {
+    Target &target = this->targets_[i];
+    if (target.state.is_finished())
+      continue;
+    this->service_target_(target, now);
+    running |= !target.state.is_finished();
+  }
+  if (!running)
+    this->finish_push_();
+}
+
+void ESPNowOTAComponent::on_frame(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) {
+  if (size < sizeof(ESPNowOTAHeader))
+    return;
+  const auto *header = reinterpret_cast<const ESPNowOTAHeader *>(data);
+  switch (header->opcode) {
+    case ESPNOW_OTA_BEGIN:
+      this->handle_begin_(info, data, size);
+      break;
+    case ESPNOW_OTA_DATA:
+      this->handle_data_(info, data, size);
+      break;
+    case ESPNOW_OTA_END:
+      this->handle_end_(info, data, size);
+      break;
+    case ESPNOW_OTA_ACK:
+      this->handle_ack_(info, data, size);
+      break;
+    case ESPNOW_OTA_RESULT:
+      this->handle_result_(info, data, size);
+      break;
+    case ESPNOW_OTA_ABORT:
+      if (this->receive_.state.matches(info.src_addr, header->session)) {
+        this->abort_receive_("aborted by sender");
+      } else if (Target *target = this->find_target_(info.src_addr, header->session)) {
+        ESP_LOGW(TAG, "Target aborted the transfer");
+        target->state.fail();
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Receiver
+
+bool ESPNowOTAComponent::is_allowed_sender_(const uint8_t *address) const {
+  for (auto &allowed : this->allowed_senders_) {
+    if (memcmp(allowed.data(), address, ESP_NOW_ETH_ALEN) == 0)
+      return true;
+  }
+  return false;
+}
+
+void ESPNowOTAComponent::handle_begin_(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) {
+  if (size < sizeof(ESPNowOTABegin))
+    return;
+  const auto *begin = reinterpret_cast<const ESPNowOTABegin *>(data);
+  if (!this->is_allowed_sender_(info.src_addr)) {
+    char addr_buf[MAC_ADDRESS_PRETTY_BUFFER_SIZE];
+    format_mac_addr_upper(info.src_addr, addr_buf);
+    ESP_LOGW(TAG, "Ignoring OTA request from %s, not an allowed sender", addr_buf);
+    return;
+  }
+  switch (this->receive_.state.on_begin(info.src_addr, begin->header.session)) {
+    case ESPNowOTAReceiveSession::BEGIN_REPEAT_ACK:
+      this->send_ack_();
+      return;
+    case ESPNowOTAReceiveSession::BEGIN_BUSY:
+      this->send_result_(info.src_addr, begin->header.session, ota::OTA_RESPONSE_ERROR_UNKNOWN);
+      return;
+    case ESPNowOTAReceiveSession::BEGIN_RESTART:
+      this->abort_receive_("restarted by sender");
+      break;
+    default:
+      break;
+  }
+  if (begin->chunk_size == 0 || begin->chunk_size > ESPNOW_OTA_CHUNK_SIZE || begin->image_size == 0) {
+    this->send_result_(info.src_addr, begin->header.session, ota::OTA_RESPONSE_ERROR_UNKNOWN);
+    return;
+  }
+
+  Receive &rx = this->receive_;
+  if (!rx.state.start(info.src_addr, begin->header.session, begin->image_size, begin->chunk_size)) {
+    ESP_LOGE(TAG, "Failed to allocate the receive window");
+    this->send_result_(info.src_addr, begin->header.session, ota::OTA_RESPONSE_ERROR_UNKNOWN);
+    return;
+  }
+  rx.backend = ota::make_ota_backend();
+  ota::OTAResponseTypes error = rx.backend->begin(begin->image_size);
+  if (error != ota::OTA_RESPONSE_OK) {
+    ESP_LOGE(TAG, "Failed to start the update: %u", error);
+    rx.backend.reset();
+    rx.state.abort();
+    this->send_result_(info.src_addr, begin->header.session, error);
+    return;
+  }
+  char md5[33];
+  memcpy(md5, begin->md5, 32);
+  md5[32] = '\0';
+  rx.backend->set_update_md5(md5);
+  rx.last_frame_ms = millis();
+
+  char addr_buf[MAC_ADDRESS_PRETTY_BUFFER_SIZE];
+  format_mac_addr_upper(info.src_addr, addr_buf);
+  ESP_LOGI(TAG, "Receiving %" PRIu32 " bytes from %s", rx.state.window().image_size(), addr_buf);
+#ifdef USE_OTA_STATE_CALLBACK
+  this->state_callback_.call(ota::OTA_STARTED, 0.0f, 0);
+#endif
+  this->send_ack_();
+}
+
+void ESPNowOTAComponent::handle_data_(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) {
+  Receive &rx = this->receive_;
+  if (size < sizeof(ESPNowOTAData))
+    return;
+  const auto *frame = reinterpret_cast<const ESPNowOTAData *>(data);
+  if (!rx.state.matches(info.src_addr, frame->header.session))
+    return;
+  rx.last_frame_ms = millis();
+
+  ESPNowOTAReceiveWindow &window = rx.state.window();
+  const uint32_t seq = frame->seq;
+  const uint16_t length = size - sizeof(ESPNowOTAData);
+  switch (window.accept(seq, data + sizeof(ESPNowOTAData), length)) {
+    case ESPNowOTAReceiveWindow::ACCEPT_OUT_OF_WINDOW:
+      this->send_ack_();
+      return;
+    case ESPNowOTAReceiveWindow::ACCEPT_BAD_LENGTH:
+      ESP_LOGW(TAG, "Chunk %" PRIu32 " has %u bytes, expected %u", seq, length, window.expected_length(seq));
+      return;
+    default:
+      break;
+  }
+
+  // Write out the contiguous prefix of the window
+  const uint8_t *chunk;
+  uint16_t chunk_length;
+  while (window.front(&chunk, &chunk_length)) {
+    ota::OTAResponseTypes error = rx.backend->write(const_cast<uint8_t *>(chunk), chunk_length);
+    if (error != ota::OTA_RESPONSE_OK) {
+      ESP_LOGE(TAG, "Writing chunk %" PRIu32 " failed: %u", window.base(), error);
+      this->send_result_(rx.state.sender(), rx.state.session(), error);
+      this->abort_receive_("write failed");
+      return;
+    }
+    window.pop();
+#ifdef USE_OTA_STATE_CALLBACK
+    if (window.base() % ESPNOW_OTA_WINDOW == 0) {
+      float percentage = (window.base() * 100.0f) / window.total_chunks();
+      this->state_callback_.call(ota::OTA_IN_PROGRESS, percentage, 0);
+    }
+#endif
+  }
+
+  if (rx.state.on_stored())
+    this->send_ack_();
+}
+
+void ESPNowOTAComponent::handle_end_(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) {
+  Receive &rx = this->receive_;
+  const auto *header = reinterpret_cast<const ESPNowOTAHeader *>(data);
+  switch (rx.state.on_end(info.src_addr, header->session)) {
+    case ESPNowOTAReceiveSession::END_ACK:
+      this->send_ack_();
+      return;
+    case ESPNowOTAReceiveSession::END_REPEAT_RESULT:
+      // Our RESULT got lost, the sender keeps asking until the reboot
+      this->send_result_(info.src_addr, header->session, rx.state.result());
+      return;
+    case ESPNowOTAReceiveSession::END_FINISH:
+      break;
+    default:
+      return;
+  }
+
+  ota::OTAResponseTypes error = rx.backend->end();
+  rx.backend.reset();
+  rx.state.finish(error);
+  this->send_result_(rx.state.sender(), rx.state.session(), error);
+  if (error != ota::OTA_RESPONSE_OK) {
+    ESP_LOGE(TAG, "Update verification failed: %u", error);
+#ifdef USE_OTA_STATE_CALLBACK
+    this->state_callback_.call(ota::OTA_ERROR, 0.0f, static_cast<uint8_t>(error));
+#endif
+    return;
+  }
+
+  ESP_LOGI(TAG, "Update successful, rebooting");
+#ifdef USE_OTA_STATE_CALLBACK
+  this->state_callback_.call(ota::OTA_COMPLETED, 100.0f, 0);
+#endif
+  this->set_timeout("reboot", ESPNOW_OTA_REBOOT_DELAY, []() { App.safe_reboot(); });
+}
+
+void ESPNowOTAComponent::send_ack_() {
+  ESPNowOTAReceiveSession &rx = this->receive_.state;
+  ESPNowOTAAck ack{};
+  ack.header.frame.init(ESPNOW_FRAME_OTA);
+  ack.header.opcode = ESPNOW_OTA_ACK;
+  ack.header.session = rx.session();
+  ack.base = rx.window().base();
+  ack.bitmap = rx.window().bitmap();
+  rx.acked();
+  this->parent_->send(rx.sender(), reinterpret_cast<const uint8_t *>(&ack), sizeof(ack));
+}
+
+void ESPNowOTAComponent::send_result_(const uint8_t *address, uint16_t session, uint8_t error) {
+  ESPNowOTAResult result{};
+  result.header.frame.init(ESPNOW_FRAME_OTA);
+  result.header.opcode = ESPNOW_OTA_RESULT;
+  result.header.session = session;
+  result.error = error;
+  this->parent_->send(address, reinterpret_cast<const uint8_t *>(&result), sizeof(result));
+}
+
+void ESPNowOTAComponent::abort_receive_(const char *reason) {
+  Receive &rx = this->receive_;
+  if (!rx.state.is_active())
+    return;
+  ESP_LOGW(TAG, "Update aborted: %s", reason);
+  if (rx.backend)
+    rx.backend->abort();
+  rx.backend.reset();
+  rx.state.abort();
+#ifdef USE_OTA_STATE_CALLBACK
+  this->state_callback_.call(ota::OTA_ERROR, 0.0f, static_cast<uint8_t>(ota::OTA_RESPONSE_ERROR_UNKNOWN));
+#endif
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Sender
+
+bool ESPNowOTAComponent::push(const std::vector<peer_address_t> &targets, const std::string &partition_label) {
+  if (this->push_active_) {
+    ESP_LOGW(TAG, "A push is already running");
+    return false;
+  }
+  if (targets.empty() || targets.size() > MAX_ESPNOW_OTA_TARGETS) {
+    ESP_LOGE(TAG, "Push needs between 1 and %zu targets", MAX_ESPNOW_OTA_TARGETS);
+    return false;
+  }
+
+  const esp_partition_t *partition;
+  if (partition_label.empty()) {
+    partition = esp_ota_get_running_partition();
+  } else {
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_ANY, partition_label.c_str());
+  }
+  if (partition == nullptr) {
+    ESP_LOGE(TAG, "Partition '%s' not found", partition_label.c_str());
+    return false;
+  }
+
+  const esp_partition_pos_t pos = {.offset = partition->address, .size = partition->size};
+  esp_image_metadata_t metadata{};
+  esp_err_t err = esp_image_get_metadata(&pos, &metadata);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "No valid image in partition '%s': %s", partition->label, esp_err_to_name(err));
+    return false;
+  }
+
+  this->push_partition_ = partition;
+  this->push_image_size_ = metadata.image_len;
+  this->push_total_chunks_ = (metadata.image_len + ESPNOW_OTA_CHUNK_SIZE - 1) / ESPNOW_OTA_CHUNK_SIZE;
+  do {
+    this->push_session_ = static_cast<uint16_t>(esp_random());
+  } while (this->push_session_ == 0);
+
+  this->num_targets_ = targets.size();
+  for (size_t i = 0; i < this->num_targets_; i++) {
+    Target &target = this->targets_[i];
+    target = Target{};
+    memcpy(target.address, targets[i].data(), ESP_NOW_ETH_ALEN);
+    this->parent_->add_peer(target.address);
+  }
+
+  // The receivers verify the image against its md5; hashing it is spread over loop() with a time budget
+  this->push_hash_.init();
+  this->push_hash_offset_ = 0;
+  this->push_hashing_ = true;
+  this->push_active_ = true;
+  ESP_LOGI(TAG, "Hashing %" PRIu32 " bytes from '%s' for %zu peers", this->push_image_size_, partition->label,
+           this->num_targets_);
+  return true;
+}
+
+void ESPNowOTAComponent::hash_step_() {
+  uint8_t buf[ESPNOW_OTA_HASH_READ_SIZE];
+  const uint32_t start = millis();
+  while (this->push_hash_offset_ < this->push_image_size_ && millis() - start < ESPNOW_OTA_HASH_BUDGET_MS) {
+    const size_t length = std::min<size_t>(sizeof(buf), this->push_image_size_ - this->push_hash_offset_);
+    esp_err_t err = esp_partition_read(this->push_partition_, this->push_hash_offset_, buf, length);
+    if (err != ESP_OK) {
+      ESP_LOGE(TAG, "Reading the image failed: %s", esp_err_to_name(err));
+      this->push_hashing_ = false;
+      for (size_t i = 0; i < this->num_targets_; i++)
+        this->targets_[i].state.fail();
+      this->finish_push_();
+      return;
+    }
+    this->push_hash_.add(buf, length);
+    this->push_hash_offset_ += length;
+  }
+  if (this->push_hash_offset_ < this->push_image_size_)
+    return;
+
+  this->push_hash_.calculate();
+  this->push_hash_.get_hex(this->push_md5_);
+  this->push_md5_[32] = '\0';
+  this->push_hashing_ = false;
+  // Target timeouts start counting once the transfer actually begins
+  const uint32_t now = millis();
+  for (size_t i = 0; i < this->num_targets_; i++)
+    this->targets_[i].state.start(now);
+  ESP_LOGI(TAG, "Pushing %" PRIu32 " bytes to %zu peers, md5 %s", this->push_image_size_, this->num_targets_,
+           this->push_md5_);
+}
+
+ESPNowOTAComponent::Target *ESPNowOTAComponent::find_target_(const uint8_t *address, uint16_t session) {
+  if (!this->push_active_ || this->push_hashing_ || session != this->push_session_)
+    return nullptr;
+  for (size_t i = 0; i < this->num_targets_; i++) {
+    if (memcmp(this->targets_[i].address, address, ESP_NOW_ETH_ALEN) == 0)
+      return &this->targets_[i];
+  }
+  return nullptr;
+}
+
+void ESPNowOTAComponent::service_target_(Target &target, uint32_t now) {
+  switch (target.state.service(now)) {
+    case ESPNowOTASendSession::ACTION_ABORT: {
+      char addr_buf[MAC_ADDRESS_PRETTY_BUFFER_SIZE];
+      format_mac_addr_upper(target.address, addr_buf);
+      ESP_LOGW(TAG, "Push to %s timed out at chunk %" PRIu32, addr_buf, target.state.base());
+      this->send_control_(target, ESPNOW_OTA_ABORT);
+      return;
+    }
+    case ESPNowOTASendSession::ACTION_BEGIN:
+      this->send_control_(target, ESPNOW_OTA_BEGIN);
+      return;
+    case ESPNowOTASendSession::ACTION_END:
+      this->send_control_(target, ESPNOW_OTA_END);
+      return;
+    case ESPNowOTASendSession::ACTION_DATA:
+      break;
+    default:
+      return;
+  }
+
+  uint32_t seq;
+  while (target.state.next_chunk(this->push_total_chunks_, &seq)) {
+    if (!this->send_chunk_(target, seq))
+      break;
+    target.state.chunk_sent(seq, now);
+  }
+}
+
+bool ESPNowOTAComponent::send_chunk_(Target &target, uint32_t seq) {
+  uint8_t buf[sizeof(ESPNowOTAData) + ESPNOW_OTA_CHUNK_SIZE];
+  auto *frame = reinterpret_cast<ESPNowOTAData *>(buf);
+  frame->header.frame.init(ESPNOW_FRAME_OTA);
+  frame->header.opcode = ESPNOW_OTA_DATA;
+  frame->header.session = this->push_session_;
+  frame->seq = seq;
+  const uint32_t offset = seq * ESPNOW_OTA_CHUNK_SIZE;
+  const size_t length = std::min<size_t>(ESPNOW_OTA_CHUNK_SIZE, this->push_image_size_ - offset);
+  if (esp_partition_read(this->push_partition_, offset, buf + sizeof(ESPNowOTAData), length) != ESP_OK)
+    return false;
+
+  const uint16_t session = this->push_session_;
+  esp_err_t err = this->parent_->send(target.address, buf, sizeof(ESPNowOTAData) + length,
+                                      [this, &target, session](esp_err_t status) {
+                                        if (session == this->push_session_)
+                                          target.state.send_done();
+                                      });
+  return err == ESP_OK;
+}
+
+void ESPNowOTAComponent::send_control_(Target &target, ESPNowOTAOpcode opcode) {
+  if (opcode == ESPNOW_OTA_BEGIN) {
+    ESPNowOTABegin begin{};
+    begin.header.frame.init(ESPNOW_FRAME_OTA);
+    begin.header.opcode = ESPNOW_OTA_BEGIN;
+    begin.header.session = this->push_session_;
+    begin.image_size = this->push_image_size_;
+    begin.chunk_size = ESPNOW_OTA_CHUNK_SIZE;
+    memcpy(begin.md5, this->push_md5_, sizeof(begin.md5));
+    this->parent_->send(target.address, reinterpret_cast<const uint8_t *>(&begin), sizeof(begin));
+    return;
+  }
+  ESPNowOTAHeader header{};
+  header.frame.init(ESPNOW_FRAME_OTA);
+  header.opcode = opcode;
+  header.session = this->push_session_;
+  this->parent_->send(target.address, reinterpret_cast<const uint8_t *>(&header), sizeof(header));
+}
+
+void ESPNowOTAComponent::handle_ack_(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) {
+  if (size < sizeof(ESPNowOTAAck))
+    return;
+  const auto *ack = reinterpret_cast<const ESPNowOTAAck *>(data);
+  Target *target = this->find_target_(info.src_addr, ack->header.session);
+  if (target != nullptr && target->state.on_ack(ack->base, ack->bitmap, this->push_total_chunks_, millis()))
+    this->send_control_(*target, ESPNOW_OTA_END);
+}
+
+void ESPNowOTAComponent::handle_result_(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) {
+  if (size < sizeof(ESPNowOTAResult))
+    return;
+  const auto *result = reinterpret_cast<const ESPNowOTAResult *>(data);
+  Target *target = this->find_target_(info.src_addr, result->header.session);
+  if (target == nullptr || !target->state.on_result(result->error == ota::OTA_RESPONSE_OK))
+    return;
+  char addr_buf[MAC_ADDRESS_PRETTY_BUFFER_SIZE];
+  format_mac_addr_upper(info.src_addr, addr_buf);
+  if (result->error == ota::OTA_RESPONSE_OK) {
+    ESP_LOGI(TAG, "Push to %s successful", addr_buf);
+  } else {
+    ESP_LOGE(TAG, "Push to %s failed with error %u", addr_buf, result->error);
+  }
+}
+
+void ESPNowOTAComponent::finish_push_() {
+  size_t done = 0;
+  for (size_t i = 0; i < this->num_targets_; i++) {
+    if (this->targets_[i].state.phase() == ESPNowOTASendSession::PHASE_DONE)
+      done++;
+  }
+  ESP_LOGI(TAG, "Push finished, %zu of %zu peers updated", done, this->num_targets_);
+  this->push_active_ = false;
+  // Invalidate callbacks of frames that are still queued
+  this->push_session_ = 0;
+}
+
+}  // namespace esphome::espnow
+
+#endif  // USE_ESP32
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "../espnow_component.h"
+#include "espnow_ota_window.h"
+
+#ifdef USE_ESP32
+
+#include "esphome/components/md5/md5.h"
+#include "esphome/components/ota/ota_backend.h"
+#include "esphome/core/automation.h"
+#include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+
+#include <esp_partition.h>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace esphome::espnow {
+
+// Number of peers a gateway can update at the same time
+static constexpr size_t MAX_ESPNOW_OTA_TARGETS = 4;
+
+static_assert(ESPNOW_OTA_ADDR_LEN == ESP_NOW_ETH_ALEN, "OTA sessions store full peer addresses");
+
+enum ESPNowOTAOpcode : uint8_t {
+  ESPNOW_OTA_BEGIN = 1,   // sender -> receiver: image size, chunk size, md5
+  ESPNOW_OTA_DATA = 2,    // sender -> receiver: one chunk
+  ESPNOW_OTA_ACK = 3,     // receiver -> sender: next expected chunk and selective ack bitmap
+  ESPNOW_OTA_END = 4,     // sender -> receiver: all chunks acknowledged, verify and apply
+  ESPNOW_OTA_RESULT = 5,  // receiver -> sender: outcome of END
+  ESPNOW_OTA_ABORT = 6,   // either direction: cancel the session
+};
+
+struct __attribute__((packed)) ESPNowOTAHeader {
+  ESPNowFrameHeader frame;
+  uint8_t opcode;    // ESPNowOTAOpcode
+  uint16_t session;  // Chosen by the sender, all frames of one transfer carry it
+};
+
+struct __attribute__((packed)) ESPNowOTABegin {
+  ESPNowOTAHeader header;
+  uint32_t image_size;
+  uint16_t chunk_size;
+  char md5[32];  // Hex digest of the whole image
+};
+
+struct __attribute__((packed)) ESPNowOTAData {
+  ESPNowOTAHeader header;
+  uint32_t seq;  // Chunk index, the payload follows
+};
+
+struct __attribute__((packed)) ESPNowOTAAck {
+  ESPNowOTAHeader header;
+  uint32_t base;    // Next chunk the receiver needs to write; all chunks before it are written
+  uint32_t bitmap;  // Bit i set when chunk base + i is buffered already
+};
+
+struct __attribute__((packed)) ESPNowOTAResult {
+  ESPNowOTAHeader header;
+  uint8_t error;  // ota::OTAResponseTypes, ota::OTA_RESPONSE_OK on success
+};
+
+/// Receives firmware images over ESP-NOW and writes them straight into the OTA partition, and can
+/// stream an image from a local partition to several peers at once.
+///
+/// Transfers use a sliding window of ESPNOW_OTA_WINDOW chunks. The receiver buffers out-of-order
+/// chunks inside the window only and acknowledges with a selective bitmap, so the sender only
+/// retransmits what is actually missing.
+class ESPNowOTAComponent : public ota::OTAComponent, public Parented<ESPNowComponent>, public ESPNowFrameHandler {
+ public:
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::AFTER_WIFI; }
+
+  void add_allowed_sender(peer_address_t address) { this->allowed_senders_.push_back(address); }
+
+  /// Start streaming the image in `partition_label` (or the running firmware if empty) to `targets`.
+  /// The image is hashed over the following loop iterations before the first frame goes out.
+  /// @return false if a push is already running or the image cannot be read
+  bool push(const std::vector<peer_address_t> &targets, const std::string &partition_label);
+  bool is_pushing() const { return this->push_active_; }
+
+  void on_frame(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) override;
+
+ protected:
+  // Receiver side
+  struct Receive {
+    ESPNowOTAReceiveSession state;
+    uint32_t last_frame_ms{0};
+    std::unique_ptr<ota::OTABackend> backend;
+  };
+
+  void handle_begin_(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size);
+  void handle_data_(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size);
+  void handle_end_(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size);
+  void send_ack_();
+  void send_result_(const uint8_t *address, uint16_t session, uint8_t error);
+  void abort_receive_(const char *reason);
+  bool is_allowed_sender_(const uint8_t *address) const;
+
+  // Sender side
+  struct Target {
+    uint8_t address[ESP_NOW_ETH_ALEN]{0};
+    ESPNowOTASendSession state;
+  };
+
+  void handle_ack_(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size);
+  void handle_result_(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size);
+  Target *find_target_(const uint8_t *address, uint16_t session);
+  void service_target_(Target &target, uint32_t now);
+  bool send_chunk_(Target &target, uint32_t seq);
+  void send_control_(Target &target, ESPNowOTAOpcode opcode);
+  void hash_step_();
+  void finish_push_();
+
+  std::vector<peer_address_t> allowed_senders_{};
+  Receive receive_{};
+
+  std::array<Target, MAX_ESPNOW_OTA_TARGETS> targets_{};
+  size_t num_targets_{0};
+  const esp_partition_t *push_partition_{nullptr};
+  uint32_t push_image_size_{0};
+  uint32_t push_total_chunks_{0};
+  char push_md5_[33]{0};
+  md5::MD5Digest push_hash_{};
+  uint32_t push_hash_offset_{0};
+  uint16_t push_session_{0};
+  bool push_active_{false};
+  bool push_hashing_{false};  // Still hashing the image, no frames sent yet
+};
+
+template<typename... Ts> class ESPNowOTAPushAction : public Action<Ts...>, public Parented<ESPNowOTAComponent> {
+ public:
+  void add_target(peer_address_t address) { this->targets_.push_back(address); }
+  void set_partition(const std::string &partition) { this->partition_ = partition; }
+
+  void play(const Ts &...x) override { this->parent_->push(this->targets_, this->partition_); }
+
+ protected:
+  std::vector<peer_address_t> targets_{};
+  std::string partition_{};
+};
+
+}  // namespace esphome::espnow
+
+#endif  // USE_ESP32
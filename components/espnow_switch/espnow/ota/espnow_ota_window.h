@@ -0,0 +1,361 @@
+#pragma once
+
+// Sliding window bookkeeping and session rules of the ESP-NOW OTA transfer. Kept free of ESPHome and ESP-IDF
+// dependencies so the protocol can be exercised on a Linux host (see tests/espnow_ota).
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+
+namespace esphome::espnow {
+
+// Payload bytes per data frame
+static constexpr uint16_t ESPNOW_OTA_CHUNK_SIZE = 240;
+// Maximum number of chunks in flight per target; must fit the 32 bit ack bitmap
+static constexpr uint8_t ESPNOW_OTA_WINDOW = 16;
+
+// Sender gives up on a target that makes no progress for this long
+static constexpr uint32_t ESPNOW_OTA_TARGET_TIMEOUT = 15000;
+// Interval for repeating BEGIN and END until the target answers
+static constexpr uint32_t ESPNOW_OTA_CONTROL_INTERVAL = 500;
+// Chunks without an ack are retransmitted after this long
+static constexpr uint32_t ESPNOW_OTA_ACK_TIMEOUT = 300;
+// Frames queued per target at once, stays below the per-peer send lane depth
+static constexpr uint8_t ESPNOW_OTA_MAX_IN_FLIGHT = 2;
+// Delay before rebooting, long enough to answer a few repeated ENDs whose RESULT got lost
+static constexpr uint32_t ESPNOW_OTA_REBOOT_DELAY = 2000;
+// Length of a peer address
+static constexpr size_t ESPNOW_OTA_ADDR_LEN = 6;
+
+static_assert(ESPNOW_OTA_WINDOW <= 32, "The ack bitmap holds at most 32 chunks");
+static_assert(ESPNOW_OTA_REBOOT_DELAY >= 2 * ESPNOW_OTA_CONTROL_INTERVAL, "A lost RESULT must be repeatable");
+
+/// Receiver side: buffers out-of-order chunks inside the window and hands out the contiguous prefix in order.
+class ESPNowOTAReceiveWindow {
+ public:
+  enum Accept : uint8_t {
+    ACCEPT_STORED,         // Chunk buffered (or was buffered already)
+    ACCEPT_OUT_OF_WINDOW,  // Duplicate or outside the window, the sender is behind our state
+    ACCEPT_BAD_LENGTH,     // Payload size does not match the chunk
+  };
+
+  bool start(uint32_t image_size, uint16_t chunk_size) {
+    this->window_ = std::unique_ptr<uint8_t[]>(new (std::nothrow) uint8_t[ESPNOW_OTA_WINDOW * chunk_size]);
+    if (!this->window_)
+      return false;
+    this->image_size_ = image_size;
+    this->chunk_size_ = chunk_size;
+    this->total_chunks_ = (image_size + chunk_size - 1) / chunk_size;
+    this->base_ = 0;
+    this->bitmap_ = 0;
+    return true;
+  }
+  void reset() { this->window_.reset(); }
+
+  uint16_t expected_length(uint32_t seq) const {
+    return seq == this->total_chunks_ - 1 ? this->image_size_ - seq * this->chunk_size_ : this->chunk_size_;
+  }
+
+  Accept accept(uint32_t seq, const uint8_t *data, uint16_t length) {
+    if (seq < this->base_ || seq >= this->base_ + ESPNOW_OTA_WINDOW || seq >= this->total_chunks_)
+      return ACCEPT_OUT_OF_WINDOW;
+    if (length != this->expected_length(seq))
+      return ACCEPT_BAD_LENGTH;
+    const uint32_t offset = seq - this->base_;
+    if ((this->bitmap_ & (1UL << offset)) == 0) {
+      const uint8_t slot = seq % ESPNOW_OTA_WINDOW;
+      memcpy(this->window_.get() + slot * this->chunk_size_, data, length);
+      this->sizes_[slot] = length;
+      this->bitmap_ |= 1UL << offset;
+    }
+    return ACCEPT_STORED;
+  }
+
+  /// The next chunk to write, if it has arrived. Call pop() once it is written.
+  bool front(const uint8_t **data, uint16_t *length) const {
+    if ((this->bitmap_ & 1UL) == 0)
+      return false;
+    const uint8_t slot = this->base_ % ESPNOW_OTA_WINDOW;
+    *data = this->window_.get() + slot * this->chunk_size_;
+    *length = this->sizes_[slot];
+    return true;
+  }
+  void pop() {
+    this->bitmap_ >>= 1;
+    this->base_++;
+  }
+
+  uint32_t base() const { return this->base_; }
+  uint32_t bitmap() const { return this->bitmap_; }
+  uint32_t total_chunks() const { return this->total_chunks_; }
+  uint32_t image_size() const { return this->image_size_; }
+  uint16_t chunk_size() const { return this->chunk_size_; }
+  bool is_complete() const { return this->base_ == this->total_chunks_; }
+
+ protected:
+  std::unique_ptr<uint8_t[]> window_;  // ESPNOW_OTA_WINDOW * chunk_size bytes
+  uint16_t sizes_[ESPNOW_OTA_WINDOW]{0};
+  uint32_t image_size_{0};
+  uint32_t total_chunks_{0};
+  uint32_t base_{0};    // Next chunk to write
+  uint32_t bitmap_{0};  // Buffered chunks relative to base
+  uint16_t chunk_size_{0};
+};
+
+/// Sender side for one target: tracks acknowledged, outstanding and lost chunks relative to the receiver's base.
+class ESPNowOTASendWindow {
+ public:
+  /// Chunks that were sent but never acknowledged are presumed lost.
+  void expire_sent() {
+    this->missing_ |= this->sent_;
+    this->sent_ = 0;
+  }
+
+  /// The next chunk to send: retransmissions first, then new chunks inside the window.
+  bool next(uint32_t total_chunks, uint32_t *seq) const {
+    uint32_t pending = this->missing_;
+    if (pending == 0) {
+      pending = ~(this->acked_ | this->sent_);
+      if (ESPNOW_OTA_WINDOW < 32)
+        pending &= (1UL << ESPNOW_OTA_WINDOW) - 1;
+    }
+    if (pending == 0)
+      return false;
+    const uint32_t offset = __builtin_ctz(pending);
+    if (this->base_ + offset >= total_chunks)
+      return false;
+    *seq = this->base_ + offset;
+    return true;
+  }
+  void mark_sent(uint32_t seq) {
+    const uint32_t bit = 1UL << (seq - this->base_);
+    this->missing_ &= ~bit;
+    this->sent_ |= bit;
+  }
+
+  /// Apply an ack. Returns false for a stale ack; `progressed` is set when the base moved forward.
+  bool on_ack(uint32_t base, uint32_t bitmap, bool *progressed) {
+    *progressed = false;
+    if (base > this->base_) {
+      const uint32_t shift = base - this->base_;
+      this->sent_ = shift >= 32 ? 0 : this->sent_ >> shift;
+      this->missing_ = shift >= 32 ? 0 : this->missing_ >> shift;
+      this->base_ = base;
+      *progressed = true;
+    } else if (base < this->base_) {
+      return false;
+    }
+    this->acked_ = bitmap;
+    this->sent_ &= ~bitmap;
+    this->missing_ &= ~bitmap;
+    if (bitmap != 0) {
+      // Frames to one peer are delivered in order, so sent chunks below the highest buffered one were lost
+      const uint32_t highest = 31 - __builtin_clz(bitmap);
+      const uint32_t lost = this->sent_ & ((1UL << highest) - 1);
+      this->missing_ |= lost;
+      this->sent_ &= ~lost;
+    }
+    return true;
+  }
+
+  uint32_t base() const { return this->base_; }
+  bool has_unacked() const { return this->sent_ != 0; }
+
+ protected:
+  uint32_t base_{0};     // All chunks before it are acknowledged
+  uint32_t acked_{0};    // Acknowledged chunks relative to base
+  uint32_t sent_{0};     // Chunks sent and not acknowledged yet, relative to base
+  uint32_t missing_{0};  // Chunks to retransmit, relative to base
+};
+
+/// Receiver side of one transfer: which sender and session it belongs to, when to acknowledge, and the outcome of the
+/// last finished session so a repeated END can be answered after the RESULT got lost.
+class ESPNowOTAReceiveSession {
+ public:
+  enum Begin : uint8_t {
+    BEGIN_START,       // No transfer running, start this one
+    BEGIN_REPEAT_ACK,  // Repeated BEGIN of the running transfer, our first ack got lost
+    BEGIN_RESTART,     // The same sender started over, abort the running transfer and start this one
+    BEGIN_BUSY,        // Another sender's transfer is running
+  };
+  enum End : uint8_t {
+    END_IGNORE,         // Not a session we know
+    END_ACK,            // Chunks are still missing, answer with an ack
+    END_FINISH,         // All chunks are written: verify the image and call finish()
+    END_REPEAT_RESULT,  // The session is finished already and its RESULT got lost, send result() again
+  };
+
+  Begin on_begin(const uint8_t *sender, uint16_t session) const {
+    if (!this->active_)
+      return BEGIN_START;
+    if (memcmp(this->sender_, sender, ESPNOW_OTA_ADDR_LEN) != 0)
+      return BEGIN_BUSY;
+    return session == this->session_ ? BEGIN_REPEAT_ACK : BEGIN_RESTART;
+  }
+
+  /// Start receiving. Returns false if the window cannot be allocated.
+  bool start(const uint8_t *sender, uint16_t session, uint32_t image_size, uint16_t chunk_size) {
+    if (!this->window_.start(image_size, chunk_size))
+      return false;
+    memcpy(this->sender_, sender, ESPNOW_OTA_ADDR_LEN);
+    this->session_ = session;
+    this->since_ack_ = 0;
+    this->active_ = true;
+    this->has_result_ = false;
+    return true;
+  }
+
+  /// Whether a frame belongs to the running transfer.
+  bool matches(const uint8_t *sender, uint16_t session) const {
+    return this->active_ && session == this->session_ && memcmp(this->sender_, sender, ESPNOW_OTA_ADDR_LEN) == 0;
+  }
+
+  /// Call once a chunk is stored and the contiguous prefix written. Returns true when an ack is due: every half
+  /// window, immediately on a gap so the sender can retransmit early, and at the end.
+  bool on_stored() {
+    return ++this->since_ack_ >= ESPNOW_OTA_WINDOW / 2 || this->window_.bitmap() != 0 || this->window_.is_complete();
+  }
+  /// Call whenever an ack goes out.
+  void acked() { this->since_ack_ = 0; }
+
+  End on_end(const uint8_t *sender, uint16_t session) const {
+    if (this->matches(sender, session))
+      return this->window_.is_complete() ? END_FINISH : END_ACK;
+    if (this->has_result_ && session == this->session_ && memcmp(this->sender_, sender, ESPNOW_OTA_ADDR_LEN) == 0)
+      return END_REPEAT_RESULT;
+    return END_IGNORE;
+  }
+
+  /// End the transfer with `error` as its outcome, which is kept for repeated ENDs.
+  void finish(uint8_t error) {
+    this->abort();
+    this->result_ = error;
+    this->has_result_ = true;
+  }
+  /// End the transfer without an outcome.
+  void abort() {
+    this->window_.reset();
+    this->active_ = false;
+  }
+
+  bool is_active() const { return this->active_; }
+  const uint8_t *sender() const { return this->sender_; }
+  uint16_t session() const { return this->session_; }
+  uint8_t result() const { return this->result_; }
+  ESPNowOTAReceiveWindow &window() { return this->window_; }
+  const ESPNowOTAReceiveWindow &window() const { return this->window_; }
+
+ protected:
+  ESPNowOTAReceiveWindow window_;
+  uint8_t sender_[ESPNOW_OTA_ADDR_LEN]{0};
+  uint16_t session_{0};
+  uint8_t since_ack_{0};
+  uint8_t result_{0};
+  bool active_{false};
+  bool has_result_{false};  // sender_ and session_ name a finished transfer whose outcome is result_
+};
+
+/// Sender side of one transfer to one target: repeats BEGIN and END until answered, paces and retransmits chunks,
+/// and gives up when the target stops making progress.
+class ESPNowOTASendSession {
+ public:
+  enum Phase : uint8_t {
+    PHASE_BEGIN,
+    PHASE_DATA,
+    PHASE_END,
+    PHASE_DONE,
+    PHASE_FAILED,
+  };
+  enum Action : uint8_t {
+    ACTION_NONE,   // Nothing to send now
+    ACTION_BEGIN,  // Send BEGIN
+    ACTION_DATA,   // Send the chunks next_chunk() hands out
+    ACTION_END,    // Send END
+    ACTION_ABORT,  // No progress for ESPNOW_OTA_TARGET_TIMEOUT, send ABORT; the target has failed
+  };
+
+  /// Start the transfer; the first BEGIN is due right away.
+  void start(uint32_t now) {
+    *this = ESPNowOTASendSession{};
+    this->last_progress_ms_ = now;
+    this->last_send_ms_ = now - ESPNOW_OTA_CONTROL_INTERVAL;
+  }
+
+  /// Call from the loop while the session is not finished.
+  Action service(uint32_t now) {
+    if (this->is_finished())
+      return ACTION_NONE;
+    if (now - this->last_progress_ms_ > ESPNOW_OTA_TARGET_TIMEOUT) {
+      this->phase_ = PHASE_FAILED;
+      return ACTION_ABORT;
+    }
+    if (this->phase_ == PHASE_BEGIN || this->phase_ == PHASE_END) {
+      if (now - this->last_send_ms_ < ESPNOW_OTA_CONTROL_INTERVAL)
+        return ACTION_NONE;
+      this->last_send_ms_ = now;
+      return this->phase_ == PHASE_BEGIN ? ACTION_BEGIN : ACTION_END;
+    }
+    // Chunks that were sent but never acknowledged are presumed lost
+    if (this->window_.has_unacked() && this->in_flight_ == 0 && now - this->last_send_ms_ >= ESPNOW_OTA_ACK_TIMEOUT)
+      this->window_.expire_sent();
+    return ACTION_DATA;
+  }
+
+  /// The next chunk to send while at most ESPNOW_OTA_MAX_IN_FLIGHT are queued. Call chunk_sent() once it is queued.
+  bool next_chunk(uint32_t total_chunks, uint32_t *seq) const {
+    return this->in_flight_ < ESPNOW_OTA_MAX_IN_FLIGHT && this->window_.next(total_chunks, seq);
+  }
+  void chunk_sent(uint32_t seq, uint32_t now) {
+    this->window_.mark_sent(seq);
+    this->in_flight_++;
+    this->last_send_ms_ = now;
+  }
+  /// Call when the radio is done with a chunk, delivered or not.
+  void send_done() {
+    if (this->in_flight_ > 0)
+      this->in_flight_--;
+  }
+
+  /// Apply an ack. Returns true when every chunk is acknowledged now and END is due right away.
+  bool on_ack(uint32_t base, uint32_t bitmap, uint32_t total_chunks, uint32_t now) {
+    if (this->is_finished())
+      return false;
+    if (this->phase_ == PHASE_BEGIN)
+      this->phase_ = PHASE_DATA;
+    bool progressed;
+    if (!this->window_.on_ack(base, bitmap, &progressed))
+      return false;  // Stale ack
+    if (progressed)
+      this->last_progress_ms_ = now;
+    if (this->phase_ != PHASE_DATA || this->window_.base() < total_chunks)
+      return false;
+    this->phase_ = PHASE_END;
+    this->last_progress_ms_ = now;
+    this->last_send_ms_ = now;
+    return true;
+  }
+
+  /// Apply the target's RESULT. Returns false if the session had finished already.
+  bool on_result(bool success) {
+    if (this->is_finished())
+      return false;
+    this->phase_ = success ? PHASE_DONE : PHASE_FAILED;
+    return true;
+  }
+  void fail() { this->phase_ = PHASE_FAILED; }
+
+  Phase phase() const { return this->phase_; }
+  bool is_finished() const { return this->phase_ == PHASE_DONE || this->phase_ == PHASE_FAILED; }
+  uint32_t base() const { return this->window_.base(); }
+
+ protected:
+  ESPNowOTASendWindow window_;
+  Phase phase_{PHASE_BEGIN};
+  uint8_t in_flight_{0};
+  uint32_t last_progress_ms_{0};
+  uint32_t last_send_ms_{0};
+};
+
+}  // namespace esphome::espnow
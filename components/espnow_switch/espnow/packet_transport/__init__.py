@@ -18,12 +18,19 @@ DEPENDENCIES = ["espnow"]
 ESPNowTransport = espnow_ns.class_("ESPNowTransport", PacketTransport, PollingComponent)
 
 CONF_ESPNOW_ID = "espnow_id"
+CONF_GROUP = "group"
 CONF_PEER_ADDRESS = "peer_address"
+CONF_PEERS = "peers"
 
 CONFIG_SCHEMA = transport_schema(ESPNowTransport).extend(
     {
         cv.GenerateID(CONF_ESPNOW_ID): cv.use_id(ESPNowComponent),
-        cv.Optional(CONF_PEER_ADDRESS, default="FF:FF:FF:FF:FF:FF"): cv.mac_address,
+        # Destination of sent packets: a single peer (broadcast by default), a list of peers, or a group
+        cv.Exclusive(CONF_PEER_ADDRESS, "destination"): cv.mac_address,
+        cv.Exclusive(CONF_PEERS, "destination"): cv.All(
+            cv.ensure_list(cv.mac_address), cv.Length(min=1)
+        ),
+        cv.Exclusive(CONF_GROUP, "destination"): cv.uint8_t,
     }
 )
 
@@ -35,5 +42,9 @@ async def to_code(config):
     await cg.register_parented(var, config[CONF_ESPNOW_ID])
 
     # Set peer address - convert MAC to parts array like ESP-NOW does
-    mac = config[CONF_PEER_ADDRESS]
-    cg.add(var.set_peer_address([HexInt(x) for x in mac.parts]))
+    if mac := config.get(CONF_PEER_ADDRESS):
+        cg.add(var.set_peer_address([HexInt(x) for x in mac.parts]))
+    for mac in config.get(CONF_PEERS, []):
+        cg.add(var.add_peer([HexInt(x) for x in mac.parts]))
+    if (group := config.get(CONF_GROUP)) is not None:
+        cg.add(var.set_group(group))
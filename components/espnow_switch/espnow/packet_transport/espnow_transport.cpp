@@ -21,17 +21,33 @@ void ESPNowTransport::setup() {
     return;
   }
 
-  ESP_LOGI(TAG,
-           "Registering ESP-NOW handlers\n"
-           "Peer address: %02X:%02X:%02X:%02X:%02X:%02X",
-           this->peer_address_[0], this->peer_address_[1], this->peer_address_[2], this->peer_address_[3],
-           this->peer_address_[4], this->peer_address_[5]);
+  if (this->has_group_) {
+    ESP_LOGI(TAG, "Registering ESP-NOW handlers\nGroup: %u", this->group_);
+    // Members of the group receive our packets, so we receive theirs as well
+    this->parent_->join_group(this->group_);
+  } else if (!this->peers_.empty()) {
+    ESP_LOGI(TAG, "Registering ESP-NOW handlers\nPeers: %zu", this->peers_.size());
+    for (auto &peer : this->peers_) {
+      this->parent_->add_peer(peer.address);
+      ESP_LOGI(TAG, "  %02X:%02X:%02X:%02X:%02X:%02X", peer.address[0], peer.address[1], peer.address[2],
+               peer.address[3], peer.address[4], peer.address[5]);
+    }
+  } else {
+    ESP_LOGI(TAG,
+             "Registering ESP-NOW handlers\n"
+             "Peer address: %02X:%02X:%02X:%02X:%02X:%02X",
+             this->peer_address_[0], this->peer_address_[1], this->peer_address_[2], this->peer_address_[3],
+             this->peer_address_[4], this->peer_address_[5]);
+  }
 
   // Register received handler
   this->parent_->register_received_handler(this);
 
   // Register broadcasted handler
   this->parent_->register_broadcasted_handler(this);
+
+  // Register group handler
+  this->parent_->register_group_handler(this);
 }
 
 void ESPNowTransport::send_packet(const std::vector<uint8_t> &buf) const {
@@ -50,6 +66,43 @@ void ESPNowTransport::send_packet(const std::vector<uint8_t> &buf) const {
     return;
   }
 
+  if (this->has_group_) {
+    // One multicast frame reaches every member; it is never acknowledged, so there is nothing to track
+    esp_err_t err = this->parent_->send_group(this->group_, buf.data(), buf.size());
+    if (err != ESP_OK) {
+      ESP_LOGW(TAG, "Group send failed: %d", err);
+    }
+    return;
+  }
+
+  if (!this->peers_.empty()) {
+    // The packet was serialised once; every peer is queued from the same buffer
+    for (size_t i = 0; i < this->peers_.size(); i++) {
+      ESPNowTransportPeer &peer = this->peers_[i];
+      peer.sent++;
+      auto cb = [this, i](esp_err_t err) {
+        ESPNowTransportPeer &peer = this->peers_[i];
+        peer.last_status = err;
+        if (err == ESP_OK) {
+          peer.consecutive_failures = 0;
+          return;
+        }
+        peer.failed++;
+        if (peer.consecutive_failures < UINT8_MAX)
+          peer.consecutive_failures++;
+        // Warn on the first failure only, a peer that is gone would otherwise log on every update
+        if (peer.consecutive_failures == 1) {
+          ESP_LOGW(TAG, "Send to %02X:%02X:%02X:%02X:%02X:%02X failed: %d", peer.address[0], peer.address[1],
+                   peer.address[2], peer.address[3], peer.address[4], peer.address[5], err);
+        }
+      };
+      esp_err_t err = this->parent_->send(peer.address.data(), buf.data(), buf.size(), cb);
+      if (err != ESP_OK)
+        cb(err);  // Not queued, the callback will not run
+    }
+    return;
+  }
+
   // Send to configured peer address
   this->parent_->send(this->peer_address_.data(), buf.data(), buf.size(), [](esp_err_t err) {
     if (err != ESP_OK) {
@@ -88,6 +141,24 @@ bool ESPNowTransport::on_broadcasted(const ESPNowRecvInfo &info, const uint8_t *
   return false;  // Allow other handlers to run
 }
 
+bool ESPNowTransport::on_group(const ESPNowRecvInfo &info, uint8_t group, const uint8_t *data, uint8_t size) {
+  if (!this->has_group_ || group != this->group_)
+    return false;  // Another group this node joined for something else
+  ESP_LOGV(TAG, "Received group %u packet of size %u from %02X:%02X:%02X:%02X:%02X:%02X", group, size,
+           info.src_addr[0], info.src_addr[1], info.src_addr[2], info.src_addr[3], info.src_addr[4],
+           info.src_addr[5]);
+
+  if (data == nullptr || size == 0) {
+    ESP_LOGW(TAG, "Received empty or null group packet");
+    return false;
+  }
+
+  this->packet_buffer_.resize(size);
+  memcpy(this->packet_buffer_.data(), data, size);
+  this->process_(this->packet_buffer_);
+  return false;  // Allow other handlers to run
+}
+
 }  // namespace espnow
 }  // namespace esphome
 
@@ -12,10 +12,20 @@
 namespace esphome {
 namespace espnow {
 
+/// Delivery statistics of one peer of a fan-out transport
+struct ESPNowTransportPeer {
+  peer_address_t address{};
+  uint32_t sent{0};
+  uint32_t failed{0};
+  uint8_t consecutive_failures{0};
+  esp_err_t last_status{ESP_OK};
+};
+
 class ESPNowTransport : public packet_transport::PacketTransport,
                         public Parented<ESPNowComponent>,
                         public ESPNowReceivedPacketHandler,
-                        public ESPNowBroadcastedHandler {
+                        public ESPNowBroadcastedHandler,
+                        public ESPNowGroupHandler {
  public:
   void setup() override;
   float get_setup_priority() const override { return setup_priority::AFTER_WIFI; }
@@ -23,17 +33,37 @@ class ESPNowTransport : public packet_transport::PacketTransport,
   void set_peer_address(peer_address_t address) {
     memcpy(this->peer_address_.data(), address.data(), ESP_NOW_ETH_ALEN);
   }
+  /// Send every packet to each of these peers instead of the single peer address
+  void add_peer(peer_address_t address) {
+    ESPNowTransportPeer peer;
+    peer.address = address;
+    this->peers_.push_back(peer);
+  }
+  /// Send every packet once to the members of a group instead of the single peer address
+  void set_group(uint8_t group) {
+    this->group_ = group;
+    this->has_group_ = true;
+  }
+
+  const std::vector<ESPNowTransportPeer> &get_peers() const { return this->peers_; }
 
   // ESPNow handler interface
   bool on_received(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) override;
   bool on_broadcasted(const ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) override;
+  bool on_group(const ESPNowRecvInfo &info, uint8_t group, const uint8_t *data, uint8_t size) override;
 
  protected:
   void send_packet(const std::vector<uint8_t> &buf) const override;
-  size_t get_max_packet_size() override { return ESP_NOW_MAX_DATA_LEN; }
+  size_t get_max_packet_size() override {
+    return this->has_group_ ? ESPNOW_GROUP_MAX_PAYLOAD : ESP_NOW_MAX_DATA_LEN;
+  }
   bool should_send() override;
 
   peer_address_t peer_address_{{0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}};
+  // Updated from send callbacks, which send_packet() const has to register
+  mutable std::vector<ESPNowTransportPeer> peers_{};
+  uint8_t group_{0};
+  bool has_group_{false};
   std::vector<uint8_t> packet_buffer_;
 };
 
@@ -0,0 +1,76 @@
+"""ESP-NOW link quality sensors."""
+
+import esphome.codegen as cg
+from esphome.components import sensor
+import esphome.config_validation as cv
+from esphome.const import (
+    CONF_ADDRESS,
+    CONF_ID,
+    DEVICE_CLASS_SIGNAL_STRENGTH,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    UNIT_DECIBEL,
+    UNIT_DECIBEL_MILLIWATT,
+    UNIT_PERCENT,
+)
+from esphome.core import HexInt
+
+from .. import ESPNowComponent, espnow_ns
+
+DEPENDENCIES = ["espnow"]
+
+ESPNowLinkSensor = espnow_ns.class_("ESPNowLinkSensor", cg.PollingComponent)
+
+CONF_ESPNOW_ID = "espnow_id"
+CONF_ETX = "etx"
+CONF_DELIVERY_RATIO = "delivery_ratio"
+CONF_RSSI = "rssi"
+CONF_RSSI_TREND = "rssi_trend"
+
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(ESPNowLinkSensor),
+        cv.GenerateID(CONF_ESPNOW_ID): cv.use_id(ESPNowComponent),
+        cv.Required(CONF_ADDRESS): cv.mac_address,
+        # Expected transmissions per delivered frame, 1.0 on a perfect link
+        cv.Optional(CONF_ETX): sensor.sensor_schema(
+            icon="mdi:swap-horizontal",
+            accuracy_decimals=2,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_DELIVERY_RATIO): sensor.sensor_schema(
+            unit_of_measurement=UNIT_PERCENT,
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_RSSI): sensor.sensor_schema(
+            unit_of_measurement=UNIT_DECIBEL_MILLIWATT,
+            accuracy_decimals=1,
+            device_class=DEVICE_CLASS_SIGNAL_STRENGTH,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        # Fast minus slow RSSI average, negative while the link degrades
+        cv.Optional(CONF_RSSI_TREND): sensor.sensor_schema(
+            unit_of_measurement=UNIT_DECIBEL,
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+    }
+).extend(cv.polling_component_schema("60s"))
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+    await cg.register_parented(var, config[CONF_ESPNOW_ID])
+
+    cg.add(var.set_address([HexInt(x) for x in config[CONF_ADDRESS].parts]))
+
+    for key in (CONF_ETX, CONF_DELIVERY_RATIO, CONF_RSSI, CONF_RSSI_TREND):
+        if key in config:
+            sens = await sensor.new_sensor(config[key])
+            cg.add(getattr(var, f"set_{key}_sensor")(sens))
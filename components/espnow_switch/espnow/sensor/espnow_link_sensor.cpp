@@ -0,0 +1,38 @@
+#include "espnow_link_sensor.h"
+
+#ifdef USE_ESP32
+
+#include "esphome/core/log.h"
+
+namespace esphome::espnow {
+
+static constexpr const char *TAG = "espnow.sensor";
+
+void ESPNowLinkSensor::update() {
+  const ESPNowLinkQuality *link = this->parent_->get_link_quality(this->address_);
+  if (link == nullptr)
+    return;  // No traffic with the peer yet
+  if (this->etx_sensor_ != nullptr)
+    this->etx_sensor_->publish_state(link->get_etx());
+  if (this->delivery_ratio_sensor_ != nullptr)
+    this->delivery_ratio_sensor_->publish_state(link->delivery_ratio * 100.0f);
+  if (this->rssi_sensor_ != nullptr)
+    this->rssi_sensor_->publish_state(link->rssi);
+  if (this->rssi_trend_sensor_ != nullptr)
+    this->rssi_trend_sensor_->publish_state(link->get_rssi_trend());
+}
+
+void ESPNowLinkSensor::dump_config() {
+  char addr_buf[MAC_ADDRESS_PRETTY_BUFFER_SIZE];
+  format_mac_addr_upper(this->address_, addr_buf);
+  ESP_LOGCONFIG(TAG, "ESP-NOW link to %s:", addr_buf);
+  LOG_UPDATE_INTERVAL(this);
+  LOG_SENSOR("  ", "ETX", this->etx_sensor_);
+  LOG_SENSOR("  ", "Delivery ratio", this->delivery_ratio_sensor_);
+  LOG_SENSOR("  ", "RSSI", this->rssi_sensor_);
+  LOG_SENSOR("  ", "RSSI trend", this->rssi_trend_sensor_);
+}
+
+}  // namespace esphome::espnow
+
+#endif  // USE_ESP32
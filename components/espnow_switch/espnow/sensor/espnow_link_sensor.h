@@ -0,0 +1,35 @@
+#pragma once
+
+#include "../espnow_component.h"
+
+#ifdef USE_ESP32
+
+#include "esphome/components/sensor/sensor.h"
+#include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+
+namespace esphome::espnow {
+
+/// Publishes the link quality estimate of one peer, see ESPNowLinkQuality
+class ESPNowLinkSensor : public PollingComponent, public Parented<ESPNowComponent> {
+ public:
+  void update() override;
+  void dump_config() override;
+
+  void set_address(peer_address_t address) { memcpy(this->address_, address.data(), ESP_NOW_ETH_ALEN); }
+  void set_etx_sensor(sensor::Sensor *sensor) { this->etx_sensor_ = sensor; }
+  void set_delivery_ratio_sensor(sensor::Sensor *sensor) { this->delivery_ratio_sensor_ = sensor; }
+  void set_rssi_sensor(sensor::Sensor *sensor) { this->rssi_sensor_ = sensor; }
+  void set_rssi_trend_sensor(sensor::Sensor *sensor) { this->rssi_trend_sensor_ = sensor; }
+
+ protected:
+  uint8_t address_[ESP_NOW_ETH_ALEN]{0};
+  sensor::Sensor *etx_sensor_{nullptr};
+  sensor::Sensor *delivery_ratio_sensor_{nullptr};
+  sensor::Sensor *rssi_sensor_{nullptr};
+  sensor::Sensor *rssi_trend_sensor_{nullptr};
+};
+
+}  // namespace esphome::espnow
+
+#endif  // USE_ESP32
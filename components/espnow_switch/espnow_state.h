@@ -0,0 +1,31 @@
+#pragma once
+
+#include "esphome/components/espnow/espnow_frame.h"
+#include <cstdint>
+
+namespace esphome {
+namespace espnow_switch {
+
+// 状态同步协议的消息类型
+enum ESPNowStateOpcode : uint8_t {
+  // 控制端 -> 设备：设置状态，version 字段为控制端的命令序号
+  STATE_OPCODE_COMMAND = 1,
+  // 设备 -> 控制端：设备的真实状态，状态变化时主动推送
+  STATE_OPCODE_REPORT = 2,
+  // 控制端 -> 设备：订阅状态，设备立即回复一次 REPORT
+  STATE_OPCODE_SUBSCRIBE = 3,
+};
+
+// 紧凑的状态消息（ESPNOW_FRAME_STATE 帧），共 13 字节
+struct __attribute__((packed)) ESPNowStateFrame {
+  espnow::ESPNowFrameHeader frame;
+  uint8_t opcode;     // ESPNowStateOpcode
+  uint16_t state_id;  // 设备上的实体编号
+  uint16_t epoch;     // 设备每次启动随机生成，用于识别重启后版本号归零
+  uint16_t version;   // REPORT：状态版本号，每次状态变化递增；COMMAND：命令序号
+  uint16_t command;   // REPORT：该控制端最近一次已执行的命令序号
+  uint8_t state;      // 0 = OFF, 1 = ON
+};
+
+}  // namespace espnow_switch
+}  // namespace esphome
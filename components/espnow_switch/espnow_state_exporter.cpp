@@ -0,0 +1,144 @@
+#include "espnow_state_exporter.h"
+#include "esphome/core/log.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+
+#include <cstring>
+
+namespace esphome {
+namespace espnow_switch {
+
+static const char *const TAG = "espnow_switch.state";
+
+void ESPNowStateExporter::setup() {
+  // 每次启动使用新的 epoch，控制端据此接受归零后的版本号
+  do {
+    this->epoch_ = static_cast<uint16_t>(random_uint32());
+  } while (this->epoch_ == 0);
+
+  for (auto &address : this->initial_subscribers_) {
+    this->espnow_->add_peer(address);
+    this->find_or_add_subscriber_(address.data());
+  }
+
+  this->switch_->add_on_state_callback([this](bool state) {
+    this->version_++;
+    this->mark_dirty_();
+  });
+  this->espnow_->register_frame_handler(espnow::ESPNOW_FRAME_STATE, this);
+}
+
+void ESPNowStateExporter::dump_config() {
+  ESP_LOGCONFIG(TAG, "ESPNow State Exporter:");
+  ESP_LOGCONFIG(TAG, "  Switch: %s", this->switch_->get_name().c_str());
+  ESP_LOGCONFIG(TAG, "  State ID: %u", this->state_id_);
+  for (size_t i = 0; i < this->num_subscribers_; i++) {
+    const uint8_t *mac = this->subscribers_[i].address;
+    ESP_LOGCONFIG(TAG, "  Subscriber: %02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+  }
+}
+
+ESPNowStateExporter::Subscriber *ESPNowStateExporter::find_or_add_subscriber_(const uint8_t *address) {
+  for (size_t i = 0; i < this->num_subscribers_; i++) {
+    if (memcmp(this->subscribers_[i].address, address, ESP_NOW_ETH_ALEN) == 0)
+      return &this->subscribers_[i];
+  }
+  if (this->num_subscribers_ >= MAX_STATE_SUBSCRIBERS) {
+    ESP_LOGW(TAG, "Too many subscribers, ignoring %02X:%02X:%02X:%02X:%02X:%02X", address[0], address[1], address[2],
+             address[3], address[4], address[5]);
+    return nullptr;
+  }
+  Subscriber &subscriber = this->subscribers_[this->num_subscribers_++];
+  subscriber = Subscriber{};
+  memcpy(subscriber.address, address, ESP_NOW_ETH_ALEN);
+  // 新订阅者立即获得一次当前状态
+  subscriber.dirty = true;
+  return &subscriber;
+}
+
+void ESPNowStateExporter::mark_dirty_() {
+  for (size_t i = 0; i < this->num_subscribers_; i++) {
+    this->subscribers_[i].dirty = true;
+  }
+}
+
+void ESPNowStateExporter::on_frame(const espnow::ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) {
+  if (size < sizeof(ESPNowStateFrame))
+    return;
+  ESPNowStateFrame frame;
+  memcpy(&frame, data, sizeof(frame));
+  if (frame.state_id != this->state_id_)
+    return;
+  if (frame.opcode != STATE_OPCODE_COMMAND && frame.opcode != STATE_OPCODE_SUBSCRIBE)
+    return;
+
+  Subscriber *subscriber = this->find_or_add_subscriber_(info.src_addr);
+  if (subscriber == nullptr)
+    return;
+  if (frame.opcode == STATE_OPCODE_SUBSCRIBE) {
+    subscriber->dirty = true;
+    return;
+  }
+
+  // 重发的命令只需重新确认，不再执行
+  if (frame.version != subscriber->last_command) {
+    subscriber->last_command = frame.version;
+    ESP_LOGD(TAG, "Command %u: turning %s", frame.version, frame.state ? "ON" : "OFF");
+    if (frame.state) {
+      this->switch_->turn_on();
+    } else {
+      this->switch_->turn_off();
+    }
+  }
+  // 状态未变化时回调不会触发，仍需回复以确认命令
+  subscriber->dirty = true;
+}
+
+void ESPNowStateExporter::send_report_(Subscriber &subscriber) {
+  ESPNowStateFrame frame{};
+  frame.frame.init(espnow::ESPNOW_FRAME_STATE);
+  frame.opcode = STATE_OPCODE_REPORT;
+  frame.state_id = this->state_id_;
+  frame.epoch = this->epoch_;
+  frame.version = this->version_;
+  frame.command = subscriber.last_command;
+  frame.state = this->switch_->state ? 1 : 0;
+
+  subscriber.dirty = false;
+  subscriber.in_flight = true;
+  subscriber.last_send_ms = millis();
+  const uint8_t *address = subscriber.address;
+  auto cb = [&subscriber](esp_err_t status) {
+    subscriber.in_flight = false;
+    // 被更新的状态取代时无需处理；送达失败则稍后重发
+    subscriber.failed = status != ESP_OK && status != espnow::ESP_ERR_ESPNOW_SUPERSEDED;
+    if (subscriber.failed)
+      subscriber.dirty = true;
+  };
+
+  // 只有最新状态有意义，同一订阅者排队中的旧状态会被取代
+  espnow::ESPNowSendOptions options;
+  options.supersede_key = (static_cast<uint32_t>(this->state_id_) << 1) | 1;
+  esp_err_t result = this->espnow_->send(address, reinterpret_cast<const uint8_t *>(&frame), sizeof(frame), cb, options);
+  if (result != ESP_OK) {
+    subscriber.in_flight = false;
+    subscriber.failed = true;
+    subscriber.dirty = true;
+  }
+}
+
+void ESPNowStateExporter::loop() {
+  const uint32_t now = millis();
+  for (size_t i = 0; i < this->num_subscribers_; i++) {
+    Subscriber &subscriber = this->subscribers_[i];
+    if (!subscriber.dirty || subscriber.in_flight)
+      continue;
+    // 状态变化立即推送，失败后按间隔重发
+    if (subscriber.failed && now - subscriber.last_send_ms < this->retry_interval_)
+      continue;
+    this->send_report_(subscriber);
+  }
+}
+
+}  // namespace espnow_switch
+}  // namespace esphome
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/components/switch/switch.h"
+#include "esphome/components/espnow/espnow_component.h"
+#include "espnow_state.h"
+#include <array>
+
+namespace esphome {
+namespace espnow_switch {
+
+// 每个导出实体最多记录的订阅者数量
+static constexpr size_t MAX_STATE_SUBSCRIBERS = 4;
+
+// 设备端：将本地开关的真实状态推送给订阅的控制端，并执行控制端的命令
+class ESPNowStateExporter : public Component, public espnow::ESPNowFrameHandler {
+ public:
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::AFTER_WIFI; }
+
+  void set_espnow_component(espnow::ESPNowComponent *espnow) { this->espnow_ = espnow; }
+  void set_switch(switch_::Switch *sw) { this->switch_ = sw; }
+  void set_state_id(uint16_t state_id) { this->state_id_ = state_id; }
+  void set_retry_interval(uint32_t interval) { this->retry_interval_ = interval; }
+  // 预先配置的订阅者，无需先收到订阅请求
+  void add_subscriber(espnow::peer_address_t address) { this->initial_subscribers_.push_back(address); }
+
+  void on_frame(const espnow::ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) override;
+
+ protected:
+  struct Subscriber {
+    uint8_t address[ESP_NOW_ETH_ALEN]{0};
+    uint16_t last_command{0};  // 最近一次执行的命令序号，用于识别重发的命令
+    bool dirty{false};         // 有未送达的状态
+    bool in_flight{false};
+    bool failed{false};        // 上次发送失败，按重试间隔重发
+    uint32_t last_send_ms{0};
+  };
+
+  Subscriber *find_or_add_subscriber_(const uint8_t *address);
+  void mark_dirty_();
+  void send_report_(Subscriber &subscriber);
+
+  espnow::ESPNowComponent *espnow_{nullptr};
+  switch_::Switch *switch_{nullptr};
+  uint16_t state_id_{0};
+  uint32_t retry_interval_{500};
+
+  std::vector<espnow::peer_address_t> initial_subscribers_{};
+  std::array<Subscriber, MAX_STATE_SUBSCRIBERS> subscribers_{};
+  size_t num_subscribers_{0};
+
+  uint16_t epoch_{0};
+  uint16_t version_{0};
+};
+
+}  // namespace espnow_switch
+}  // namespace esphome
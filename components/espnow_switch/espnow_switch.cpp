@@ -2,6 +2,7 @@
 #include "esphome/core/log.h"
 #include "esphome/core/hal.h"
 #include "esphome/core/application.h"
+#include "esphome/core/helpers.h"
 
 namespace esphome {
 namespace espnow_switch {
@@ -10,7 +11,16 @@ static const char *const TAG = "espnow_switch";
 
 void ESPNowSwitch::setup() {
   ESP_LOGCONFIG(TAG, "Setting up ESPNow Switch...");
-  // 无需在 C++ 层注册广播回调；依赖乐观状态与重试发送
+  // 监测对端存活（可选）：对端离线时命令立即失败，而不是耗尽全部重试
+  if (this->monitor_peer_)
+    this->espnow_->monitor_peer(this->mac_address_);
+  if (this->protocol_ == PROTOCOL_STATE_SYNC) {
+    // 随机起始编号，避免重启后与设备记录的最近命令编号重合而被当作重发
+    this->command_id_ = static_cast<uint16_t>(random_uint32());
+    this->espnow_->register_frame_handler(espnow::ESPNOW_FRAME_STATE, this);
+    this->subscribe_pending_ = true;
+  }
+  // 旧协议无需在 C++ 层注册广播回调；依赖乐观状态与重试发送
 }
 
 void ESPNowSwitch::dump_config() {
@@ -19,9 +29,16 @@ void ESPNowSwitch::dump_config() {
   ESP_LOGCONFIG(TAG, "  MAC Address: %02X:%02X:%02X:%02X:%02X:%02X", 
                 this->mac_address_[0], this->mac_address_[1], this->mac_address_[2],
                 this->mac_address_[3], this->mac_address_[4], this->mac_address_[5]);
-  ESP_LOGCONFIG(TAG, "  Response Token: %s", this->response_token_.c_str());
-  ESP_LOGCONFIG(TAG, "  Retry Count: %d", this->retry_count_);
-  ESP_LOGCONFIG(TAG, "  Retry Interval: %dms", this->retry_interval_);
+  if (this->protocol_ == PROTOCOL_STATE_SYNC) {
+    ESP_LOGCONFIG(TAG, "  Protocol: state sync");
+    ESP_LOGCONFIG(TAG, "  State ID: %u", this->state_id_);
+  } else {
+    ESP_LOGCONFIG(TAG, "  Protocol: legacy");
+    ESP_LOGCONFIG(TAG, "  Response Token: %s", this->response_token_.c_str());
+  }
+  ESP_LOGCONFIG(TAG, "  Retry Count: %d", this->command_.get_retry_count());
+  ESP_LOGCONFIG(TAG, "  Retry Interval: %dms", this->command_.get_retry_interval());
+  ESP_LOGCONFIG(TAG, "  Monitor Peer: %s", YESNO(this->monitor_peer_));
 }
 
 void ESPNowSwitch::write_state(bool state) {
@@ -30,56 +47,101 @@ void ESPNowSwitch::write_state(bool state) {
   // 设置命令：1 = ON, 0 = OFF
   std::string cmd = state ? "1" : "0";
   this->current_command_ = cmd;
-  // 初始化重试状态（非阻塞）
-  this->response_received_ = false;
-  this->attempts_sent_ = 0;
-  this->pending_send_ = true;
-  this->send_in_flight_ = false;
-  this->last_send_ms_ = 0;
+  // 初始化重试状态（非阻塞）；未确认的上一条命令记为被取代，其仍在队列中的发送会被替换，回调按序号忽略
+  this->command_.start(micros());
+  if (++this->command_id_ == 0)
+    this->command_id_ = 1;
   // 立即尝试发送一次（后续重试由 loop() 节流）
   this->send_command_(cmd);
 
-  // 发布状态（乐观模式）
-  this->publish_state(state);
+  // 旧协议乐观发布状态；状态同步协议等待设备推送真实状态
+  if (this->protocol_ == PROTOCOL_LEGACY)
+    this->publish_state(state);
 }
 
 void ESPNowSwitch::send_command_(const std::string &cmd) {
   // 单次发送，不阻塞；使用回调节流（只允许一个 in-flight）
-  if (this->send_in_flight_) {
+  if (this->command_.is_in_flight()) {
     return;
   }
 
-  // 获取当前 WiFi 信道
-  int channel = this->espnow_->get_wifi_channel();
-
-  // 构建消息格式: MAC-ADDRESS=CMD;ch=CHANNEL;
   char data[64];
-  snprintf(data, sizeof(data), "%02X%02X-%02X%02X-%02X%02X=%s;ch=%d;",
-           this->mac_address_[0], this->mac_address_[1],
-           this->mac_address_[2], this->mac_address_[3],
-           this->mac_address_[4], this->mac_address_[5],
-           cmd.c_str(), channel);
+  size_t payload_len;
+  std::string description;
+  if (this->protocol_ == PROTOCOL_STATE_SYNC) {
+    // 二进制命令帧：命令编号 + 目标状态
+    ESPNowStateFrame frame{};
+    frame.frame.init(espnow::ESPNOW_FRAME_STATE);
+    frame.opcode = STATE_OPCODE_COMMAND;
+    frame.state_id = this->state_id_;
+    frame.version = this->command_id_;
+    frame.state = cmd == "1" ? 1 : 0;
+    memcpy(data, &frame, sizeof(frame));
+    payload_len = sizeof(frame);
+    description = str_sprintf("command %u=%s", this->command_id_, cmd.c_str());
+  } else {
+    // 获取当前 WiFi 信道
+    int channel = this->espnow_->get_wifi_channel();
+
+    // 构建消息格式: MAC-ADDRESS=CMD;ch=CHANNEL;
+    snprintf(data, sizeof(data), "%02X%02X-%02X%02X-%02X%02X=%s;ch=%d;",
+             this->mac_address_[0], this->mac_address_[1],
+             this->mac_address_[2], this->mac_address_[3],
+             this->mac_address_[4], this->mac_address_[5],
+             cmd.c_str(), channel);
+    payload_len = strlen(data);
+    description = data;
+  }
 
   // 发送 ESPNow 消息（避免每次重试都分配 vector，减少 heap 压力）
-  this->send_in_flight_ = true;
-  this->last_send_ms_ = millis();
-  this->attempts_sent_++;
-  const size_t payload_len = strlen(data);
+  this->command_.sent(millis());
 
-  auto cb = [this, data_str = std::string(data)](esp_err_t status) {
-    this->send_in_flight_ = false;
+  const uint32_t seq = this->command_.get_seq();
+  auto cb = [this, seq, data_str = std::move(description)](esp_err_t status) {
+    // 被更新的命令取代，或属于已过时的命令，不影响当前重试状态
+    if (status == espnow::ESP_ERR_ESPNOW_SUPERSEDED || !this->command_.send_done(seq))
+      return;
+    if (status == espnow::ESP_ERR_ESPNOW_PEER_DOWN) {
+      // 对端在排队期间被判定离线，剩余的重试不会成功
+      ESP_LOGW(TAG, "Peer went down, giving up after %d attempts", this->command_.get_attempts());
+      this->complete_command_(false);
+      return;
+    }
+    if (status == espnow::ESP_ERR_ESPNOW_PEER_QUARANTINED) {
+      // shed 模式下对端在排队期间被隔离，队列中的命令以此状态结束
+      ESP_LOGW(TAG, "Peer was quarantined, giving up after %d attempts", this->command_.get_attempts());
+      this->complete_command_(false);
+      return;
+    }
     if (status == ESP_OK) {
-      ESP_LOGV(TAG, "ESPNow message sent (attempt %d/%d): %s", this->attempts_sent_, this->retry_count_, data_str.c_str());
+      ESP_LOGV(TAG, "ESPNow message sent (attempt %d/%d): %s", this->command_.get_attempts(),
+               this->command_.get_retry_count(), data_str.c_str());
     } else {
-      ESP_LOGW(TAG, "Failed to send ESPNow message (attempt %d/%d): %s", this->attempts_sent_, this->retry_count_, esp_err_to_name(status));
+      ESP_LOGW(TAG, "Failed to send ESPNow message (attempt %d/%d): %s", this->command_.get_attempts(),
+               this->command_.get_retry_count(), esp_err_to_name(status));
     }
   };
 
-  esp_err_t result = this->espnow_->send(this->mac_address_, (const uint8_t *) data, payload_len, cb);
-  if (result != ESP_OK) {
+  // 同一开关的命令使用相同的取代键（最新值优先）；排队超过重试间隔的命令直接丢弃，由下一次重试重新发送
+  espnow::ESPNowSendOptions options;
+  options.supersede_key = this->get_object_id_hash() | 1;
+  options.timeout_ms = this->command_.get_retry_interval();
+  esp_err_t result = this->espnow_->send(this->mac_address_, (const uint8_t *) data, payload_len, cb, options);
+  if (result == espnow::ESP_ERR_ESPNOW_PEER_QUARANTINED) {
+    // 对端已被隔离（连续发送失败），停止重试，避免占用发送队列
+    this->command_.send_rejected();
+    this->complete_command_(false);
+    ESP_LOGW(TAG, "Peer is quarantined, giving up after %d attempts", this->command_.get_attempts());
+  } else if (result == espnow::ESP_ERR_ESPNOW_PEER_DOWN) {
+    // 存活检测已判定对端离线，立即失败，不再耗费数秒重试
+    this->command_.send_rejected();
+    this->complete_command_(false);
+    ESP_LOGW(TAG, "Peer is down, giving up after %d attempts", this->command_.get_attempts());
+  } else if (result != ESP_OK) {
     // send() 没有入队成功，回调不会触发，手动释放 in-flight
-    this->send_in_flight_ = false;
-    ESP_LOGW(TAG, "ESPNow send() failed immediately (attempt %d/%d): %s", this->attempts_sent_, this->retry_count_, esp_err_to_name(result));
+    this->command_.send_rejected();
+    ESP_LOGW(TAG, "ESPNow send() failed immediately (attempt %d/%d): %s", this->command_.get_attempts(),
+             this->command_.get_retry_count(), esp_err_to_name(result));
   }
 }
 
@@ -90,31 +152,74 @@ void ESPNowSwitch::on_espnow_broadcast(const uint8_t *data, size_t len) {
   // 检查响应中是否包含我们的匹配令牌
   if (response.find(this->response_token_) != std::string::npos) {
     ESP_LOGI(TAG, "Response received (matched token): %s", this->response_token_.c_str());
-    this->response_received_ = true;
-    this->pending_send_ = false;
+    this->complete_command_(true);
   }
 }
 
-void ESPNowSwitch::loop() {
-  if (!this->pending_send_)
+void ESPNowSwitch::complete_command_(bool success) {
+  const uint32_t now_us = micros();
+  if (!this->command_.complete(success, now_us) || !success)
     return;
-  if (this->response_received_) {
-    this->pending_send_ = false;
+  ESP_LOGD(TAG, "Command confirmed in %.1fms after %d attempts", (now_us - this->command_.get_start_us()) / 1000.0f,
+           this->command_.get_attempts());
+}
+
+void ESPNowSwitch::send_subscribe_() {
+  ESPNowStateFrame frame{};
+  frame.frame.init(espnow::ESPNOW_FRAME_STATE);
+  frame.opcode = STATE_OPCODE_SUBSCRIBE;
+  frame.state_id = this->state_id_;
+  this->subscribe_attempts_++;
+  this->last_subscribe_ms_ = millis();
+  this->espnow_->send(this->mac_address_, reinterpret_cast<const uint8_t *>(&frame), sizeof(frame));
+}
+
+void ESPNowSwitch::on_frame(const espnow::ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) {
+  if (size < sizeof(ESPNowStateFrame) || memcmp(info.src_addr, this->mac_address_, 6) != 0)
     return;
-  }
-  if (this->attempts_sent_ >= this->retry_count_) {
-    ESP_LOGW(TAG, "No response received after %d attempts", this->retry_count_);
-    this->pending_send_ = false;
+  ESPNowStateFrame frame;
+  memcpy(&frame, data, sizeof(frame));
+  if (frame.opcode != STATE_OPCODE_REPORT || frame.state_id != this->state_id_)
     return;
-  }
-  // 若上一次发送仍在进行，等待回调释放
-  if (this->send_in_flight_) {
+  this->subscribe_pending_ = false;
+
+  // 设备已执行当前命令：立即停止重试
+  const bool acked = this->command_.is_pending() && frame.command == this->command_id_;
+  if (acked)
+    this->complete_command_(true);
+  // 仅接受更新的版本（设备重启后 epoch 改变，版本号重新计数）
+  const bool newer = !this->have_state_ || frame.epoch != this->last_epoch_ ||
+                     static_cast<int16_t>(frame.version - this->last_version_) > 0;
+  if (!newer && !acked)
     return;
+  this->have_state_ = true;
+  this->last_epoch_ = frame.epoch;
+  this->last_version_ = frame.version;
+  ESP_LOGV(TAG, "State report v%u: %s", frame.version, frame.state ? "ON" : "OFF");
+  this->publish_state(frame.state != 0);
+}
+
+void ESPNowSwitch::loop() {
+  if (this->subscribe_pending_ && !this->command_.is_pending() && !this->espnow_->is_disabled()) {
+    uint32_t now = millis();
+    if (this->subscribe_attempts_ >= this->command_.get_retry_count()) {
+      ESP_LOGW(TAG, "No state report after %d subscribe attempts", this->subscribe_attempts_);
+      this->subscribe_pending_ = false;
+    } else if (this->last_subscribe_ms_ == 0 || now - this->last_subscribe_ms_ >= this->command_.get_retry_interval()) {
+      this->send_subscribe_();
+    }
   }
-  // 间隔到达后再重试
-  uint32_t now = millis();
-  if (this->last_send_ms_ == 0 || now - this->last_send_ms_ >= this->retry_interval_) {
-    this->send_command_(this->current_command_);
+  switch (this->command_.poll(millis())) {
+    case ESPNowSwitchCommand::ACTION_GIVE_UP:
+      ESP_LOGW(TAG, "No response received after %d attempts", this->command_.get_attempts());
+      this->complete_command_(false);
+      break;
+    case ESPNowSwitchCommand::ACTION_SEND:
+      // 上一次发送的回调已释放，且重试间隔已到
+      this->send_command_(this->current_command_);
+      break;
+    default:
+      break;
   }
 }
 
@@ -3,12 +3,21 @@
 #include "esphome/core/component.h"
 #include "esphome/components/switch/switch.h"
 #include "esphome/components/espnow/espnow_component.h"
+#include "espnow_state.h"
+#include "espnow_switch_command.h"
 #include <string>
 
 namespace esphome {
 namespace espnow_switch {
 
-class ESPNowSwitch : public switch_::Switch, public Component {
+enum ESPNowSwitchProtocol : uint8_t {
+  // 文本命令，乐观发布状态，收到包含令牌的广播即视为成功
+  PROTOCOL_LEGACY,
+  // 二进制命令帧，状态以设备推送的真实状态为准（见 ESPNowStateExporter）
+  PROTOCOL_STATE_SYNC,
+};
+
+class ESPNowSwitch : public switch_::Switch, public Component, public espnow::ESPNowFrameHandler {
  public:
   void setup() override;
   void dump_config() override;
@@ -31,32 +40,54 @@ class ESPNowSwitch : public switch_::Switch, public Component {
   void set_response_token(const std::string &token) { this->response_token_ = token; }
   
   // 设置重试参数
-  void set_retry_count(uint8_t count) { this->retry_count_ = count; }
-  void set_retry_interval(uint32_t interval) { this->retry_interval_ = interval; }
+  void set_retry_count(uint8_t count) { this->command_.set_retry(count, this->command_.get_retry_interval()); }
+  void set_retry_interval(uint32_t interval) { this->command_.set_retry(this->command_.get_retry_count(), interval); }
+
+  // 设置协议与设备上的实体编号（仅状态同步协议使用）
+  void set_protocol(ESPNowSwitchProtocol protocol) { this->protocol_ = protocol; }
+  void set_state_id(uint16_t state_id) { this->state_id_ = state_id; }
+  // 是否通过心跳监测对端存活（离线时命令立即失败）
+  void set_monitor_peer(bool monitor) { this->monitor_peer_ = monitor; }
   
   // 接收响应的回调
   void on_espnow_broadcast(const uint8_t *data, size_t len);
   // 供 YAML on_broadcast 调用以停止重试
   void handle_broadcast(const uint8_t *data, size_t len) { this->on_espnow_broadcast(data, len); }
+  // 接收设备推送的状态（状态同步协议）
+  void on_frame(const espnow::ESPNowRecvInfo &info, const uint8_t *data, uint8_t size) override;
+
+  // 命令延迟与尝试次数统计（write_state 到确认响应）
+  const ESPNowSwitchStats &get_stats() const { return this->command_.get_stats(); }
+  void reset_stats() { this->command_.reset_stats(); }
 
  protected:
   void write_state(bool state) override;
   void send_command_(const std::string &cmd);
+  void send_subscribe_();
+  // 当前命令结束：成功（收到确认）或失败（重试耗尽、对端被隔离）
+  void complete_command_(bool success);
   
   espnow::ESPNowComponent *espnow_{nullptr};
   uint8_t mac_address_[6];
   std::string response_token_;
-  uint8_t retry_count_{12};
-  uint32_t retry_interval_{300};
+  bool monitor_peer_{false};
   
-  bool response_received_{false};
   std::string current_command_;
-  bool pending_send_{false};
-  uint8_t attempts_sent_{0};
-  uint32_t last_send_ms_{0};
+  // 当前命令的重试、确认与统计；同一时刻只允许一次发送在途
+  ESPNowSwitchCommand command_{};
 
-  // Throttle: only one send in-flight at a time (callback clears)
-  bool send_in_flight_{false};
+  ESPNowSwitchProtocol protocol_{PROTOCOL_LEGACY};
+  uint16_t state_id_{0};
+  // 状态同步：发往设备的命令编号，设备在 REPORT 中回显
+  uint16_t command_id_{0};
+  // 状态同步：最近接受的设备状态版本
+  bool have_state_{false};
+  uint16_t last_epoch_{0};
+  uint16_t last_version_{0};
+  // 状态同步：启动后订阅，直到收到第一次 REPORT
+  bool subscribe_pending_{false};
+  uint8_t subscribe_attempts_{0};
+  uint32_t last_subscribe_ms_{0};
 };
 
 }  // namespace espnow_switch
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "espnow_switch_stats.h"
+#include <cstdint>
+
+namespace esphome {
+namespace espnow_switch {
+
+// 单条开关命令的重试与确认状态机：不依赖 ESPHome 与 ESP-IDF，可在主机上基准测试（见 tests/espnow_switch）
+// 调用方提供时间戳；同一时刻只允许一次发送在途，回调释放后才按重试间隔再次发送
+class ESPNowSwitchCommand {
+ public:
+  enum Action : uint8_t {
+    ACTION_NONE,     // 等待回调、确认或重试间隔
+    ACTION_SEND,     // 发送（或重发）当前命令，入队后调用 sent()
+    ACTION_GIVE_UP,  // 重试耗尽且最后一次发送也已等满一个间隔，调用 complete(false)
+  };
+
+  void set_retry(uint8_t count, uint32_t interval_ms) {
+    this->retry_count_ = count;
+    this->retry_interval_ms_ = interval_ms;
+  }
+
+  // 开始新命令，返回其序号；未确认的旧命令记为被取代，其在途发送的回调按序号忽略
+  uint32_t start(uint32_t now_us) {
+    if (this->pending_)
+      this->stats_.record_superseded();
+    this->pending_ = true;
+    this->in_flight_ = false;
+    this->attempts_ = 0;
+    this->start_us_ = now_us;
+    return ++this->seq_;
+  }
+
+  Action poll(uint32_t now_ms) const {
+    if (!this->pending_ || this->in_flight_)
+      return ACTION_NONE;
+    const bool interval_elapsed = now_ms - this->last_send_ms_ >= this->retry_interval_ms_;
+    if (this->attempts_ >= this->retry_count_)
+      return interval_elapsed ? ACTION_GIVE_UP : ACTION_NONE;
+    return this->attempts_ == 0 || interval_elapsed ? ACTION_SEND : ACTION_NONE;
+  }
+
+  // 发送已入队
+  void sent(uint32_t now_ms) {
+    this->in_flight_ = true;
+    this->last_send_ms_ = now_ms;
+    this->attempts_++;
+  }
+  // send() 没有入队，回调不会触发
+  void send_rejected() { this->in_flight_ = false; }
+  // 发送回调；返回 false 表示属于已被取代的命令
+  bool send_done(uint32_t seq) {
+    if (seq != this->seq_)
+      return false;
+    this->in_flight_ = false;
+    return true;
+  }
+
+  // 当前命令结束：成功（收到确认）或失败（重试耗尽、对端离线或被隔离）
+  bool complete(bool success, uint32_t now_us) {
+    if (!this->pending_)
+      return false;
+    this->pending_ = false;
+    if (success) {
+      this->stats_.record_success(now_us - this->start_us_, this->attempts_);
+    } else {
+      this->stats_.record_failure();
+    }
+    return true;
+  }
+
+  bool is_pending() const { return this->pending_; }
+  bool is_in_flight() const { return this->in_flight_; }
+  uint8_t get_attempts() const { return this->attempts_; }
+  uint8_t get_retry_count() const { return this->retry_count_; }
+  uint32_t get_retry_interval() const { return this->retry_interval_ms_; }
+  uint32_t get_seq() const { return this->seq_; }
+  uint32_t get_start_us() const { return this->start_us_; }
+  const ESPNowSwitchStats &get_stats() const { return this->stats_; }
+  void reset_stats() { this->stats_.reset(); }
+
+ protected:
+  uint8_t retry_count_{12};
+  uint32_t retry_interval_ms_{300};
+  bool pending_{false};
+  bool in_flight_{false};
+  uint8_t attempts_{0};
+  uint32_t last_send_ms_{0};
+  // 当前命令的开始时间戳（微秒）
+  uint32_t start_us_{0};
+  // 命令序号，每次 start 递增
+  uint32_t seq_{0};
+  ESPNowSwitchStats stats_{};
+};
+
+}  // namespace espnow_switch
+}  // namespace esphome
@@ -0,0 +1,55 @@
+#include "espnow_switch_sensor.h"
+#include "esphome/core/log.h"
+
+#include <cinttypes>
+
+namespace esphome {
+namespace espnow_switch {
+
+static const char *const TAG = "espnow_switch.sensor";
+
+void ESPNowSwitchSensor::update() {
+  const ESPNowSwitchStats &stats = this->parent_->get_stats();
+  if (this->last_latency_sensor_ != nullptr && stats.get_successes() > 0)
+    this->last_latency_sensor_->publish_state(stats.get_last_latency_ms());
+  if (this->mean_latency_sensor_ != nullptr)
+    this->mean_latency_sensor_->publish_state(stats.get_mean_latency_ms());
+  if (this->latency_p50_sensor_ != nullptr)
+    this->latency_p50_sensor_->publish_state(stats.get_latency_percentile_ms(0.50f));
+  if (this->latency_p95_sensor_ != nullptr)
+    this->latency_p95_sensor_->publish_state(stats.get_latency_percentile_ms(0.95f));
+  if (this->attempts_sensor_ != nullptr)
+    this->attempts_sensor_->publish_state(stats.get_mean_attempts());
+  if (this->success_rate_sensor_ != nullptr)
+    this->success_rate_sensor_->publish_state(stats.get_success_rate());
+
+  // 完整直方图只在 VERBOSE 日志中输出
+  ESP_LOGV(TAG, "'%s': %" PRIu32 " ok, %" PRIu32 " failed, %" PRIu32 " superseded", this->parent_->get_name().c_str(), stats.get_successes(),
+           stats.get_failures(), stats.get_superseded());
+  for (size_t i = 0; i < ESPNowSwitchStats::LATENCY_BUCKETS; i++) {
+    if (i < ESPNowSwitchStats::LATENCY_BUCKETS - 1) {
+      ESP_LOGV(TAG, "  <= %" PRIu32 "ms: %" PRIu32, ESPNowSwitchStats::LATENCY_BOUNDS_MS[i], stats.get_latency_bucket(i));
+    } else {
+      ESP_LOGV(TAG, "  >  %" PRIu32 "ms: %" PRIu32, ESPNowSwitchStats::LATENCY_BOUNDS_MS[i - 1], stats.get_latency_bucket(i));
+    }
+  }
+  for (size_t i = 0; i < ESPNowSwitchStats::ATTEMPT_BUCKETS; i++) {
+    ESP_LOGV(TAG, "  %zu%s attempts: %" PRIu32, i + 1, i == ESPNowSwitchStats::ATTEMPT_BUCKETS - 1 ? "+" : "",
+             stats.get_attempts_bucket(i));
+  }
+}
+
+void ESPNowSwitchSensor::dump_config() {
+  ESP_LOGCONFIG(TAG, "ESPNow Switch Sensor:");
+  ESP_LOGCONFIG(TAG, "  Switch: %s", this->parent_->get_name().c_str());
+  LOG_UPDATE_INTERVAL(this);
+  LOG_SENSOR("  ", "Last Latency", this->last_latency_sensor_);
+  LOG_SENSOR("  ", "Mean Latency", this->mean_latency_sensor_);
+  LOG_SENSOR("  ", "Latency P50", this->latency_p50_sensor_);
+  LOG_SENSOR("  ", "Latency P95", this->latency_p95_sensor_);
+  LOG_SENSOR("  ", "Attempts", this->attempts_sensor_);
+  LOG_SENSOR("  ", "Success Rate", this->success_rate_sensor_);
+}
+
+}  // namespace espnow_switch
+}  // namespace esphome
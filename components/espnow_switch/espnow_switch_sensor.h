@@ -0,0 +1,35 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/components/sensor/sensor.h"
+#include "espnow_switch.h"
+
+namespace esphome {
+namespace espnow_switch {
+
+// 定期发布 ESPNowSwitch 的命令延迟统计
+class ESPNowSwitchSensor : public PollingComponent {
+ public:
+  void set_parent(ESPNowSwitch *parent) { this->parent_ = parent; }
+  void set_last_latency_sensor(sensor::Sensor *sensor) { this->last_latency_sensor_ = sensor; }
+  void set_mean_latency_sensor(sensor::Sensor *sensor) { this->mean_latency_sensor_ = sensor; }
+  void set_latency_p50_sensor(sensor::Sensor *sensor) { this->latency_p50_sensor_ = sensor; }
+  void set_latency_p95_sensor(sensor::Sensor *sensor) { this->latency_p95_sensor_ = sensor; }
+  void set_attempts_sensor(sensor::Sensor *sensor) { this->attempts_sensor_ = sensor; }
+  void set_success_rate_sensor(sensor::Sensor *sensor) { this->success_rate_sensor_ = sensor; }
+
+  void update() override;
+  void dump_config() override;
+
+ protected:
+  ESPNowSwitch *parent_{nullptr};
+  sensor::Sensor *last_latency_sensor_{nullptr};
+  sensor::Sensor *mean_latency_sensor_{nullptr};
+  sensor::Sensor *latency_p50_sensor_{nullptr};
+  sensor::Sensor *latency_p95_sensor_{nullptr};
+  sensor::Sensor *attempts_sensor_{nullptr};
+  sensor::Sensor *success_rate_sensor_{nullptr};
+};
+
+}  // namespace espnow_switch
+}  // namespace esphome
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace espnow_switch {
+
+// 命令延迟统计：用固定分桶的直方图代替保存每个样本，内存占用恒定
+class ESPNowSwitchStats {
+ public:
+  // 延迟分桶上界（毫秒），最后一个桶收集超过 2000ms 的样本
+  static constexpr size_t LATENCY_BUCKETS = 10;
+  static constexpr uint32_t LATENCY_BOUNDS_MS[LATENCY_BUCKETS - 1] = {5, 10, 20, 50, 100, 200, 500, 1000, 2000};
+  // 尝试次数分桶：1..7 次各一个桶，最后一个桶收集 8 次及以上
+  static constexpr size_t ATTEMPT_BUCKETS = 8;
+
+  void record_success(uint32_t latency_us, uint8_t attempts) {
+    const uint32_t latency_ms = latency_us / 1000;
+    size_t bucket = 0;
+    while (bucket < LATENCY_BUCKETS - 1 && latency_ms > LATENCY_BOUNDS_MS[bucket])
+      bucket++;
+    this->latency_[bucket]++;
+    size_t attempt_bucket = attempts == 0 ? 0 : attempts - 1;
+    if (attempt_bucket >= ATTEMPT_BUCKETS)
+      attempt_bucket = ATTEMPT_BUCKETS - 1;
+    this->attempts_[attempt_bucket]++;
+    this->attempts_total_ += attempts;
+    this->latency_total_us_ += latency_us;
+    if (latency_us > this->latency_max_us_)
+      this->latency_max_us_ = latency_us;
+    this->last_latency_us_ = latency_us;
+    this->successes_++;
+  }
+  void record_failure() { this->failures_++; }
+  // 新命令在确认前取代了旧命令，不计入成功或失败
+  void record_superseded() { this->superseded_++; }
+
+  uint32_t get_successes() const { return this->successes_; }
+  uint32_t get_failures() const { return this->failures_; }
+  uint32_t get_superseded() const { return this->superseded_; }
+  uint32_t get_latency_bucket(size_t index) const { return this->latency_[index]; }
+  uint32_t get_attempts_bucket(size_t index) const { return this->attempts_[index]; }
+
+  float get_last_latency_ms() const { return this->last_latency_us_ / 1000.0f; }
+  float get_mean_latency_ms() const {
+    return this->successes_ == 0 ? NAN : (this->latency_total_us_ / 1000.0f) / this->successes_;
+  }
+  float get_mean_attempts() const {
+    return this->successes_ == 0 ? NAN : static_cast<float>(this->attempts_total_) / this->successes_;
+  }
+  // 成功率（百分比），取代的命令不计入
+  float get_success_rate() const {
+    const uint32_t total = this->successes_ + this->failures_;
+    return total == 0 ? NAN : 100.0f * this->successes_ / total;
+  }
+
+  // 从直方图估算延迟分位数（桶内线性插值），p 取 0..1
+  float get_latency_percentile_ms(float p) const {
+    if (this->successes_ == 0)
+      return NAN;
+    const float target = p * this->successes_;
+    uint32_t cumulative = 0;
+    for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+      if (this->latency_[i] == 0)
+        continue;
+      if (cumulative + this->latency_[i] >= target) {
+        const float lower = i == 0 ? 0.0f : LATENCY_BOUNDS_MS[i - 1];
+        const float upper = i == LATENCY_BUCKETS - 1 ? this->latency_max_us_ / 1000.0f : LATENCY_BOUNDS_MS[i];
+        const float fraction = (target - cumulative) / this->latency_[i];
+        return lower + (upper - lower) * fraction;
+      }
+      cumulative += this->latency_[i];
+    }
+    return this->latency_max_us_ / 1000.0f;
+  }
+
+  void reset() { *this = ESPNowSwitchStats{}; }
+
+ protected:
+  std::array<uint32_t, LATENCY_BUCKETS> latency_{};
+  std::array<uint32_t, ATTEMPT_BUCKETS> attempts_{};
+  uint64_t latency_total_us_{0};
+  uint32_t attempts_total_{0};
+  uint32_t latency_max_us_{0};
+  uint32_t last_latency_us_{0};
+  uint32_t successes_{0};
+  uint32_t failures_{0};
+  uint32_t superseded_{0};
+};
+
+}  // namespace espnow_switch
+}  // namespace esphome
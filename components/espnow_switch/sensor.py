@@ -0,0 +1,79 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import sensor
+from esphome.const import (
+    CONF_ID,
+    STATE_CLASS_MEASUREMENT,
+    UNIT_MILLISECOND,
+    UNIT_PERCENT,
+)
+from . import espnow_switch_ns
+from .switch import ESPNowSwitch
+
+DEPENDENCIES = ["espnow_switch"]
+CODEOWNERS = ["@jason"]
+
+ESPNowSwitchSensor = espnow_switch_ns.class_("ESPNowSwitchSensor", cg.PollingComponent)
+
+CONF_ESPNOW_SWITCH_ID = "espnow_switch_id"
+CONF_LAST_LATENCY = "last_latency"
+CONF_MEAN_LATENCY = "mean_latency"
+CONF_LATENCY_P50 = "latency_p50"
+CONF_LATENCY_P95 = "latency_p95"
+CONF_ATTEMPTS = "attempts"
+CONF_SUCCESS_RATE = "success_rate"
+
+ICON_TIMER = "mdi:timer-outline"
+ICON_REPEAT = "mdi:repeat"
+
+
+def latency_schema():
+    return sensor.sensor_schema(
+        unit_of_measurement=UNIT_MILLISECOND,
+        icon=ICON_TIMER,
+        accuracy_decimals=1,
+        state_class=STATE_CLASS_MEASUREMENT,
+    )
+
+
+# write_state() 到确认响应的延迟，以及每次成功所需的尝试次数
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(ESPNowSwitchSensor),
+        cv.GenerateID(CONF_ESPNOW_SWITCH_ID): cv.use_id(ESPNowSwitch),
+        cv.Optional(CONF_LAST_LATENCY): latency_schema(),
+        cv.Optional(CONF_MEAN_LATENCY): latency_schema(),
+        cv.Optional(CONF_LATENCY_P50): latency_schema(),
+        cv.Optional(CONF_LATENCY_P95): latency_schema(),
+        cv.Optional(CONF_ATTEMPTS): sensor.sensor_schema(
+            icon=ICON_REPEAT,
+            accuracy_decimals=2,
+            state_class=STATE_CLASS_MEASUREMENT,
+        ),
+        cv.Optional(CONF_SUCCESS_RATE): sensor.sensor_schema(
+            unit_of_measurement=UNIT_PERCENT,
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+        ),
+    }
+).extend(cv.polling_component_schema("60s"))
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+
+    parent = await cg.get_variable(config[CONF_ESPNOW_SWITCH_ID])
+    cg.add(var.set_parent(parent))
+
+    for key in (
+        CONF_LAST_LATENCY,
+        CONF_MEAN_LATENCY,
+        CONF_LATENCY_P50,
+        CONF_LATENCY_P95,
+        CONF_ATTEMPTS,
+        CONF_SUCCESS_RATE,
+    ):
+        if key in config:
+            sens = await sensor.new_sensor(config[key])
+            cg.add(getattr(var, f"set_{key}_sensor")(sens))
@@ -9,6 +9,7 @@ from . import (
     CONF_RESPONSE_TOKEN,
     CONF_RETRY_COUNT,
     CONF_RETRY_INTERVAL,
+    CONF_STATE_ID,
 )
 
 DEPENDENCIES = ["espnow"]
@@ -16,6 +17,14 @@ CODEOWNERS = ["@jason"]
 
 ESPNowSwitch = espnow_switch_ns.class_("ESPNowSwitch", switch.Switch, cg.Component)
 
+CONF_PROTOCOL = "protocol"
+CONF_MONITOR_PEER = "monitor_peer"
+ESPNowSwitchProtocol = espnow_switch_ns.enum("ESPNowSwitchProtocol")
+PROTOCOLS = {
+    "legacy": ESPNowSwitchProtocol.PROTOCOL_LEGACY,
+    "state_sync": ESPNowSwitchProtocol.PROTOCOL_STATE_SYNC,
+}
+
 
 CONFIG_SCHEMA = (
     switch.switch_schema(ESPNowSwitch)
@@ -26,6 +35,10 @@ CONFIG_SCHEMA = (
             cv.Optional(CONF_RESPONSE_TOKEN): cv.string,
             cv.Optional(CONF_RETRY_COUNT, default=15): cv.int_range(min=1, max=100),
             cv.Optional(CONF_RETRY_INTERVAL, default=150): cv.int_range(min=10, max=5000),
+            cv.Optional(CONF_PROTOCOL, default="legacy"): cv.enum(PROTOCOLS, lower=True),
+            cv.Optional(CONF_STATE_ID, default=0): cv.uint16_t,
+            # 启用后对端离线时命令立即失败；会产生心跳流量，默认关闭
+            cv.Optional(CONF_MONITOR_PEER, default=False): cv.boolean,
         }
     )
     .extend(cv.COMPONENT_SCHEMA)
@@ -62,5 +75,7 @@ async def to_code(config):
     cg.add(var.set_retry_count(config[CONF_RETRY_COUNT]))
     cg.add(var.set_retry_interval(config[CONF_RETRY_INTERVAL]))
 
-
-
+    # 设置协议（状态同步协议使用设备推送的真实状态）
+    cg.add(var.set_protocol(config[CONF_PROTOCOL]))
+    cg.add(var.set_state_id(config[CONF_STATE_ID]))
+    cg.add(var.set_monitor_peer(config[CONF_MONITOR_PEER]))
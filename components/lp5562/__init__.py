@@ -2,6 +2,7 @@ import esphome.codegen as cg
 from esphome.components import i2c
 import esphome.config_validation as cv
 from esphome.const import CONF_ID
+from esphome import core
 
 
 DEPENDENCIES = ["i2c"]
@@ -18,6 +19,8 @@ CONF_RED_CURRENT = "red_current"
 CONF_GREEN_CURRENT = "green_current"
 CONF_BLUE_CURRENT = "blue_current"
 CONF_WHITE_CURRENT = "white_current"
+CONF_DITHER = "dither"
+CONF_DITHER_INTERVAL = "dither_interval"
 
 lp5562_ns = cg.esphome_ns.namespace("lp5562")
 LP5562Component = lp5562_ns.class_("LP5562Component", cg.Component, i2c.I2CDevice)
@@ -39,6 +42,11 @@ CONFIG_SCHEMA = (
             cv.Optional(CONF_GREEN_CURRENT, default=0) : cv.float_range(min=0.0, max=25.5),
             cv.Optional(CONF_BLUE_CURRENT, default=0) : cv.float_range(min=0.0, max=25.5),
             cv.Optional(CONF_WHITE_CURRENT, default=0) : cv.float_range(min=0.0, max=25.5),
+            cv.Optional(CONF_DITHER, default=False) : cv.boolean,
+            cv.Optional(CONF_DITHER_INTERVAL, default="10ms") : cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(min=core.TimePeriod(milliseconds=2), max=core.TimePeriod(milliseconds=100)),
+            ),
         }
     )
     .extend(cv.COMPONENT_SCHEMA)
@@ -58,3 +66,5 @@ async def to_code(config):
     cg.add(var.set_green_current(config[CONF_GREEN_CURRENT]))
     cg.add(var.set_blue_current(config[CONF_BLUE_CURRENT]))
     cg.add(var.set_white_current(config[CONF_WHITE_CURRENT]))
+    if config[CONF_DITHER]:
+        cg.add(var.set_dither_interval(config[CONF_DITHER_INTERVAL]))
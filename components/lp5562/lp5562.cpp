@@ -116,10 +116,75 @@ void LP5562Component::dump_config() {
                 TRUEFALSE(this->high_pwm_freq_enable_),
                 TRUEFALSE(this->logarithmic_dimming_),
                 this->red_current_, this->green_current_, this->blue_current_, this->white_current_);
+    if (this->is_dithering()) {
+        ESP_LOGCONFIG(TAG, "  dither interval: %u ms", (unsigned) this->dither_interval_);
+    }
+}
+
+void LP5562Component::loop() {
+    if (this->dither_mask_ == 0) {
+        return;
+    }
+    const uint32_t now = millis();
+    if (now - this->last_dither_ >= this->dither_interval_) {
+        this->last_dither_ = now;
+        this->dither_step_();
+    }
 }
 
 
 void LP5562Component::set_led_brightness_by_channel(LED_Channel_t channel, uint8_t brightness) {
+    if (channel > CHANNEL_W) {
+        ESP_LOGW(TAG, "Unspecified RGBW channel..");
+        return;
+    }
+    // a plain 8-bit value has no fraction to dither
+    if (this->dither_mask_ & BIT(channel)) {
+        this->dither_mask_ &= ~BIT(channel);
+        if (this->dither_mask_ == 0) {
+            this->high_freq_.stop();
+        }
+    }
+    this->write_pwm_(channel, brightness);
+}
+
+void LP5562Component::set_led_brightness16_by_channel(LED_Channel_t channel, uint16_t brightness) {
+    if (channel > CHANNEL_W) {
+        ESP_LOGW(TAG, "Unspecified RGBW channel..");
+        return;
+    }
+    if (!this->is_dithering() || (brightness & 0xFF) == 0 || brightness >= 0xFF00) {
+        uint8_t rounded = brightness >= 0xFF00 ? 0xFF : (brightness + 0x80) >> 8;
+        this->set_led_brightness_by_channel(channel, rounded);
+        return;
+    }
+    if (!(this->dither_mask_ & BIT(channel))) {
+        this->accum_[channel] = 0x80; // start half way to minimise the average error
+        if (this->dither_mask_ == 0) {
+            this->high_freq_.start();
+        }
+        this->dither_mask_ |= BIT(channel);
+    }
+    this->target_[channel] = brightness;
+}
+
+void LP5562Component::dither_step_() {
+    for (uint8_t ch = CHANNEL_B; ch <= CHANNEL_W; ch++) {
+        if (!(this->dither_mask_ & BIT(ch))) {
+            continue;
+        }
+        // error accumulation: output one step higher whenever the accumulated fraction overflows
+        const uint16_t sum = this->accum_[ch] + (this->target_[ch] & 0xFF);
+        this->accum_[ch] = sum & 0xFF;
+        const uint8_t value = (this->target_[ch] >> 8) + (sum >> 8);
+        // only registers whose value changes are written, which keeps the bus load bounded
+        if (value != this->written_[ch]) {
+            this->write_pwm_((LED_Channel_t) ch, value);
+        }
+    }
+}
+
+void LP5562Component::write_pwm_(LED_Channel_t channel, uint8_t value) {
     uint8_t reg; // which register
 
     switch (channel) {
@@ -131,7 +196,12 @@ void LP5562Component::set_led_brightness_by_channel(LED_Channel_t channel, uint8
             ESP_LOGW(TAG, "Unspecified RGBW channel..");
             return;
     }
-    LP5562_WARN_CHECK(this->write_byte(reg, brightness));
+    if (this->write_byte(reg, value)) {
+        this->written_[channel] = value;
+    } else {
+        this->written_[channel] = -1;
+        ESP_LOGW(TAG, "Error when read/write register.");
+    }
 }
 
 
@@ -8,6 +8,7 @@
 #include "esphome/components/i2c/i2c.h"
 #include "esphome/core/component.h"
 #include "esphome/core/defines.h"
+#include "esphome/core/helpers.h"
 
 namespace esphome {
 namespace lp5562 {
@@ -26,6 +27,7 @@ class LP5562Component : public i2c::I2CDevice,
 
 public:
     void setup() override;
+    void loop() override;
     void dump_config() override;
     
     void set_use_internal_clk(bool use_internal_clk) { this->use_internal_clk_ = use_internal_clk; }
@@ -36,8 +38,12 @@ public:
     void set_green_current(float current) { this->green_current_ = current; }
     void set_blue_current(float current) { this->blue_current_ = current; }
     void set_white_current(float current) { this->white_current_ = current; }
+    void set_dither_interval(uint32_t interval_ms) { this->dither_interval_ = interval_ms; }
+    bool is_dithering() const { return this->dither_interval_ > 0; }
     
     void set_led_brightness_by_channel(LED_Channel_t channel, uint8_t brightness);
+    // brightness in 8.8 fixed point; the fraction is dithered over successive frames when enabled
+    void set_led_brightness16_by_channel(LED_Channel_t channel, uint16_t brightness);
     void set_led_current_by_channel(LED_Channel_t channel, uint8_t current);
     void map_led_2_ctrl_src(LED_Channel_t channel, uint8_t source); // map led to control source
 
@@ -45,6 +51,8 @@ protected:
     void set_engine_mode_(uint8_t engine, uint8_t mode);
     void set_all_engine_mode_(uint8_t mode);
     void set_all_led_mapping_(uint8_t source);
+    void write_pwm_(LED_Channel_t channel, uint8_t value);
+    void dither_step_();
 
     bool use_internal_clk_ {false};
     bool power_save_enable_{false};
@@ -55,6 +63,15 @@ protected:
     float green_current_ {0};
     float blue_current_ {0};
     float white_current_ {0};
+
+    // temporal dithering state, indexed by LED_Channel_t
+    uint32_t dither_interval_ {0};
+    uint32_t last_dither_ {0};
+    uint8_t dither_mask_ {0};
+    uint16_t target_[4] {0};
+    uint8_t accum_[4] {0};
+    int16_t written_[4] {-1, -1, -1, -1}; // last PWM value sent, -1 if unknown
+    HighFrequencyLoopRequester high_freq_;
 };
 
 } // namespace lp5562
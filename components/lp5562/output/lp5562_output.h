@@ -14,6 +14,11 @@ class LP5562Output : public output::FloatOutput,
 public:
     void set_channel(LED_Channel_t channel) { channel_ = channel; }
     void write_state(float state) override {
+        if (this->parent_->is_dithering()) {
+            uint16_t val16 = (uint16_t) roundf(65280.0f * state);
+            this->parent_->set_led_brightness16_by_channel(this->channel_, val16);
+            return;
+        }
         uint8_t val = (uint8_t) roundf(255.0f * state);
         this->parent_->set_led_brightness_by_channel(this->channel_, val);
     }
@@ -1,7 +1,17 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
 from esphome.components import i2c
-from esphome.const import CONF_ID
+from esphome.const import (
+    CONF_BLUE,
+    CONF_CHANNELS,
+    CONF_EFFECT,
+    CONF_GREEN,
+    CONF_ID,
+    CONF_INTERVAL,
+    CONF_PERIOD,
+    CONF_RED,
+)
+from esphome import automation, core
 
 DEPENDENCIES = ["i2c"]
 MULTI_CONF = True
@@ -21,9 +31,54 @@ CONF_GREEN_CURRENT = "green_current"
 CONF_BLUE_CURRENT = "blue_current"
 CONF_WHITE_CURRENT = "white_current"
 CONF_REF_CURRENT = "ref_current"
+CONF_LEVEL_RESOLUTION = "level_resolution"
+CONF_LEVEL_TABLE_ID = "level_table_id"
+CONF_LEVEL_TABLE16_ID = "level_table16_id"
+CONF_DITHER = "dither"
+CONF_DITHER_INTERVAL = "dither_interval"
+CONF_EFFECTS = "effects"
+CONF_FRAME_BUDGET = "frame_budget"
 
 pyramidrgb_ns = cg.esphome_ns.namespace("pyramidrgb")
 PyramidRGBComponent = pyramidrgb_ns.class_("PyramidRGBComponent", cg.Component, i2c.I2CDevice)
+PyramidEffect = pyramidrgb_ns.enum("PyramidEffect")
+EffectStartAction = pyramidrgb_ns.class_("EffectStartAction", automation.Action)
+EffectStopAction = pyramidrgb_ns.class_("EffectStopAction", automation.Action)
+
+# 灯效与预设：(灯效, 默认颜色, 默认周期毫秒)，预设在编译期展开，C++ 端只处理基础灯效
+EFFECTS = {
+    "breathe": (PyramidEffect.EFFECT_BREATHE, (255, 255, 255), 2000),
+    "spin": (PyramidEffect.EFFECT_SPIN, (255, 255, 255), 1000),
+    "chase": (PyramidEffect.EFFECT_CHASE, (255, 255, 255), 1000),
+    # 语音助手各阶段
+    "listening": (PyramidEffect.EFFECT_BREATHE, (0, 64, 255), 1200),
+    "thinking": (PyramidEffect.EFFECT_SPIN, (128, 0, 255), 900),
+    "replying": (PyramidEffect.EFFECT_CHASE, (0, 192, 255), 1400),
+}
+
+STRIP_CHANNELS = {1: [0, 1], 2: [2, 3]}
+
+
+def _unique_channels(value):
+    if len(set(value)) != len(value):
+        raise cv.Invalid("Each channel may only be listed once")
+    return value
+
+
+# 灯效引擎：固定间隔渲染，每帧渲染加总线时间超出预算时跳过下一帧
+EFFECTS_SCHEMA = cv.Schema(
+    {
+        # 默认使用本实例 strip 对应的两个通道
+        cv.Optional(CONF_CHANNELS): cv.All(
+            cv.ensure_list(cv.int_range(min=0, max=3)), cv.Length(min=1), _unique_channels
+        ),
+        cv.Optional(CONF_INTERVAL, default="20ms"): cv.All(
+            cv.positive_time_period_milliseconds,
+            cv.Range(min=core.TimePeriod(milliseconds=5), max=core.TimePeriod(milliseconds=1000)),
+        ),
+        cv.Optional(CONF_FRAME_BUDGET, default="3ms"): cv.positive_time_period_microseconds,
+    }
+)
 
 BASE_SCHEMA = cv.Schema({
     cv.GenerateID(CONF_PYRAMIDRGB_ID): cv.use_id(PyramidRGBComponent),
@@ -49,6 +104,17 @@ CONFIG_SCHEMA = (
             cv.Optional(CONF_BLUE_CURRENT, default=22.5): cv.float_,
             cv.Optional(CONF_WHITE_CURRENT, default=22.5): cv.float_,
             cv.Optional(CONF_REF_CURRENT, default=22.5): cv.float_,
+            # map_level 查找表的输入分辨率（位），每种颜色 2^bits 字节
+            cv.Optional(CONF_LEVEL_RESOLUTION, default=12): cv.int_range(min=8, max=12),
+            cv.GenerateID(CONF_LEVEL_TABLE_ID): cv.declare_id(cg.uint8),
+            cv.GenerateID(CONF_LEVEL_TABLE16_ID): cv.declare_id(cg.uint16),
+            # 时间抖动：以 8.8 定点数保存目标值，小数部分按固定周期在连续帧间分摊
+            cv.Optional(CONF_DITHER, default=False): cv.boolean,
+            cv.Optional(CONF_DITHER_INTERVAL, default="10ms"): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(min=core.TimePeriod(milliseconds=2), max=core.TimePeriod(milliseconds=100)),
+            ),
+            cv.Optional(CONF_EFFECTS, default={}): EFFECTS_SCHEMA,
         }
     )
     .extend(cv.COMPONENT_SCHEMA)
@@ -77,4 +143,108 @@ async def to_code(config):
         config[CONF_GREEN_CURRENT],
         config[CONF_BLUE_CURRENT],
         config[CONF_WHITE_CURRENT]
-    ))
\ No newline at end of file
+    ))
+
+    effects = config[CONF_EFFECTS]
+    for channel in effects.get(CONF_CHANNELS, STRIP_CHANNELS[config[CONF_STRIP]]):
+        cg.add(var.add_effect_channel(channel))
+    cg.add(var.set_effect_interval(effects[CONF_INTERVAL]))
+    cg.add(var.set_effect_frame_budget(effects[CONF_FRAME_BUDGET]))
+
+    if config[CONF_DITHER]:
+        cg.add(var.set_dither_interval(config[CONF_DITHER_INTERVAL]))
+
+    # 配置在编译期已知，预先生成 R/G/B 查找表放入 flash，运行时只需一次查表；
+    # 恒等映射的实时计算只是一次乘法，不值得每个实例占用 12 KiB（抖动时 24 KiB）flash
+    if _is_identity_mapping(config):
+        return
+    if config[CONF_DITHER]:
+        # 抖动需要小数部分，查找表输出 8.8 定点数
+        cg.add(var.set_level_table16(
+            cg.progmem_array(config[CONF_LEVEL_TABLE16_ID], _level_table(config, 65280.0)),
+            config[CONF_LEVEL_RESOLUTION]
+        ))
+    else:
+        cg.add(var.set_level_table(
+            cg.progmem_array(config[CONF_LEVEL_TABLE_ID], _level_table(config, 255.0)),
+            config[CONF_LEVEL_RESOLUTION]
+        ))
+
+
+def _is_identity_mapping(config):
+    # 与 compute_level_ 一致：只有开启 logarithmic_dimming 时 gamma 才生效
+    if config[CONF_LOGARITHMIC_DIMMING] and config[CONF_GAMMA] != 1.0:
+        return False
+    ref = config[CONF_REF_CURRENT]
+    if ref <= 0:
+        return True
+    return all(
+        config[key] == ref for key in (CONF_RED_CURRENT, CONF_GREEN_CURRENT, CONF_BLUE_CURRENT)
+    )
+
+
+def _level_table(config, full_scale):
+    # 与 PyramidRGBComponent::compute_level_ 的计算保持一致
+    size = 1 << config[CONF_LEVEL_RESOLUTION]
+    gamma = config[CONF_GAMMA]
+    ref = config[CONF_REF_CURRENT]
+    table = []
+    for current in (config[CONF_RED_CURRENT], config[CONF_GREEN_CURRENT], config[CONF_BLUE_CURRENT]):
+        scale = current / ref if ref > 0 else 1.0
+        for i in range(size):
+            x = i / (size - 1)
+            if i == 0:
+                table.append(0)
+                continue
+            if config[CONF_LOGARITHMIC_DIMMING] and gamma != 1.0:
+                x = x ** gamma
+            x = min(max(x * scale, 0.0), 1.0)
+            table.append(int(x * full_scale + 0.5))
+    return table
+
+
+EFFECT_START_SCHEMA = cv.maybe_simple_value(
+    {
+        cv.GenerateID(): cv.use_id(PyramidRGBComponent),
+        cv.Required(CONF_EFFECT): cv.one_of(*EFFECTS, lower=True),
+        cv.Optional(CONF_RED): cv.templatable(cv.uint8_t),
+        cv.Optional(CONF_GREEN): cv.templatable(cv.uint8_t),
+        cv.Optional(CONF_BLUE): cv.templatable(cv.uint8_t),
+        cv.Optional(CONF_PERIOD): cv.templatable(
+            cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(min=core.TimePeriod(milliseconds=100), max=core.TimePeriod(seconds=60)),
+            )
+        ),
+    },
+    key=CONF_EFFECT,
+)
+
+
+@automation.register_action("pyramidrgb.effect.start", EffectStartAction, EFFECT_START_SCHEMA)
+async def effect_start_action(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    effect, color, period = EFFECTS[config[CONF_EFFECT]]
+    cg.add(var.set_effect(effect))
+    # 未指定的颜色/周期使用灯效或预设的默认值
+    for key, default, type_, setter in (
+        (CONF_RED, color[0], cg.uint8, var.set_red),
+        (CONF_GREEN, color[1], cg.uint8, var.set_green),
+        (CONF_BLUE, color[2], cg.uint8, var.set_blue),
+        (CONF_PERIOD, period, cg.uint32, var.set_period),
+    ):
+        template_ = await cg.templatable(config.get(key, default), args, type_)
+        cg.add(setter(template_))
+    return var
+
+
+@automation.register_action(
+    "pyramidrgb.effect.stop",
+    EffectStopAction,
+    cv.maybe_simple_value({cv.GenerateID(): cv.use_id(PyramidRGBComponent)}, key=CONF_ID),
+)
+async def effect_stop_action(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    return var
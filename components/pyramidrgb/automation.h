@@ -0,0 +1,33 @@
+#pragma once
+
+#include "esphome/core/automation.h"
+#include "pyramidrgb.h"
+
+namespace esphome {
+namespace pyramidrgb {
+
+template<typename... Ts> class EffectStartAction : public Action<Ts...>, public Parented<PyramidRGBComponent> {
+ public:
+  TEMPLATABLE_VALUE(uint8_t, red)
+  TEMPLATABLE_VALUE(uint8_t, green)
+  TEMPLATABLE_VALUE(uint8_t, blue)
+  TEMPLATABLE_VALUE(uint32_t, period)
+
+  void set_effect(PyramidEffect effect) { this->effect_ = effect; }
+
+  void play(const Ts &...x) override {
+    this->parent_->start_effect(this->effect_, this->red_.value(x...), this->green_.value(x...),
+                                this->blue_.value(x...), this->period_.value(x...));
+  }
+
+ protected:
+  PyramidEffect effect_ {EFFECT_NONE};
+};
+
+template<typename... Ts> class EffectStopAction : public Action<Ts...>, public Parented<PyramidRGBComponent> {
+ public:
+  void play(const Ts &...x) override { this->parent_->stop_effect(); }
+};
+
+}  // namespace pyramidrgb
+}  // namespace esphome
@@ -0,0 +1,64 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import light
+from esphome.const import CONF_OUTPUT_ID, CONF_CHANNEL, CONF_CHANNELS, CONF_TYPE
+from .. import pyramidrgb_ns, CONF_PYRAMIDRGB_ID, BASE_SCHEMA
+
+CODEOWNERS = ["@Jasionf"]
+DEPENDENCIES = ["pyramidrgb"]
+
+PyramidRGBLight = pyramidrgb_ns.class_("PyramidRGBLight", light.AddressableLight)
+PyramidRGBChannelLight = pyramidrgb_ns.class_("PyramidRGBChannelLight", light.LightOutput)
+
+TYPE_ADDRESSABLE = "addressable"
+TYPE_RGB = "rgb"
+
+CONF_FRAME_RATE = "frame_rate"
+
+
+def _unique_channels(value):
+    if len(set(value)) != len(value):
+        raise cv.Invalid("Each channel may only be listed once")
+    return value
+
+
+CONFIG_SCHEMA = cv.typed_schema(
+    {
+        # 逻辑灯带由所列通道按顺序拼接，每个通道 7 个 LED
+        TYPE_ADDRESSABLE: light.ADDRESSABLE_LIGHT_SCHEMA.extend(
+            {
+                cv.GenerateID(CONF_OUTPUT_ID): cv.declare_id(PyramidRGBLight),
+                cv.Optional(CONF_CHANNELS, default=[0, 1, 2, 3]): cv.All(
+                    cv.ensure_list(cv.int_range(min=0, max=3)), cv.Length(min=1), _unique_channels
+                ),
+                cv.Optional(CONF_FRAME_RATE, default=50): cv.int_range(min=1, max=100),
+            }
+        ).extend(BASE_SCHEMA).extend(cv.COMPONENT_SCHEMA),
+        # 单个通道作为 RGB 灯，整组 7 个 LED 同色，颜色一次性写入
+        TYPE_RGB: light.RGB_LIGHT_SCHEMA.extend(
+            {
+                cv.GenerateID(CONF_OUTPUT_ID): cv.declare_id(PyramidRGBChannelLight),
+                cv.Required(CONF_CHANNEL): cv.int_range(min=0, max=3),
+            }
+        ).extend(BASE_SCHEMA),
+    },
+    key=CONF_TYPE,
+    default_type=TYPE_ADDRESSABLE,
+    lower=True,
+)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_OUTPUT_ID])
+    if config[CONF_TYPE] == TYPE_RGB:
+        await light.register_light(var, config)
+        await cg.register_parented(var, config[CONF_PYRAMIDRGB_ID])
+        cg.add(var.set_channel(config[CONF_CHANNEL]))
+        return
+
+    await light.register_light(var, config)
+    await cg.register_component(var, config)
+    await cg.register_parented(var, config[CONF_PYRAMIDRGB_ID])
+    for channel in config[CONF_CHANNELS]:
+        cg.add(var.add_channel(channel))
+    cg.add(var.set_frame_interval(1000 // config[CONF_FRAME_RATE]))
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "esphome/components/light/light_output.h"
+#include "../pyramidrgb.h"
+
+namespace esphome {
+namespace pyramidrgb {
+
+// 单个通道的原生 RGB 灯：一次拿到完整颜色后整体写入，
+// 避免三个 FloatOutput 分别写 R/G/B 时出现中间颜色
+class PyramidRGBChannelLight : public light::LightOutput, public Parented<PyramidRGBComponent> {
+ public:
+  void set_channel(uint8_t channel) { channel_ = channel; }
+
+  light::LightTraits get_traits() override {
+    auto traits = light::LightTraits();
+    traits.set_supported_color_modes({light::ColorMode::RGB});
+    return traits;
+  }
+
+  void write_state(light::LightState *state) override {
+    float r, g, b;
+    state->current_values_as_rgb(&r, &g, &b);
+    // 只更新帧缓冲，同一轮 loop 内的多次变化由组件合并为一次刷新
+    if (this->parent_->is_dithering()) {
+      this->parent_->set_channel_color16(this->channel_, this->parent_->map_level16(COLOR_R, r),
+                                         this->parent_->map_level16(COLOR_G, g),
+                                         this->parent_->map_level16(COLOR_B, b));
+      return;
+    }
+    this->parent_->set_channel_color(this->channel_, this->parent_->map_level(COLOR_R, r),
+                                     this->parent_->map_level(COLOR_G, g), this->parent_->map_level(COLOR_B, b));
+  }
+
+ protected:
+  uint8_t channel_ {0};
+};
+
+}  // namespace pyramidrgb
+}  // namespace esphome
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "esphome/components/light/addressable_light.h"
+#include "esphome/core/hal.h"
+#include "../pyramidrgb.h"
+
+namespace esphome {
+namespace pyramidrgb {
+
+// 把所选通道的 LED 拼成一条逻辑灯带，供 ESPHome 的 addressable 效果使用
+class PyramidRGBLight : public light::AddressableLight, public Parented<PyramidRGBComponent> {
+ public:
+  // 追加一个通道（7 个 LED）到逻辑灯带末尾，逻辑顺序即通道内 LED 0..6
+  void add_channel(uint8_t channel) {
+    if (num_leds_ + NUM_LEDS_PER_GROUP > NUM_LEDS) return;
+    for (uint8_t i = 0; i < NUM_LEDS_PER_GROUP; i++) {
+      led_map_[num_leds_++] = PyramidRGBComponent::led_index(channel, i);
+    }
+  }
+  void set_frame_interval(uint32_t interval_ms) { frame_interval_ = interval_ms; }
+
+  int32_t size() const override { return num_leds_; }
+
+  light::LightTraits get_traits() override {
+    auto traits = light::LightTraits();
+    traits.set_supported_color_modes({light::ColorMode::RGB});
+    return traits;
+  }
+
+  void write_state(light::LightState *state) override {
+    // 超过帧率的刷新推迟到 loop() 中发送最新的一帧
+    if (millis() - last_frame_ < frame_interval_) {
+      pending_ = true;
+      return;
+    }
+    this->push_frame_();
+  }
+
+  void loop() override {
+    if (pending_ && millis() - last_frame_ >= frame_interval_) {
+      this->push_frame_();
+    }
+  }
+
+  void dump_config() override {
+    ESP_LOGCONFIG("pyramidrgb.light", "PyramidRGB Light: %u LEDs, frame interval %ums", num_leds_,
+                  (unsigned) frame_interval_);
+  }
+
+  float get_setup_priority() const override { return setup_priority::HARDWARE - 1.0f; }
+
+ protected:
+  light::ESPColorView get_view_internal(int32_t index) const override {
+    // AddressableLight 的 get_view_internal 为 const，颜色缓冲需可写
+    auto *self = const_cast<PyramidRGBLight *>(this);
+    uint8_t *led = self->leds_[index];
+    return {led + 0, led + 1, led + 2, nullptr, &self->effect_data_[index], &self->correction_};
+  }
+
+  void push_frame_() {
+    // 颜色已经过 color correction，直接写入帧缓冲；未变化的 LED 不会产生总线传输
+    for (uint8_t i = 0; i < num_leds_; i++) {
+      this->parent_->set_led(led_map_[i], leds_[i][0], leds_[i][1], leds_[i][2]);
+    }
+    // 整帧立即以连续区间写出，避免一帧被拆到两轮 loop 中
+    this->parent_->flush();
+    last_frame_ = millis();
+    pending_ = false;
+    this->mark_shown_();
+  }
+
+  uint8_t led_map_[NUM_LEDS] = {0};  // 逻辑索引 -> 硬件索引
+  uint8_t num_leds_ {0};
+  uint8_t leds_[NUM_LEDS][3] = {{0}};  // R, G, B
+  uint8_t effect_data_[NUM_LEDS] = {0};
+  uint32_t frame_interval_ {20};
+  uint32_t last_frame_ {0};
+  bool pending_ {false};
+};
+
+}  // namespace pyramidrgb
+}  // namespace esphome
@@ -13,6 +13,12 @@ class PyramidRGBOutput : public output::FloatOutput,
   void set_color(RGBColorChannel color) { color_ = color; }
 
   void write_state(float state) override {
+    if (this->parent_->is_dithering()) {
+      // 保留小数部分，由组件在连续帧间抖动输出
+      uint16_t val = this->parent_->map_level16(this->color_, state);
+      this->parent_->set_channel_color_component16(this->channel_, this->color_, val);
+      return;
+    }
     uint8_t val = this->parent_->map_level(this->color_, state);
     this->parent_->set_channel_color_component(this->channel_, this->color_, val);
   }
@@ -1,4 +1,9 @@
 #include "pyramidrgb.h"
+#include "esphome/core/application.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+
+#include <cstring>
 
 namespace esphome {
 namespace pyramidrgb {
@@ -8,6 +13,13 @@ static const char *const TAG = "pyramidrgb";
 void PyramidRGBComponent::setup() {
   ESP_LOGI(TAG, "PyramidRGB init (STM32 RGB controller at 0x%02X)", this->address_);
 
+  burst_supported_ = this->detect_burst_support_();
+  ESP_LOGD(TAG, "Auto-increment burst writes: %s", burst_supported_ ? "supported" : "not supported, writing per LED");
+
+  // 只重启 ESP 时（OTA、崩溃）控制器保持供电并保留旧颜色，帧缓冲全零不代表设备全黑；
+  // 全部标脏，首次刷新把设备同步到帧缓冲，否则第一次“关灯”会被相等检查丢掉
+  dirty_ = (1UL << NUM_LEDS) - 1;
+
   if (!this->set_strip_brightness(initial_strip_, initial_brightness_)) {
     ESP_LOGW(TAG, "Failed to set initial brightness for strip %u", initial_strip_);
   }
@@ -16,20 +28,38 @@ void PyramidRGBComponent::setup() {
     uint8_t r = initial_white_level_;
     uint8_t g = initial_white_level_;
     uint8_t b = initial_white_level_;
-    if (initial_strip_ == 1) {
-      this->set_channel_color(0, r, g, b);
-      this->set_channel_color(1, r, g, b);
-    } else if (initial_strip_ == 2) {
-      this->set_channel_color(2, r, g, b);
-      this->set_channel_color(3, r, g, b);
+    this->set_strip_color(initial_strip_, r, g, b);
+  }
+  this->flush();
+}
+
+void PyramidRGBComponent::loop() {
+  if (effects_.is_running()) {
+    const uint32_t now = millis();
+    if ((int32_t) (now - next_effect_frame_) >= 0) this->effect_frame_(now);
+  }
+  if (dither_mask_ != 0) {
+    // 固定刷新周期，只有跨过整数边界的 LED 会变脏，总线流量受脏位限制
+    const uint32_t now = millis();
+    if (now - last_dither_ >= dither_interval_) {
+      last_dither_ = now;
+      this->dither_step_();
     }
   }
+  if (dirty_ == 0) return;
+  // 同一轮内多个输出的修改合并为一次刷新
+  if (this->flush()) {
+    this->status_clear_warning();
+  } else {
+    this->status_set_warning();
+  }
 }
 
 void PyramidRGBComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "PyramidRGB Component");
   LOG_I2C_DEVICE(this);
   ESP_LOGCONFIG(TAG, "strip=%u brightness=%u initial_white=%u", initial_strip_, initial_brightness_, initial_white_level_);
+  ESP_LOGCONFIG(TAG, "burst_writes=%s", burst_supported_ ? "true" : "false");
   ESP_LOGCONFIG(TAG, "log_dimming=%s gamma=%.2f high_pwm_freq=%s power_save=%s internal_clk=%s",
                 logarithmic_dimming_ ? "true" : "false",
                 gamma_,
@@ -38,6 +68,16 @@ void PyramidRGBComponent::dump_config() {
                 use_internal_clk_ ? "true" : "false");
   ESP_LOGCONFIG(TAG, "ref_current=%.2f R=%.2f G=%.2f B=%.2f scales R=%.2f G=%.2f B=%.2f",
                 ref_current_, red_current_, green_current_, blue_current_, red_scale_, green_scale_, blue_scale_);
+  if (level_table_ != nullptr || level_table16_ != nullptr) {
+    ESP_LOGCONFIG(TAG, "level_table=%u-bit%s", level_table_bits_, level_table16_ != nullptr ? " (8.8 output)" : "");
+  }
+  if (this->is_dithering()) {
+    ESP_LOGCONFIG(TAG, "dither_interval=%ums", (unsigned) dither_interval_);
+  }
+  if (num_effect_leds_ > 0) {
+    ESP_LOGCONFIG(TAG, "effects: leds=%u interval=%ums frame_budget=%uus", num_effect_leds_,
+                  (unsigned) effect_interval_, (unsigned) effect_frame_budget_us_);
+  }
 }
 
 bool PyramidRGBComponent::set_strip_brightness(uint8_t strip, uint8_t brightness) {
@@ -51,55 +91,258 @@ bool PyramidRGBComponent::set_strip_brightness(uint8_t strip, uint8_t brightness
   return ok;
 }
 
-uint8_t PyramidRGBComponent::channel_base_addr_(uint8_t channel) const {
+void PyramidRGBComponent::start_effect(PyramidEffect effect, uint8_t r, uint8_t g, uint8_t b, uint32_t period_ms) {
+  if (effect == EFFECT_NONE) {
+    this->stop_effect();
+    return;
+  }
+  const uint32_t now = millis();
+  effects_.start(effect, r, g, b, period_ms, now);
+  // 主循环默认间隔已能满足帧间隔时不申请高频循环，避免语音阶段主循环空转占用 CPU
+  if (effect_interval_ < App.get_loop_interval()) effect_high_freq_.start();
+  ESP_LOGD(TAG, "Effect %u started: RGB=(%u,%u,%u) period=%ums", (unsigned) effect, r, g, b, (unsigned) period_ms);
+  // 第一帧立即渲染，不等下一个间隔
+  this->effect_frame_(now);
+}
+
+void PyramidRGBComponent::stop_effect() {
+  if (!effects_.is_running()) return;
+  effects_.stop();
+  effect_high_freq_.stop();
+  // 恢复灯光/输出的当前颜色，避免状态显示为开而 LED 熄灭
+  for (uint8_t i = 0; i < num_effect_leds_; i++) {
+    const uint16_t *state = state_[effect_leds_[i]];
+    this->render_led16_(effect_leds_[i], state[0], state[1], state[2]);
+  }
+  ESP_LOGD(TAG, "Effect stopped (%u frames over budget)", (unsigned) effect_overruns_);
+}
+
+void PyramidRGBComponent::effect_frame_(uint32_t now) {
+  const uint32_t started = micros();
+  uint8_t colors[NUM_LEDS][3];
+  effects_.render(now, colors, num_effect_leds_);
+  for (uint8_t i = 0; i < num_effect_leds_; i++) {
+    this->render_led_(effect_leds_[i], colors[i][0], colors[i][1], colors[i][2]);
+  }
+  // 只有变化的 LED 会被写出，总线占用随画面变化量缩放
+  this->flush();
+  const uint32_t elapsed = micros() - started;
+
+  // 固定间隔调度：下一帧按计划时间推进，而不是按本帧结束时间
+  next_effect_frame_ += effect_interval_;
+  if (elapsed > effect_frame_budget_us_) {
+    // 渲染加总线超出预算：跳过一帧把时间让给音频等任务，相位由时间决定，动画速度不变
+    effect_overruns_++;
+    next_effect_frame_ += effect_interval_;
+    ESP_LOGV(TAG, "Effect frame took %uus (budget %uus)", (unsigned) elapsed, (unsigned) effect_frame_budget_us_);
+  }
+  // 落后超过一帧时重新对齐，避免连续补帧
+  if ((int32_t) (now - next_effect_frame_) >= 0) {
+    next_effect_frame_ = now + effect_interval_;
+  }
+}
+
+uint8_t PyramidRGBComponent::led_index(uint8_t channel, uint8_t led) {
   switch (channel) {
-    case 0: return RGB_CH1_I1_COLOR_REG_ADDR; // Channel 0 -> 灯带1组1
-    case 1: return RGB_CH2_I1_COLOR_REG_ADDR; // Channel 1 -> 灯带1组2
-    case 2: return RGB_CH4_I1_COLOR_REG_ADDR; // 设备映射：channel 2 -> CH4
-    case 3: return RGB_CH3_I1_COLOR_REG_ADDR; // 设备映射：channel 3 -> CH3
-    default: return RGB_CH1_I1_COLOR_REG_ADDR;
+    // 通道 0 和 1 的 LED 顺序需要反转（索引 0..6 -> 6..0）
+    case 0: return NUM_LEDS_PER_GROUP - 1 - led;                           // Channel 0 -> 灯带1组1
+    case 1: return NUM_LEDS_PER_GROUP + (NUM_LEDS_PER_GROUP - 1 - led);    // Channel 1 -> 灯带1组2
+    case 2: return NUM_LEDS_PER_STRIP + NUM_LEDS_PER_GROUP + led;          // 设备映射：channel 2 -> CH4
+    case 3: return NUM_LEDS_PER_STRIP + led;                               // 设备映射：channel 3 -> CH3
+    default: return 0;
+  }
+}
+
+uint8_t PyramidRGBComponent::led_reg_addr_(uint8_t index) {
+  const uint8_t base = (index < NUM_LEDS_PER_STRIP) ? RGB_CH1_I1_COLOR_REG_ADDR : RGB_CH3_I1_COLOR_REG_ADDR;
+  return base + (index % NUM_LEDS_PER_STRIP) * BYTES_PER_LED;
+}
+
+void PyramidRGBComponent::set_led(uint8_t index, uint8_t r, uint8_t g, uint8_t b) {
+  if (index >= NUM_LEDS) return;
+  state_[index][0] = r << 8;
+  state_[index][1] = g << 8;
+  state_[index][2] = b << 8;
+  if (this->effect_owns_(index)) return;
+  this->render_led_(index, r, g, b);
+}
+
+void PyramidRGBComponent::set_led16(uint8_t index, uint16_t r, uint16_t g, uint16_t b) {
+  if (index >= NUM_LEDS) return;
+  state_[index][0] = r;
+  state_[index][1] = g;
+  state_[index][2] = b;
+  if (this->effect_owns_(index)) return;
+  this->render_led16_(index, r, g, b);
+}
+
+void PyramidRGBComponent::render_led_(uint8_t index, uint8_t r, uint8_t g, uint8_t b) {
+  // 8 位颜色没有小数部分，不参与抖动
+  if (dither_mask_ & (1UL << index)) {
+    dither_mask_ &= ~(1UL << index);
+    if (dither_mask_ == 0) high_freq_.stop();
   }
+  this->store_led_(index, r, g, b);
+}
+
+void PyramidRGBComponent::render_led16_(uint8_t index, uint16_t r, uint16_t g, uint16_t b) {
+  const uint16_t value[3] = {r, g, b};
+  if (!this->is_dithering() || ((r | g | b) & 0xFF) == 0) {
+    // 四舍五入到 8 位，255.x 不能再进位
+    uint8_t rounded[3];
+    for (uint8_t c = 0; c < 3; c++) {
+      rounded[c] = value[c] >= 0xFF00 ? 0xFF : (value[c] + 0x80) >> 8;
+    }
+    this->render_led_(index, rounded[0], rounded[1], rounded[2]);
+    return;
+  }
+  uint16_t *target = target_[index];
+  if (!(dither_mask_ & (1UL << index))) {
+    // 新进入抖动的 LED 从半步开始累加，平均误差最小
+    memset(accum_[index], 0x80, sizeof(accum_[index]));
+  }
+  for (uint8_t c = 0; c < 3; c++) {
+    target[c] = value[c] > 0xFF00 ? 0xFF00 : value[c];
+  }
+  if (dither_mask_ == 0) high_freq_.start();
+  dither_mask_ |= (1UL << index);
+}
+
+void PyramidRGBComponent::dither_step_() {
+  for (uint8_t i = 0; i < NUM_LEDS; i++) {
+    if ((dither_mask_ & (1UL << i)) == 0) continue;
+    uint8_t out[3];
+    for (uint8_t c = 0; c < 3; c++) {
+      // 误差累加：小数部分累计溢出时本帧输出高一级，长期平均等于目标值
+      const uint16_t sum = accum_[i][c] + (target_[i][c] & 0xFF);
+      accum_[i][c] = sum & 0xFF;
+      out[c] = (target_[i][c] >> 8) + (sum >> 8);
+    }
+    this->store_led_(i, out[0], out[1], out[2]);
+  }
+}
+
+void PyramidRGBComponent::store_led_(uint8_t index, uint8_t r, uint8_t g, uint8_t b) {
+  uint8_t *led = frame_[index];
+  if (led[0] == b && led[1] == g && led[2] == r) return;
+  led[0] = b;
+  led[1] = g;
+  led[2] = r;
+  dirty_ |= (1UL << index);
+}
+
+bool PyramidRGBComponent::flush() {
+  bool all_ok = true;
+  // 按灯带扫描脏位，连续的脏 LED 合并为一次区间写入；两条灯带寄存器不连续，不跨灯带合并
+  for (uint8_t strip_start = 0; strip_start < NUM_LEDS; strip_start += NUM_LEDS_PER_STRIP) {
+    const uint8_t strip_end = strip_start + NUM_LEDS_PER_STRIP;
+    uint8_t i = strip_start;
+    while (i < strip_end) {
+      if ((dirty_ & (1UL << i)) == 0) {
+        i++;
+        continue;
+      }
+      uint8_t end = i + 1;
+      while (end < strip_end && (dirty_ & (1UL << end))) end++;
+      const uint8_t count = end - i;
+      const uint32_t run_mask = ((1UL << count) - 1) << i;
+      if (write_led_range_(led_reg_addr_(i), frame_[i], count)) {
+        dirty_ &= ~run_mask;
+      } else {
+        all_ok = false;
+      }
+      ESP_LOGV(TAG, "Flush LEDs %u..%u -> %s", i, end - 1, (dirty_ & run_mask) ? "FAIL" : "OK");
+      i = end;
+    }
+  }
+  return all_ok;
 }
 
 bool PyramidRGBComponent::write_color_block_(uint8_t base_reg_addr, const uint8_t *color_bytes, size_t len) {
-  // 组装寄存器+数据的写入缓冲区
-  const size_t total = len + 1;
-  uint8_t *buf = (uint8_t *) malloc(total);
-  if (buf == nullptr) return false;
+  if (len > MAX_BURST_BYTES) return false;
+  // 组装寄存器+数据的写入缓冲区，最多一条灯带，放在栈上避免每次写入都分配堆内存
+  uint8_t buf[MAX_BURST_BYTES + 1];
   buf[0] = base_reg_addr;
   memcpy(buf + 1, color_bytes, len);
-  bool ok = this->write(buf, total);
-  free(buf);
+  bool ok = this->write(buf, len + 1) == i2c::ERROR_OK;
+  ESP_LOGV(TAG, "Write reg=0x%02X len=%u -> %s", base_reg_addr, (unsigned) len, ok ? "OK" : "FAIL");
   return ok;
 }
 
+bool PyramidRGBComponent::write_led_range_(uint8_t base_reg_addr, const uint8_t *led_bytes, uint8_t count) {
+  if (burst_supported_) {
+    return write_color_block_(base_reg_addr, led_bytes, count * BYTES_PER_LED);
+  }
+  // 固件不支持自增写：逐 LED 写入
+  bool all_ok = true;
+  for (uint8_t i = 0; i < count; i++) {
+    bool ok = write_color_block_(base_reg_addr + i * BYTES_PER_LED, led_bytes + i * BYTES_PER_LED, BYTES_PER_LED);
+    all_ok = all_ok && ok;
+  }
+  return all_ok;
+}
+
+bool PyramidRGBComponent::detect_burst_support_() {
+  // 测试会临时改写通道 0 的前两个 LED；同一设备上的其他实例可能已点亮它们，先逐字节保存原值，结束后原样恢复
+  uint8_t saved[2 * BYTES_PER_LED];
+  for (uint8_t i = 0; i < sizeof(saved); i++) {
+    if (this->read_register(RGB_CH1_I1_COLOR_REG_ADDR + i, saved + i, 1) != i2c::ERROR_OK) {
+      // 无法保存原值则不做测试，按不支持自增处理（逐 LED 写入始终可用）
+      return false;
+    }
+  }
+  // 写入可区分的极暗测试值并读回；第二个 LED 的值只有在地址自增时才会写入正确位置
+  const uint8_t pattern[2 * BYTES_PER_LED] = {0x01, 0x02, 0x03, 0x00, 0x04, 0x05, 0x06, 0x00};
+  uint8_t readback[sizeof(pattern)] = {0};
+  bool supported = write_color_block_(RGB_CH1_I1_COLOR_REG_ADDR, pattern, sizeof(pattern)) &&
+                   this->read_register(RGB_CH1_I1_COLOR_REG_ADDR, readback, sizeof(readback)) == i2c::ERROR_OK &&
+                   memcmp(pattern, readback, sizeof(pattern)) == 0;
+  // 恢复原值（逐 LED 写入，不依赖检测结果）
+  write_color_block_(RGB_CH1_I1_COLOR_REG_ADDR, saved, BYTES_PER_LED);
+  write_color_block_(RGB_CH1_I1_COLOR_REG_ADDR + BYTES_PER_LED, saved + BYTES_PER_LED, BYTES_PER_LED);
+  return supported;
+}
+
 bool PyramidRGBComponent::set_channel_color(uint8_t channel, uint8_t r, uint8_t g, uint8_t b) {
+  return this->set_channel_color16(channel, r << 8, g << 8, b << 8);
+}
+
+bool PyramidRGBComponent::set_channel_color16(uint8_t channel, uint16_t r, uint16_t g, uint16_t b) {
   if (channel >= NUM_RGB_CHANNELS) return false;
   channel_colors_[channel][0] = r;
   channel_colors_[channel][1] = g;
   channel_colors_[channel][2] = b;
 
-  // 每个 LED 4 字节：B, G, R, reserved（按硬件定义）
-  // 逐 LED 写入，避免设备不支持连续自增写导致失败
-  uint8_t base = channel_base_addr_(channel);
-  bool all_ok = true;
   for (uint8_t i = 0; i < NUM_LEDS_PER_GROUP; i++) {
-    // 通道 0 和 1 的 LED 顺序需要反转（索引 0..6 -> 6..0）
-    uint8_t hardware_index = i;
-    if (channel == 0 || channel == 1) {
-      hardware_index = NUM_LEDS_PER_GROUP - 1 - i;
-    }
-    uint8_t reg = base + (hardware_index * 4);
-    uint8_t led_bytes[4] = {b, g, r, 0x00};
-    bool ok = write_color_block_(reg, led_bytes, sizeof(led_bytes));
-    ESP_LOGD(TAG, "Set color LED: ch=%u led=%u reg=0x%02X RGB=(%u,%u,%u) -> %s",
-             channel, i, reg, r, g, b, ok ? "OK" : "FAIL");
-    all_ok = all_ok && ok;
+    this->set_led16(led_index(channel, i), r, g, b);
   }
-  return all_ok;
+  ESP_LOGV(TAG, "Set color: ch=%u RGB=(0x%04X,0x%04X,0x%04X)", channel, r, g, b);
+  return true;
+}
+
+bool PyramidRGBComponent::set_strip_color(uint8_t strip, uint8_t r, uint8_t g, uint8_t b) {
+  if (strip < 1 || strip > 2) return false;
+  // 灯带1 = 通道 0/1，灯带2 = 通道 2/3
+  const uint8_t first = (strip == 1) ? 0 : 2;
+  for (uint8_t ch = first; ch < first + 2; ch++) {
+    channel_colors_[ch][0] = r << 8;
+    channel_colors_[ch][1] = g << 8;
+    channel_colors_[ch][2] = b << 8;
+  }
+  // 整条灯带的 14 个 LED 在帧缓冲中连续，刷新时合并为一次 56 字节写入
+  const uint8_t start = (strip == 1) ? 0 : NUM_LEDS_PER_STRIP;
+  for (uint8_t i = start; i < start + NUM_LEDS_PER_STRIP; i++) {
+    this->set_led(i, r, g, b);
+  }
+  ESP_LOGV(TAG, "Set strip color: strip=%u RGB=(%u,%u,%u)", strip, r, g, b);
+  return true;
 }
 
 bool PyramidRGBComponent::set_channel_color_component(uint8_t channel, RGBColorChannel color, uint8_t value) {
+  return this->set_channel_color_component16(channel, color, value << 8);
+}
+
+bool PyramidRGBComponent::set_channel_color_component16(uint8_t channel, RGBColorChannel color, uint16_t value) {
   if (channel >= NUM_RGB_CHANNELS) return false;
   switch (color) {
     case COLOR_R: channel_colors_[channel][0] = value; break;
@@ -107,16 +350,44 @@ bool PyramidRGBComponent::set_channel_color_component(uint8_t channel, RGBColorC
     case COLOR_B: channel_colors_[channel][2] = value; break;
     default: return false;
   }
-  ESP_LOGD(TAG, "Set component: ch=%u comp=%d val=%u", channel, (int) color, value);
-  return set_channel_color(channel,
-                           channel_colors_[channel][0],
-                           channel_colors_[channel][1],
-                           channel_colors_[channel][2]);
+  ESP_LOGV(TAG, "Set component: ch=%u comp=%d val=0x%04X", channel, (int) color, value);
+  return set_channel_color16(channel,
+                             channel_colors_[channel][0],
+                             channel_colors_[channel][1],
+                             channel_colors_[channel][2]);
+}
+
+uint32_t PyramidRGBComponent::level_table_index_(RGBColorChannel color, float level) const {
+  // 按表的分辨率量化输入，gamma 与电流缩放已包含在表中
+  const uint32_t max_index = (1UL << level_table_bits_) - 1;
+  return (uint32_t) color * (max_index + 1) + (uint32_t) (level * max_index + 0.5f);
 }
 
 uint8_t PyramidRGBComponent::map_level(RGBColorChannel color, float level) const {
   if (level <= 0.0f) return 0;
   if (level >= 1.0f) level = 1.0f;
+  if (color <= COLOR_B) {
+    // 一次查表
+    if (level_table_ != nullptr) return progmem_read_byte(&level_table_[level_table_index_(color, level)]);
+    if (level_table16_ != nullptr) {
+      const uint16_t v = progmem_read_uint16(&level_table16_[level_table_index_(color, level)]);
+      return v >= 0xFF00 ? 0xFF : (v + 0x80) >> 8;
+    }
+  }
+  return (uint8_t) (compute_level_(color, level) * 255.0f + 0.5f);
+}
+
+uint16_t PyramidRGBComponent::map_level16(RGBColorChannel color, float level) const {
+  if (level <= 0.0f) return 0;
+  if (level >= 1.0f) level = 1.0f;
+  if (color <= COLOR_B) {
+    if (level_table16_ != nullptr) return progmem_read_uint16(&level_table16_[level_table_index_(color, level)]);
+    if (level_table_ != nullptr) return progmem_read_byte(&level_table_[level_table_index_(color, level)]) << 8;
+  }
+  return (uint16_t) (compute_level_(color, level) * 65280.0f + 0.5f);
+}
+
+float PyramidRGBComponent::compute_level_(RGBColorChannel color, float level) const {
   float x = level;
   // Apply gamma/logarithmic dimming if enabled
   float g = gamma_;
@@ -135,7 +406,7 @@ uint8_t PyramidRGBComponent::map_level(RGBColorChannel color, float level) const
   x *= scale;
   if (x > 1.0f) x = 1.0f;
   if (x < 0.0f) x = 0.0f;
-  return (uint8_t) (x * 255.0f + 0.5f);
+  return x;
 }
 
 }  // namespace pyramidrgb
@@ -3,6 +3,8 @@
 #include "esphome/core/component.h"
 #include "esphome/components/i2c/i2c.h"
 #include "esphome/core/log.h"
+#include "esphome/core/helpers.h"
+#include "pyramidrgb_effects.h"
 
 namespace esphome {
 namespace pyramidrgb {
@@ -25,10 +27,17 @@ static const uint8_t RGB_CH4_I1_COLOR_REG_ADDR = 0x7C; // Channel 3, 灯带2组2
 
 static const uint8_t NUM_RGB_CHANNELS = 4; // 4个通道（2条灯带 × 2组）
 static const uint8_t NUM_LEDS_PER_GROUP = 7; // 每组7个LED
+static const uint8_t BYTES_PER_LED = 4; // B, G, R, reserved
+// 一条灯带的两组寄存器连续排列（组1 LED0..6 之后紧跟组2 LED0..6），可一次写完 56 字节
+static const uint8_t NUM_LEDS_PER_STRIP = NUM_LEDS_PER_GROUP * 2;
+static const size_t MAX_BURST_BYTES = NUM_LEDS_PER_STRIP * BYTES_PER_LED;
+// 帧缓冲按硬件顺序排列：0..13 = 灯带1（0x20 起），14..27 = 灯带2（0x60 起）
+static const uint8_t NUM_LEDS = NUM_LEDS_PER_STRIP * 2;
 
 class PyramidRGBComponent : public i2c::I2CDevice, public Component {
  public:
   void setup() override;
+  void loop() override;
   void dump_config() override;
   float get_setup_priority() const override { return esphome::setup_priority::HARDWARE; }
 
@@ -37,12 +46,40 @@ class PyramidRGBComponent : public i2c::I2CDevice, public Component {
   void set_initial_brightness(uint8_t brightness) { initial_brightness_ = brightness; }
   void set_initial_white(uint8_t white) { initial_white_level_ = white; }
   // Dimming/scaling configuration setters
-  void set_logarithmic_dimming(bool v) { logarithmic_dimming_ = v; }
-  void set_gamma(float v) { gamma_ = v; }
+  // 修改映射参数会使 codegen 生成的查找表失效，之后 map_level 改为实时计算
+  void set_logarithmic_dimming(bool v) {
+    logarithmic_dimming_ = v;
+    drop_level_table_();
+  }
+  void set_gamma(float v) {
+    gamma_ = v;
+    drop_level_table_();
+  }
   void set_use_internal_clk(bool v) { use_internal_clk_ = v; }
   void set_power_save_mode(bool v) { power_save_mode_ = v; }
   void set_high_pwm_freq(bool v) { high_pwm_freq_ = v; }
-  void set_ref_current(float v) { ref_current_ = v; }
+  void set_ref_current(float v) {
+    ref_current_ = v;
+    drop_level_table_();
+  }
+  // 时间抖动的刷新周期（毫秒），0 表示关闭
+  void set_dither_interval(uint32_t interval_ms) { dither_interval_ = interval_ms; }
+  bool is_dithering() const { return dither_interval_ > 0; }
+  // 灯效引擎：参与灯效的通道（按顺序拼成逻辑灯带）、固定帧间隔与每帧预算
+  void add_effect_channel(uint8_t channel) {
+    for (uint8_t i = 0; i < NUM_LEDS_PER_GROUP && num_effect_leds_ < NUM_LEDS; i++) {
+      effect_leds_[num_effect_leds_] = led_index(channel, i);
+      effect_mask_ |= (1UL << effect_leds_[num_effect_leds_++]);
+    }
+  }
+  void set_effect_interval(uint32_t interval_ms) { effect_interval_ = interval_ms; }
+  void set_effect_frame_budget(uint32_t budget_us) { effect_frame_budget_us_ = budget_us; }
+
+  // 启动灯效（颜色为设备值 0..255）；运行期间灯效通道上由灯光/输出写入的颜色只被记录，不显示
+  void start_effect(PyramidEffect effect, uint8_t r, uint8_t g, uint8_t b, uint32_t period_ms);
+  // 停止灯效，灯效通道恢复为灯光/输出的当前颜色
+  void stop_effect();
+  bool is_effect_running() const { return effects_.is_running(); }
   void set_color_currents(float r, float g, float b, float w) {
     red_current_ = r; green_current_ = g; blue_current_ = b; white_current_ = w;
     // Compute scales vs reference
@@ -50,28 +87,118 @@ class PyramidRGBComponent : public i2c::I2CDevice, public Component {
     green_scale_ = (ref_current_ > 0) ? (green_current_ / ref_current_) : 1.0f;
     blue_scale_ = (ref_current_ > 0) ? (blue_current_ / ref_current_) : 1.0f;
     white_scale_ = (ref_current_ > 0) ? (white_current_ / ref_current_) : 1.0f;
+    drop_level_table_();
   }
 
   // 设置亮度：strip=1 或 2，brightness 0..100
   bool set_strip_brightness(uint8_t strip, uint8_t brightness);
 
+  // 以下颜色设置只更新帧缓冲并标记脏 LED，由 loop() 每轮统一刷新到设备
+
   // 设置某个通道的 RGB 颜色（0..255），会更新该通道下的所有 7 个 LED
   bool set_channel_color(uint8_t channel, uint8_t r, uint8_t g, uint8_t b);
 
+  // 设置整条灯带（两组共 14 个 LED）的颜色
+  bool set_strip_color(uint8_t strip, uint8_t r, uint8_t g, uint8_t b);
+
+  // 设置单个 LED 的颜色，index 为硬件顺序（见 NUM_LEDS）
+  void set_led(uint8_t index, uint8_t r, uint8_t g, uint8_t b);
+  // 通道内第 led 个 LED 对应的硬件索引（处理通道映射与通道 0/1 的顺序反转）
+  static uint8_t led_index(uint8_t channel, uint8_t led);
+
+  // 立即把脏 LED 写入设备，返回 false 表示有写入失败（对应 LED 保持脏状态，下轮重试）
+  bool flush();
+
+  // Whether the controller accepted a multi-LED auto-increment write at setup
+  bool supports_burst() const { return burst_supported_; }
+
   // 设置单一颜色分量（0..255），内部保留上次 R/G/B 值
   bool set_channel_color_component(uint8_t channel, RGBColorChannel color, uint8_t value);
 
+  // 高精度版本：颜色为 8.8 定点数（高字节为寄存器值，低字节为小数部分），
+  // 开启抖动时小数部分在连续帧间分摊，关闭时四舍五入为 8 位
+  void set_led16(uint8_t index, uint16_t r, uint16_t g, uint16_t b);
+  bool set_channel_color16(uint8_t channel, uint16_t r, uint16_t g, uint16_t b);
+  bool set_channel_color_component16(uint8_t channel, RGBColorChannel color, uint16_t value);
+
   // Map FloatOutput level [0..1] to device value [0..255] using dimming/scaling
   uint8_t map_level(RGBColorChannel color, float level) const;
+  // Same mapping with 8.8 fixed-point output, for dithered writes
+  uint16_t map_level16(RGBColorChannel color, float level) const;
+
+  // 由 codegen 预先计算的查找表（R, G, B 各 2^bits 项，存放在 flash 中）；未设置时 map_level 实时计算。
+  // 映射为恒等时（无 gamma、各色电流等于参考电流）codegen 不生成查找表。须在映射参数设置之后调用
+  void set_level_table(const uint8_t *table, uint8_t bits) {
+    level_table_ = table;
+    level_table_bits_ = bits;
+  }
+  // 开启抖动时 codegen 生成 8.8 定点数的查找表
+  void set_level_table16(const uint16_t *table, uint8_t bits) {
+    level_table16_ = table;
+    level_table_bits_ = bits;
+  }
 
  private:
-  // 写入颜色数据到设备
+  // 写入颜色数据到设备（单次传输，缓冲区在栈上）
   bool write_color_block_(uint8_t base_reg_addr, const uint8_t *color_bytes, size_t len);
-  // 获取通道基址并处理通道映射/索引反转
-  uint8_t channel_base_addr_(uint8_t channel) const;
-
-  // 保存每个通道的当前 RGB 值
-  uint8_t channel_colors_[NUM_RGB_CHANNELS][3] = {{0}};
+  // 写入从 base_reg_addr 开始的连续 LED（每个 4 字节）；不支持自增写时逐 LED 写入
+  bool write_led_range_(uint8_t base_reg_addr, const uint8_t *led_bytes, uint8_t count);
+  // 写入两个 LED 后读回，判断 STM32 固件是否支持寄存器地址自增
+  bool detect_burst_support_();
+  // map_level 的浮点实现，没有查找表时使用；返回 0..1
+  float compute_level_(RGBColorChannel color, float level) const;
+  // 查找表索引；表中 R/G/B 依次排列
+  uint32_t level_table_index_(RGBColorChannel color, float level) const;
+  void drop_level_table_() {
+    level_table_ = nullptr;
+    level_table16_ = nullptr;
+  }
+  // 把颜色渲染到帧缓冲（处理抖动状态），不记录为灯光/输出的颜色
+  void render_led_(uint8_t index, uint8_t r, uint8_t g, uint8_t b);
+  void render_led16_(uint8_t index, uint16_t r, uint16_t g, uint16_t b);
+  // 更新帧缓冲中的一个 LED（不改变抖动状态）
+  void store_led_(uint8_t index, uint8_t r, uint8_t g, uint8_t b);
+  // 灯效运行中且该 LED 属于灯效通道
+  bool effect_owns_(uint8_t index) const { return effects_.is_running() && (effect_mask_ & (1UL << index)); }
+  // 对有小数部分的 LED 推进一帧误差累加
+  void dither_step_();
+  // 按固定间隔渲染并刷新一帧灯效
+  void effect_frame_(uint32_t now);
+
+  // 硬件索引对应的颜色寄存器地址
+  static uint8_t led_reg_addr_(uint8_t index);
+
+  // 保存每个通道的当前 RGB 值（8.8 定点数）
+  uint16_t channel_colors_[NUM_RGB_CHANNELS][3] = {{0}};
+
+  // 灯光/输出最近写入的颜色（8.8 定点数 R, G, B），灯效停止后据此重新渲染
+  uint16_t state_[NUM_LEDS][3] = {{0}};
+
+  // 帧缓冲：每个 LED 按寄存器格式保存 B, G, R, reserved
+  uint8_t frame_[NUM_LEDS][BYTES_PER_LED] = {{0}};
+  // 每个 LED 一位，置位表示帧缓冲与设备不一致
+  uint32_t dirty_ {0};
+
+  // 时间抖动：每个 LED 的 8.8 目标值与小数累加器，dither_mask_ 标记目标带小数部分的 LED
+  uint32_t dither_interval_ {0};
+  uint32_t last_dither_ {0};
+  uint32_t dither_mask_ {0};
+  uint16_t target_[NUM_LEDS][3] = {{0}};
+  uint8_t accum_[NUM_LEDS][3] = {{0}};
+  HighFrequencyLoopRequester high_freq_;
+
+  // 灯效引擎
+  PyramidRGBEffectEngine effects_;
+  uint8_t effect_leds_[NUM_LEDS] = {0};  // 逻辑索引 -> 硬件索引
+  uint8_t num_effect_leds_ {0};
+  uint32_t effect_mask_ {0};  // 灯效通道的 LED，硬件索引位图
+  uint32_t effect_interval_ {20};
+  uint32_t effect_frame_budget_us_ {3000};
+  uint32_t next_effect_frame_ {0};
+  uint32_t effect_overruns_ {0};
+  HighFrequencyLoopRequester effect_high_freq_;
+
+  bool burst_supported_ {false};
 
   // 初始参数
   uint8_t initial_strip_ {1};
@@ -87,6 +214,10 @@ class PyramidRGBComponent : public i2c::I2CDevice, public Component {
   float ref_current_ {22.5f};
   float red_current_ {22.5f}, green_current_ {22.5f}, blue_current_ {22.5f}, white_current_ {22.5f};
   float red_scale_ {1.0f}, green_scale_ {1.0f}, blue_scale_ {1.0f}, white_scale_ {1.0f};
+
+  const uint8_t *level_table_ {nullptr};
+  const uint16_t *level_table16_ {nullptr};
+  uint8_t level_table_bits_ {0};
 };
 
 }  // namespace pyramidrgb
@@ -0,0 +1,83 @@
+#include "pyramidrgb_effects.h"
+#include "pyramidrgb.h"
+#include "esphome/core/hal.h"
+
+namespace esphome {
+namespace pyramidrgb {
+
+// 一个周期的升余弦 (1 - cos) / 2，64 段，末尾重复首项便于插值
+static const uint8_t WAVE_TABLE[65] PROGMEM = {
+    0,   1,   2,   5,   10,  15,  21,  29,  37,  47,  57,  67,  79,  90,  103, 115,
+    128, 140, 152, 165, 176, 188, 198, 208, 218, 226, 234, 240, 245, 250, 253, 254,
+    255, 254, 253, 250, 245, 240, 234, 226, 218, 208, 198, 188, 176, 165, 152, 140,
+    128, 115, 103, 90,  79,  67,  57,  47,  37,  29,  21,  15,  10,  5,   2,   1,
+    0,
+};
+
+static const uint32_t MAX_EFFECT_PERIOD_MS = 60000;
+
+void PyramidRGBEffectEngine::start(PyramidEffect effect, uint8_t r, uint8_t g, uint8_t b, uint32_t period_ms,
+                                   uint32_t now) {
+  effect_ = effect;
+  color_[0] = r;
+  color_[1] = g;
+  color_[2] = b;
+  if (period_ms == 0) period_ms = 1;
+  period_ms_ = period_ms > MAX_EFFECT_PERIOD_MS ? MAX_EFFECT_PERIOD_MS : period_ms;
+  start_ms_ = now;
+}
+
+uint8_t PyramidRGBEffectEngine::wave_(uint16_t phase) {
+  // 高 6 位选段，接下来 8 位做线性插值
+  const uint8_t index = phase >> 10;
+  const uint16_t frac = (phase >> 2) & 0xFF;
+  const int16_t a = progmem_read_byte(&WAVE_TABLE[index]);
+  const int16_t b = progmem_read_byte(&WAVE_TABLE[index + 1]);
+  return a + (((b - a) * (int16_t) frac) >> 8);
+}
+
+uint8_t PyramidRGBEffectEngine::tail_(uint32_t distance, uint32_t length) {
+  if (distance >= length) return 0;
+  // 线性渐隐后平方，尾部在低亮度区衰减得更自然
+  const uint32_t level = 255 - (distance * 255) / length;
+  return (level * level + 255) >> 8;
+}
+
+void PyramidRGBEffectEngine::render(uint32_t now, uint8_t (*out)[3], uint8_t count) const {
+  if (count == 0) return;
+  // 当前周期内的相位，0..65535
+  const uint32_t phase = ((now - start_ms_) % period_ms_ * 65536UL) / period_ms_;
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t level = 0;
+    switch (effect_) {
+      case EFFECT_BREATHE:
+        level = wave_(phase);
+        break;
+      case EFFECT_SPIN: {
+        // 亮点位置与 LED 位置均为 8.8 定点数，距离按环形计算，尾巴长度为半圈
+        const uint32_t ring = (uint32_t) count << 8;
+        const uint32_t head = (phase * count) >> 8;
+        const uint32_t distance = (head + ring - ((uint32_t) i << 8)) % ring;
+        level = tail_(distance, ring / 2);
+        break;
+      }
+      case EFFECT_CHASE: {
+        // 每 NUM_LEDS_PER_GROUP 个 LED 一个亮点，亮度在相邻两个 LED 之间交叉过渡
+        const uint8_t spacing = count < NUM_LEDS_PER_GROUP ? count : NUM_LEDS_PER_GROUP;
+        const uint32_t span = (uint32_t) spacing << 8;
+        const uint32_t head = (phase * spacing) >> 8;
+        const uint32_t distance = (head + span - ((uint32_t) (i % spacing) << 8)) % span;
+        level = tail_(distance < span - distance ? distance : span - distance, 256);
+        break;
+      }
+      default:
+        break;
+    }
+    for (uint8_t c = 0; c < 3; c++) {
+      out[i][c] = (color_[c] * (level + 1)) >> 8;
+    }
+  }
+}
+
+}  // namespace pyramidrgb
+}  // namespace esphome
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+namespace pyramidrgb {
+
+// 内置灯效；listening/thinking/replying 等预设在 codegen 中展开为灯效 + 颜色 + 周期
+enum PyramidEffect : uint8_t {
+  EFFECT_NONE = 0,
+  EFFECT_BREATHE = 1,  // 所有 LED 同步呼吸
+  EFFECT_SPIN = 2,     // 一个亮点带渐隐尾巴沿灯带旋转
+  EFFECT_CHASE = 3,    // 每组一个亮点，相邻 LED 之间平滑过渡
+};
+
+// 定点数、查表实现的灯效渲染器，只负责计算颜色，不接触总线。
+// 相位只由经过的时间决定，丢帧不会改变动画速度。
+class PyramidRGBEffectEngine {
+ public:
+  void start(PyramidEffect effect, uint8_t r, uint8_t g, uint8_t b, uint32_t period_ms, uint32_t now);
+  void stop() { effect_ = EFFECT_NONE; }
+  bool is_running() const { return effect_ != EFFECT_NONE; }
+  PyramidEffect get_effect() const { return effect_; }
+
+  // 渲染 now 时刻的一帧：out 为 count 个逻辑 LED 的 R, G, B
+  void render(uint32_t now, uint8_t (*out)[3], uint8_t count) const;
+
+ protected:
+  // 升余弦波形，phase 为 0..65535 的一个周期，返回 0..255
+  static uint8_t wave_(uint16_t phase);
+  // 距离亮点 distance（8.8 定点数，单位 LED）处的亮度，length 为渐隐长度
+  static uint8_t tail_(uint32_t distance, uint32_t length);
+
+  PyramidEffect effect_ {EFFECT_NONE};
+  uint8_t color_[3] = {0};
+  uint32_t period_ms_ {1000};
+  uint32_t start_ms_ {0};
+};
+
+}  // namespace pyramidrgb
+}  // namespace esphome
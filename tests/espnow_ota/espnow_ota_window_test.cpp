@@ -0,0 +1,366 @@
+// End-to-end test of the ESP-NOW OTA protocol over a simulated radio.
+//
+// One sender pushes an image to several receivers at once. Every link is a lossy FIFO (ESP-NOW delivers frames to
+// one peer in order) with a fixed latency. Both ends run the session classes espnow_ota.cpp is built on; the glue
+// below only does what the component does around them: turn actions into frames, write chunks to a stand-in for the
+// OTA backend, verify the image at END and reboot the receiver some time after a successful update.
+
+#include "../../components/espnow_switch/espnow/ota/espnow_ota_window.h"
+
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <vector>
+
+using esphome::espnow::ESPNOW_OTA_ADDR_LEN;
+using esphome::espnow::ESPNOW_OTA_CHUNK_SIZE;
+using esphome::espnow::ESPNOW_OTA_REBOOT_DELAY;
+using esphome::espnow::ESPNOW_OTA_TARGET_TIMEOUT;
+using esphome::espnow::ESPNowOTAReceiveSession;
+using esphome::espnow::ESPNowOTAReceiveWindow;
+using esphome::espnow::ESPNowOTASendSession;
+
+static constexpr uint32_t AIRTIME = 1;        // ms per frame
+static constexpr uint32_t LATENCY = 5;        // ms from send to delivery
+static constexpr uint32_t START = 1000;       // ms, the simulated clock starts after boot
+static constexpr uint32_t DEADLINE = 600000;  // ms
+static constexpr uint16_t SESSION = 0x5A17;
+static constexpr uint8_t RESULT_OK = 0;       // as ota::OTA_RESPONSE_OK
+static constexpr uint8_t RESULT_ERROR = 1;
+static const uint8_t SENDER[ESPNOW_OTA_ADDR_LEN] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0x01};
+
+enum Opcode : uint8_t { BEGIN = 1, DATA, ACK, END, RESULT, ABORT, OPCODE_COUNT };
+
+struct Frame {
+  uint32_t due;
+  Opcode opcode;
+  uint32_t seq;  // Data: chunk number, ack: base
+  uint32_t bitmap;
+  uint8_t error;
+  std::vector<uint8_t> payload;
+};
+
+/// A one-way radio link that drops frames at random or on purpose and keeps the survivors in order.
+class Link {
+ public:
+  Link(std::mt19937 &rng, double loss) : rng_(rng), loss_(loss) {}
+
+  /// Drop the next `count` frames with `opcode`.
+  void drop_next(Opcode opcode, uint32_t count) { this->drop_[opcode] = count; }
+  /// Drop every frame from now on.
+  void cut() { this->cut_ = true; }
+
+  void send(uint32_t now, Frame frame) {
+    this->sent_[frame.opcode]++;
+    if (this->cut_ || this->drop_[frame.opcode] > 0) {
+      if (this->drop_[frame.opcode] > 0)
+        this->drop_[frame.opcode]--;
+      return;
+    }
+    if (std::uniform_real_distribution<double>(0.0, 1.0)(this->rng_) < this->loss_)
+      return;
+    frame.due = now + LATENCY;
+    this->frames_.push_back(std::move(frame));
+  }
+  bool receive(uint32_t now, Frame *frame) {
+    if (this->frames_.empty() || this->frames_.front().due > now)
+      return false;
+    *frame = std::move(this->frames_.front());
+    this->frames_.pop_front();
+    return true;
+  }
+  uint32_t sent(Opcode opcode) const { return this->sent_[opcode]; }
+  bool idle() const { return this->frames_.empty(); }
+
+ protected:
+  std::mt19937 &rng_;
+  double loss_;
+  bool cut_{false};
+  uint32_t drop_[OPCODE_COUNT]{};
+  uint32_t sent_[OPCODE_COUNT]{};
+  std::deque<Frame> frames_;
+};
+
+struct Peer {
+  Peer(std::mt19937 &rng, double loss) : downlink(rng, loss), uplink(rng, loss) {}
+
+  Link downlink;  // Sender to receiver
+  Link uplink;    // Receiver to sender
+  // Sender side, like ESPNowOTAComponent::Target
+  ESPNowOTASendSession send;
+  std::deque<uint32_t> queued;  // Send completion times of chunks in flight
+  uint32_t finished_ms{0};
+  // Receiver side, like ESPNowOTAComponent::Receive
+  ESPNowOTAReceiveSession receive;
+  std::vector<uint8_t> written;  // Stand-in for the OTA backend
+  bool corrupt{false};           // Fail verification at END
+  uint32_t reboot_ms{0};
+  bool rebooted{false};
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Receiver, as handle_begin_(), handle_data_(), handle_end_() and the ABORT case of on_frame()
+
+static void send_ack(Peer &peer, uint32_t now) {
+  peer.receive.acked();
+  peer.uplink.send(now, Frame{0, ACK, peer.receive.window().base(), peer.receive.window().bitmap(), 0, {}});
+}
+
+static void send_result(Peer &peer, uint32_t now, uint8_t error) {
+  peer.uplink.send(now, Frame{0, RESULT, 0, 0, error, {}});
+}
+
+static void receive_frame(Peer &peer, const Frame &frame, uint32_t image_size, uint32_t now) {
+  ESPNowOTAReceiveSession &rx = peer.receive;
+  switch (frame.opcode) {
+    case BEGIN:
+      switch (rx.on_begin(SENDER, SESSION)) {
+        case ESPNowOTAReceiveSession::BEGIN_REPEAT_ACK:
+          send_ack(peer, now);
+          return;
+        case ESPNowOTAReceiveSession::BEGIN_BUSY:
+          send_result(peer, now, RESULT_ERROR);
+          return;
+        default:
+          break;
+      }
+      rx.start(SENDER, SESSION, image_size, ESPNOW_OTA_CHUNK_SIZE);
+      peer.written.clear();
+      send_ack(peer, now);
+      return;
+    case DATA: {
+      if (!rx.matches(SENDER, SESSION))
+        return;
+      switch (rx.window().accept(frame.seq, frame.payload.data(), frame.payload.size())) {
+        case ESPNowOTAReceiveWindow::ACCEPT_OUT_OF_WINDOW:
+          send_ack(peer, now);
+          return;
+        case ESPNowOTAReceiveWindow::ACCEPT_BAD_LENGTH:
+          std::printf("  chunk %u has a bad length\n", frame.seq);
+          return;
+        default:
+          break;
+      }
+      const uint8_t *chunk;
+      uint16_t length;
+      while (rx.window().front(&chunk, &length)) {
+        peer.written.insert(peer.written.end(), chunk, chunk + length);
+        rx.window().pop();
+      }
+      if (rx.on_stored())
+        send_ack(peer, now);
+      return;
+    }
+    case END:
+      switch (rx.on_end(SENDER, SESSION)) {
+        case ESPNowOTAReceiveSession::END_ACK:
+          send_ack(peer, now);
+          return;
+        case ESPNowOTAReceiveSession::END_REPEAT_RESULT:
+          send_result(peer, now, rx.result());
+          return;
+        case ESPNowOTAReceiveSession::END_FINISH:
+          break;
+        default:
+          return;
+      }
+      rx.finish(peer.corrupt ? RESULT_ERROR : RESULT_OK);
+      send_result(peer, now, rx.result());
+      if (rx.result() == RESULT_OK)
+        peer.reboot_ms = now + ESPNOW_OTA_REBOOT_DELAY;
+      return;
+    case ABORT:
+      if (rx.matches(SENDER, SESSION))
+        rx.abort();
+      return;
+    default:
+      return;
+  }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Sender, as service_target_(), send_chunk_(), handle_ack_() and handle_result_()
+
+static void service_sender(Peer &peer, const std::vector<uint8_t> &image, uint32_t total_chunks, uint32_t now) {
+  while (!peer.queued.empty() && peer.queued.front() <= now) {
+    peer.queued.pop_front();
+    peer.send.send_done();
+  }
+  switch (peer.send.service(now)) {
+    case ESPNowOTASendSession::ACTION_ABORT:
+      peer.downlink.send(now, Frame{0, ABORT, 0, 0, 0, {}});
+      return;
+    case ESPNowOTASendSession::ACTION_BEGIN:
+      peer.downlink.send(now, Frame{0, BEGIN, 0, 0, 0, {}});
+      return;
+    case ESPNowOTASendSession::ACTION_END:
+      peer.downlink.send(now, Frame{0, END, 0, 0, 0, {}});
+      return;
+    case ESPNowOTASendSession::ACTION_DATA:
+      break;
+    default:
+      return;
+  }
+
+  uint32_t seq;
+  while (peer.send.next_chunk(total_chunks, &seq)) {
+    const uint32_t offset = seq * ESPNOW_OTA_CHUNK_SIZE;
+    const size_t length = std::min<size_t>(ESPNOW_OTA_CHUNK_SIZE, image.size() - offset);
+    Frame frame{0, DATA, seq, 0, 0, std::vector<uint8_t>(image.begin() + offset, image.begin() + offset + length)};
+    peer.downlink.send(now, std::move(frame));
+    peer.queued.push_back(now + AIRTIME * (peer.queued.size() + 1));
+    peer.send.chunk_sent(seq, now);
+  }
+}
+
+static void sender_frame(Peer &peer, const Frame &frame, uint32_t total_chunks, uint32_t now) {
+  if (frame.opcode == ACK) {
+    if (peer.send.on_ack(frame.seq, frame.bitmap, total_chunks, now))
+      peer.downlink.send(now, Frame{0, END, 0, 0, 0, {}});
+  } else if (frame.opcode == RESULT) {
+    peer.send.on_result(frame.error == RESULT_OK);
+  }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+struct Scenario {
+  const char *name;
+  uint32_t image_size;
+  size_t num_peers;
+  double loss;
+  uint32_t seed;
+  void (*setup)(std::vector<Peer> &peers){nullptr};
+  /// Per peer: whether its outcome is right. Defaults to a verified image and a sender that saw it succeed.
+  bool (*check)(const Peer &peer, const std::vector<uint8_t> &image){nullptr};
+  /// Cut the receiver's uplink once it has written this many bytes, 0 for never
+  uint32_t cut_uplink_after{0};
+};
+
+static bool updated(const Peer &peer, const std::vector<uint8_t> &image) {
+  return peer.send.phase() == ESPNowOTASendSession::PHASE_DONE && peer.written == image && peer.rebooted;
+}
+
+static bool run(const Scenario &scenario) {
+  std::mt19937 rng(scenario.seed);
+  std::vector<uint8_t> image(scenario.image_size);
+  for (auto &byte : image)
+    byte = static_cast<uint8_t>(rng());
+  const uint32_t total_chunks = (scenario.image_size + ESPNOW_OTA_CHUNK_SIZE - 1) / ESPNOW_OTA_CHUNK_SIZE;
+
+  std::vector<Peer> peers;
+  peers.reserve(scenario.num_peers);
+  for (size_t i = 0; i < scenario.num_peers; i++) {
+    peers.emplace_back(rng, scenario.loss);
+    peers.back().send.start(START);
+  }
+  if (scenario.setup != nullptr)
+    scenario.setup(peers);
+
+  // Run until every sender session is finished, every pending reboot has happened and the air is clear
+  uint32_t now = START;
+  for (; now < DEADLINE; now++) {
+    bool running = false;
+    for (auto &peer : peers) {
+      if (peer.reboot_ms != 0 && now >= peer.reboot_ms) {
+        // The new firmware starts with a fresh receiver
+        peer.receive = ESPNowOTAReceiveSession{};
+        peer.reboot_ms = 0;
+        peer.rebooted = true;
+      }
+      if (scenario.cut_uplink_after != 0 && peer.written.size() >= scenario.cut_uplink_after)
+        peer.uplink.cut();
+      Frame frame;
+      while (peer.downlink.receive(now, &frame))
+        receive_frame(peer, frame, scenario.image_size, now);
+      while (peer.uplink.receive(now, &frame))
+        sender_frame(peer, frame, total_chunks, now);
+      if (!peer.send.is_finished())
+        service_sender(peer, image, total_chunks, now);
+      if (peer.send.is_finished() && peer.finished_ms == 0)
+        peer.finished_ms = now;
+      running |= !peer.send.is_finished() || peer.reboot_ms != 0 || !peer.downlink.idle() || !peer.uplink.idle();
+    }
+    if (!running)
+      break;
+  }
+
+  bool ok = now < DEADLINE;
+  for (size_t i = 0; i < peers.size(); i++) {
+    const Peer &peer = peers[i];
+    const bool right = scenario.check != nullptr ? scenario.check(peer, image) : updated(peer, image);
+    if (!right) {
+      std::printf("  peer %zu: phase %u, %zu of %u bytes written, %s, finished at %u ms\n", i, peer.send.phase(),
+                  peer.written.size(), scenario.image_size, peer.rebooted ? "rebooted" : "not rebooted",
+                  peer.finished_ms - START);
+      ok = false;
+    }
+  }
+  std::printf("%s: %s, %u bytes to %zu peers at %.0f%% loss (seed %u) in %u ms\n", ok ? "PASS" : "FAIL",
+              scenario.name, scenario.image_size, scenario.num_peers, scenario.loss * 100.0, scenario.seed,
+              now - START);
+  return ok;
+}
+
+int main() {
+  bool ok = true;
+  ok &= run({"lossless", ESPNOW_OTA_CHUNK_SIZE * 100, 1, 0.0, 1});
+  ok &= run({"lossy", 64 * 1024 + 17, 3, 0.05, 2});
+  ok &= run({"lossy", 64 * 1024 + 17, 3, 0.20, 3});
+  ok &= run({"lossy", 150 * 1024 + 1, 4, 0.35, 4});
+  ok &= run({"lossy", ESPNOW_OTA_CHUNK_SIZE - 1, 2, 0.50, 5});
+  ok &= run({"lossy", 1, 1, 0.10, 6});
+
+  // BEGIN and its ack get lost, the sender repeats BEGIN and the receiver repeats the ack
+  ok &= run({"lost BEGIN and ack", 16 * 1024, 1, 0.0, 7, [](std::vector<Peer> &peers) {
+               peers[0].downlink.drop_next(BEGIN, 2);
+               peers[0].uplink.drop_next(ACK, 1);
+             }});
+  // END gets lost, the sender repeats it
+  ok &= run({"lost END", 16 * 1024, 1, 0.0, 8, [](std::vector<Peer> &peers) { peers[0].downlink.drop_next(END, 2); }});
+  // The image is flashed but RESULT gets lost: the repeated END must be answered with the stored result before the
+  // receiver reboots, or the sender would report a failed push
+  ok &= run({"lost RESULT", 16 * 1024, 2, 0.0, 9, [](std::vector<Peer> &peers) {
+               peers[0].uplink.drop_next(RESULT, 1);
+               peers[1].uplink.drop_next(RESULT, 2);
+             }});
+  // Verification fails and RESULT gets lost: the sender still learns the error instead of timing out
+  ok &= run({"failed update, lost RESULT", 16 * 1024, 1, 0.0, 10,
+             [](std::vector<Peer> &peers) {
+               peers[0].corrupt = true;
+               peers[0].uplink.drop_next(RESULT, 1);
+             },
+             [](const Peer &peer, const std::vector<uint8_t> &) {
+               return peer.send.phase() == ESPNowOTASendSession::PHASE_FAILED && !peer.rebooted &&
+                      peer.finished_ms - START < ESPNOW_OTA_TARGET_TIMEOUT;
+             }});
+  // The receiver goes silent halfway: the sender gives up after the target timeout and its ABORT ends the session
+  ok &= run({"abort", 64 * 1024, 1, 0.0, 11, nullptr,
+             [](const Peer &peer, const std::vector<uint8_t> &) {
+               return peer.send.phase() == ESPNowOTASendSession::PHASE_FAILED && !peer.receive.is_active() &&
+                      peer.downlink.sent(ABORT) == 1 && peer.finished_ms - START > ESPNOW_OTA_TARGET_TIMEOUT;
+             },
+             32 * 1024});
+
+  // A second sender is refused while a transfer runs, and the running one carries on
+  {
+    ESPNowOTAReceiveSession rx;
+    const uint8_t other[ESPNOW_OTA_ADDR_LEN] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0x02};
+    rx.start(SENDER, SESSION, 1000, ESPNOW_OTA_CHUNK_SIZE);
+    const bool busy = rx.on_begin(other, SESSION) == ESPNowOTAReceiveSession::BEGIN_BUSY &&
+                      rx.on_begin(SENDER, SESSION) == ESPNowOTAReceiveSession::BEGIN_REPEAT_ACK &&
+                      rx.on_begin(SENDER, SESSION + 1) == ESPNowOTAReceiveSession::BEGIN_RESTART &&
+                      rx.on_end(other, SESSION) == ESPNowOTAReceiveSession::END_IGNORE &&
+                      rx.on_end(SENDER, SESSION) == ESPNowOTAReceiveSession::END_ACK;
+    rx.finish(RESULT_OK);
+    const bool finished = rx.on_end(SENDER, SESSION) == ESPNowOTAReceiveSession::END_REPEAT_RESULT &&
+                          rx.on_end(other, SESSION) == ESPNowOTAReceiveSession::END_IGNORE &&
+                          rx.on_end(SENDER, SESSION + 1) == ESPNowOTAReceiveSession::END_IGNORE &&
+                          rx.on_begin(other, SESSION) == ESPNowOTAReceiveSession::BEGIN_START;
+    rx.start(other, SESSION, 1000, ESPNOW_OTA_CHUNK_SIZE);
+    const bool replaced = rx.on_end(SENDER, SESSION) == ESPNowOTAReceiveSession::END_IGNORE;
+    std::printf("%s: receiver session rules\n", busy && finished && replaced ? "PASS" : "FAIL");
+    ok &= busy && finished && replaced;
+  }
+  return ok ? 0 : 1;
+}
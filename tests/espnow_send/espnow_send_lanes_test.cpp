@@ -0,0 +1,265 @@
+// Stress test of the ESP-NOW transmit path with the worker task, built with ThreadSanitizer and AddressSanitizer.
+//
+// Two std::threads stand in for the main loop and the worker task of espnow_component.cpp and share what those
+// share: the send request and send done queues, one producer and one consumer each way, and the peer schedule
+// table, which the main loop rewrites as frames arrive while the worker consults it for every lane it serves. The
+// send lanes belong to the worker alone. Every packet must come back to the main loop exactly once.
+
+#include "../../components/espnow_switch/espnow/espnow_send_lanes.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+using esphome::espnow::ESPNowPeerSchedules;
+using esphome::espnow::ESPNowSendLanes;
+
+static constexpr size_t POOL_SIZE = 16;        // as MAX_ESP_NOW_SEND_QUEUE_SIZE
+static constexpr size_t NUM_PEERS = 10;        // More than MAX_ESP_NOW_SEND_LANES, so lanes run out
+static constexpr uint32_t STALE_MS = 200;      // Schedules expire quickly so idle peers drain
+static constexpr uint8_t THRESHOLD = 3;        // Failed sends before quarantine
+static constexpr uint32_t QUARANTINE_MS = 5;   // Short, so deferred lanes drain within the test
+static constexpr uint32_t PACKETS = 5000;      // Sends issued per run
+static constexpr uint32_t DRAIN_MS = 10000;    // Time allowed for the last packets to come back
+
+enum Status : uint8_t {
+  STATUS_NONE,
+  STATUS_DELIVERED,
+  STATUS_FAILED,
+  STATUS_SUPERSEDED,
+  STATUS_EVICTED,
+  STATUS_EXPIRED,
+  STATUS_NO_LANE,
+  STATUS_QUARANTINED,
+  STATUS_DROPPED,     // Queued when the peer was deleted
+  STATUS_DROP_DONE,   // The delete request itself
+  STATUS_COUNT,
+};
+
+static const char *const STATUS_NAMES[STATUS_COUNT] = {"none",    "delivered", "failed",      "superseded", "evicted",
+                                                       "expired", "no lane",   "quarantined", "dropped",    "drops"};
+
+/// The fields ESPNowSendLanes needs from ESPNowSendPacket, plus what the worker hands back to the main loop
+struct Packet {
+  uint8_t address_[esphome::espnow::ESPNOW_LANE_ADDR_LEN]{0};
+  Packet *next_{nullptr};
+  uint32_t supersede_key_{0};
+  uint32_t deadline_{0};
+  bool drop_lane_{false};
+  Status status_{STATUS_NONE};
+  uint32_t serial{0};
+};
+
+/// Stand-in for ESPHome's LockFreeQueue: a ring of pointers with one producer and one consumer
+template<typename T, size_t SIZE> class LockFreeQueue {
+ public:
+  bool push(T *element) {
+    const size_t tail = this->tail_.load(std::memory_order_relaxed);
+    if (tail - this->head_.load(std::memory_order_acquire) == SIZE)
+      return false;
+    this->buffer_[tail % SIZE] = element;
+    this->tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+  T *pop() {
+    const size_t head = this->head_.load(std::memory_order_relaxed);
+    if (head == this->tail_.load(std::memory_order_acquire))
+      return nullptr;
+    T *element = this->buffer_[head % SIZE];
+    this->head_.store(head + 1, std::memory_order_release);
+    return element;
+  }
+
+ protected:
+  T *buffer_[SIZE]{};
+  std::atomic<size_t> head_{0};
+  std::atomic<size_t> tail_{0};
+};
+
+static uint32_t millis() {
+  static const auto START = std::chrono::steady_clock::now();
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - START).count());
+}
+
+struct Shared {
+  LockFreeQueue<Packet, POOL_SIZE> send_request_queue;
+  LockFreeQueue<Packet, POOL_SIZE> send_done_queue;
+  ESPNowPeerSchedules peer_schedules;
+  std::atomic<bool> stop{false};
+};
+
+/// Worker task: queue requests on the lanes, transmit one packet at a time and report it back, like
+/// ESPNowComponent::worker_task_(), queue_packet_(), send_() and process_send_report_()
+static void worker(Shared &shared, bool shed, uint32_t seed) {
+  using Lanes = ESPNowSendLanes<Packet>;
+  Lanes lanes;
+  std::mt19937 rng(seed);
+  auto complete = [&shared](Packet *packet, Status status) {
+    packet->status_ = status;
+    if (!shared.send_done_queue.push(packet))
+      std::printf("  send done queue overflow\n");
+  };
+  auto complete_all = [&complete](Packet *packets, Status status) {
+    while (packets != nullptr) {
+      Packet *next = packets->next_;
+      packets->next_ = nullptr;
+      complete(packets, status);
+      packets = next;
+    }
+  };
+
+  while (!shared.stop.load(std::memory_order_acquire)) {
+    const uint32_t now = millis();
+    if (lanes.current() != nullptr) {
+      // The driver's send report for the packet in flight, a quarter of them lost
+      Lanes::Lane *lane;
+      Packet *sent = lanes.finish(&lane);
+      const bool success = rng() % 4 != 0;
+      if (lane != nullptr &&
+          lanes.report(lane, success, true, now, THRESHOLD, QUARANTINE_MS) == Lanes::OUTCOME_QUARANTINED && shed)
+        complete_all(lanes.take(lane), STATUS_QUARANTINED);
+      complete(sent, success ? STATUS_DELIVERED : STATUS_FAILED);
+    }
+
+    Packet *packet = shared.send_request_queue.pop();
+    while (packet != nullptr) {
+      if (packet->drop_lane_) {
+        complete_all(lanes.drop(packet->address_), STATUS_DROPPED);
+        complete(packet, STATUS_DROP_DONE);
+      } else {
+        Packet *displaced;
+        switch (lanes.enqueue(packet, now, shed, &displaced)) {
+          case Lanes::NO_LANE:
+            complete(packet, STATUS_NO_LANE);
+            break;
+          case Lanes::QUARANTINED:
+            complete(packet, STATUS_QUARANTINED);
+            break;
+          case Lanes::QUEUED_SUPERSEDED:
+            complete(displaced, STATUS_SUPERSEDED);
+            break;
+          case Lanes::QUEUED_EVICTED:
+            complete(displaced, STATUS_EVICTED);
+            break;
+          default:
+            break;
+        }
+      }
+      packet = shared.send_request_queue.pop();
+    }
+
+    if (lanes.current() == nullptr) {
+      lanes.next(
+          now, [&shared](const uint8_t *peer, uint32_t t) { return shared.peer_schedules.is_awake(peer, t, STALE_MS); },
+          [&complete](Packet *expired) { complete(expired, STATUS_EXPIRED); });
+    }
+    std::this_thread::yield();
+  }
+}
+
+static void set_peer(uint8_t *address, size_t peer) {
+  const uint8_t base[esphome::espnow::ESPNOW_LANE_ADDR_LEN] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0x00};
+  memcpy(address, base, sizeof(base));
+  address[5] = static_cast<uint8_t>(peer);
+}
+
+/// Main loop: issue sends and peer deletions from a fixed pool, churn the peer schedules like arriving schedule
+/// announcements and frames do, and take completed packets back
+static bool run(bool shed, uint32_t seed) {
+  Shared shared;
+  std::vector<Packet> storage(POOL_SIZE);
+  std::vector<Packet *> pool;
+  for (auto &packet : storage)
+    pool.push_back(&packet);
+  std::vector<uint8_t> completions(PACKETS, 0);
+  uint32_t counts[STATUS_COUNT]{};
+  bool ok = true;
+
+  std::thread worker_thread(worker, std::ref(shared), shed, seed + 1);
+  std::mt19937 rng(seed);
+  uint32_t issued = 0;
+  uint32_t returned = 0;
+  auto take_done = [&]() {
+    Packet *packet = shared.send_done_queue.pop();
+    while (packet != nullptr) {
+      if (packet->next_ != nullptr || packet->status_ == STATUS_NONE || ++completions[packet->serial] != 1) {
+        std::printf("  packet %u came back twice or still linked\n", packet->serial);
+        ok = false;
+      }
+      counts[packet->status_]++;
+      packet->status_ = STATUS_NONE;
+      pool.push_back(packet);
+      returned++;
+      packet = shared.send_done_queue.pop();
+    }
+  };
+
+  while (issued < PACKETS) {
+    take_done();
+    const uint32_t now = millis();
+    if (!pool.empty()) {
+      Packet *packet = pool.back();
+      pool.pop_back();
+      set_peer(packet->address_, rng() % NUM_PEERS);
+      packet->next_ = nullptr;
+      packet->drop_lane_ = rng() % 64 == 0;
+      packet->supersede_key_ = rng() % 3 == 0 ? 1 + rng() % 2 : 0;
+      packet->deadline_ = rng() % 4 == 0 ? (now + rng() % 20) | 1 : 0;
+      packet->serial = issued++;
+      shared.send_request_queue.push(packet);
+    }
+
+    // Schedule announcements, including switches to always-on that clear the slot under the worker's feet
+    uint8_t peer[esphome::espnow::ESPNOW_LANE_ADDR_LEN];
+    set_peer(peer, rng() % NUM_PEERS);
+    switch (rng() % 4) {
+      case 0:
+        shared.peer_schedules.announce(peer, 20, 5, rng() % 20, now);
+        break;
+      case 1:
+        shared.peer_schedules.announce(peer, 0, 0, 0, now);
+        break;
+      default:
+        shared.peer_schedules.heard(peer, now);
+        break;
+    }
+  }
+
+  // Every peer always on again, so whatever is still queued drains
+  for (size_t i = 0; i < NUM_PEERS; i++) {
+    uint8_t peer[esphome::espnow::ESPNOW_LANE_ADDR_LEN];
+    set_peer(peer, i);
+    shared.peer_schedules.announce(peer, 0, 0, 0, millis());
+  }
+  const uint32_t drain_start = millis();
+  while (returned < issued && millis() - drain_start < DRAIN_MS) {
+    take_done();
+    std::this_thread::yield();
+  }
+  shared.stop.store(true, std::memory_order_release);
+  worker_thread.join();
+  take_done();
+
+  if (returned != issued || pool.size() != POOL_SIZE) {
+    std::printf("  %u of %u packets came back\n", returned, issued);
+    ok = false;
+  }
+  if (counts[STATUS_DELIVERED] == 0)
+    ok = false;
+  std::printf("%s: %s quarantine (seed %u):", ok ? "PASS" : "FAIL", shed ? "shed" : "defer", seed);
+  for (uint8_t status = STATUS_DELIVERED; status < STATUS_COUNT; status++)
+    std::printf(" %s=%u", STATUS_NAMES[status], counts[status]);
+  std::printf("\n");
+  return ok;
+}
+
+int main() {
+  bool ok = true;
+  ok &= run(true, 1);
+  ok &= run(false, 2);
+  return ok ? 0 : 1;
+}
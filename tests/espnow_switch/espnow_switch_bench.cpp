@@ -0,0 +1,199 @@
+// Host benchmark of the espnow_switch command path under loss and latency profiles.
+//
+// A simulated controller runs the retry and confirmation state machine espnow_switch.cpp is built on
+// (ESPNowSwitchCommand) against a simulated device speaking the state sync protocol: every attempt is one ESP-NOW
+// frame whose send callback reports the MAC-level outcome, the device executes the commands it receives and pushes
+// a REPORT echoing the latest command id, and a REPORT for the current command confirms it. The loop runs at
+// ESPHome's default interval, so confirmations are seen with the same granularity as on a device.
+//
+// For each profile the statistics the sensors publish are printed next to exact percentiles computed from every
+// sample, which shows how far the fixed-bucket histogram estimates are off. The run fails if a command is lost
+// from the counters or the state machine breaks its own limits.
+
+#include "../../components/espnow_switch/espnow_switch_command.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <random>
+#include <vector>
+
+using esphome::espnow_switch::ESPNowSwitchCommand;
+using esphome::espnow_switch::ESPNowSwitchStats;
+
+static constexpr uint32_t LOOP_INTERVAL_US = 16000;  // ESPHome's default loop interval
+static constexpr uint32_t AIRTIME_US = 1000;         // Send callback of a delivered frame
+static constexpr uint32_t MAC_RETRY_US = 6000;       // Send callback after the driver's retries ran out
+static constexpr uint8_t RETRY_COUNT = 12;           // espnow_switch defaults
+static constexpr uint32_t RETRY_INTERVAL_MS = 300;
+
+struct Profile {
+  const char *name;
+  double loss;           // Chance a command frame is not delivered
+  double reply_loss;     // Chance a REPORT is lost
+  uint32_t latency_us;   // One-way latency
+  uint32_t jitter_us;    // Uniform extra latency per frame
+  uint32_t process_us;   // Device time from command to REPORT
+  uint32_t spacing_ms;   // Time between commands
+  uint32_t commands;
+};
+
+static const Profile PROFILES[] = {
+    {"clean", 0.00, 0.00, 2000, 500, 1000, 5000, 2000},
+    {"typical", 0.05, 0.05, 3000, 4000, 2000, 5000, 2000},
+    {"lossy", 0.30, 0.30, 5000, 10000, 2000, 5000, 2000},
+    {"slow device", 0.05, 0.05, 20000, 200000, 100000, 5000, 2000},
+    {"peer down", 1.00, 1.00, 3000, 0, 0, 5000, 200},
+    {"rapid toggling", 0.20, 0.20, 3000, 5000, 2000, 150, 2000},
+};
+
+/// Timed events in the order they become due
+class Events {
+ public:
+  void at(uint64_t due_us, std::function<void()> event) { this->events_.emplace(due_us, std::move(event)); }
+  void run_until(uint64_t now_us) {
+    while (!this->events_.empty() && this->events_.begin()->first <= now_us) {
+      auto event = std::move(this->events_.begin()->second);
+      this->events_.erase(this->events_.begin());
+      event();
+    }
+  }
+  bool empty() const { return this->events_.empty(); }
+
+ protected:
+  std::multimap<uint64_t, std::function<void()>> events_;
+};
+
+static float exact_percentile(std::vector<uint32_t> samples_us, float p) {
+  if (samples_us.empty())
+    return NAN;
+  std::sort(samples_us.begin(), samples_us.end());
+  const size_t index = std::min(samples_us.size() - 1, static_cast<size_t>(p * samples_us.size()));
+  return samples_us[index] / 1000.0f;
+}
+
+static bool run(const Profile &profile, uint32_t seed) {
+  std::mt19937 rng(seed);
+  auto chance = [&rng](double p) { return std::uniform_real_distribution<double>(0.0, 1.0)(rng) < p; };
+  auto delay = [&rng, &profile]() {
+    return profile.latency_us + (profile.jitter_us == 0 ? 0 : static_cast<uint32_t>(rng() % profile.jitter_us));
+  };
+
+  ESPNowSwitchCommand command;
+  command.set_retry(RETRY_COUNT, RETRY_INTERVAL_MS);
+  Events events;
+  // Simulated time; the controller sees it through micros() and millis(), which wrap like on a device
+  uint64_t now_us = 0;
+  auto micros = [&now_us]() { return static_cast<uint32_t>(now_us); };
+  auto millis = [&now_us]() { return static_cast<uint32_t>(now_us / 1000); };
+  uint16_t command_id = 0;         // As ESPNowSwitch::command_id_
+  uint16_t device_command = 0;     // Latest command id the device executed
+  std::vector<uint32_t> samples;   // Every confirmed latency, for exact percentiles
+  uint32_t attempts_max = 0;
+  bool ok = true;
+
+  // As ESPNowSwitch::complete_command_()
+  auto complete = [&](bool success) {
+    const uint32_t start_us = command.get_start_us();
+    const uint8_t attempts = command.get_attempts();
+    if (!command.complete(success, micros()))
+      return;
+    attempts_max = std::max<uint32_t>(attempts_max, attempts);
+    if (success)
+      samples.push_back(micros() - start_us);
+  };
+  // As ESPNowSwitch::send_command_(): one frame, the device answers with a REPORT if it gets it
+  auto send = [&]() {
+    if (command.is_in_flight())
+      return;
+    command.sent(millis());
+    const uint32_t seq = command.get_seq();
+    const uint16_t id = command_id;
+    const bool delivered = !chance(profile.loss);
+    events.at(now_us + (delivered ? AIRTIME_US : MAC_RETRY_US), [&command, seq]() { command.send_done(seq); });
+    if (!delivered)
+      return;
+    const uint64_t report_us = now_us + delay() + profile.process_us;
+    events.at(report_us, [&, id, report_us]() {
+      device_command = id;
+      if (chance(profile.reply_loss))
+        return;
+      const uint16_t echoed = device_command;
+      // As ESPNowSwitch::on_frame(): a REPORT echoing the current command confirms it
+      events.at(report_us + delay(), [&, echoed]() {
+        if (command.is_pending() && echoed == command_id)
+          complete(true);
+      });
+    });
+  };
+  // As ESPNowSwitch::write_state()
+  auto write_state = [&]() {
+    command.start(micros());
+    if (++command_id == 0)
+      command_id = 1;
+    send();
+  };
+
+  uint32_t issued = 0;
+  uint64_t next_command_us = 0;
+  // Frames and reports are processed in the loop, like the ESP-NOW receive queue
+  for (; issued < profile.commands || command.is_pending() || !events.empty(); now_us += LOOP_INTERVAL_US) {
+    events.run_until(now_us);
+    if (issued < profile.commands && now_us >= next_command_us) {
+      write_state();
+      issued++;
+      next_command_us = now_us + profile.spacing_ms * 1000ULL;
+    }
+    // As ESPNowSwitch::loop()
+    switch (command.poll(millis())) {
+      case ESPNowSwitchCommand::ACTION_GIVE_UP:
+        complete(false);
+        break;
+      case ESPNowSwitchCommand::ACTION_SEND:
+        send();
+        break;
+      default:
+        break;
+    }
+  }
+
+  const ESPNowSwitchStats &stats = command.get_stats();
+  const uint32_t counted = stats.get_successes() + stats.get_failures() + stats.get_superseded();
+  if (counted != issued) {
+    std::printf("  %u commands issued, %u counted\n", issued, counted);
+    ok = false;
+  }
+  if (attempts_max > RETRY_COUNT) {
+    std::printf("  a command was sent %u times\n", attempts_max);
+    ok = false;
+  }
+  if (samples.size() != stats.get_successes()) {
+    std::printf("  %zu confirmations seen, %u recorded\n", samples.size(), stats.get_successes());
+    ok = false;
+  }
+
+  std::printf("%s: %-14s loss %3.0f%%/%3.0f%%, latency %5.1f+%5.1f ms: %4u ok %4u failed %4u superseded, "
+              "success %5.1f%%\n",
+              ok ? "PASS" : "FAIL", profile.name, profile.loss * 100.0, profile.reply_loss * 100.0,
+              profile.latency_us / 1000.0, profile.jitter_us / 1000.0, stats.get_successes(), stats.get_failures(),
+              stats.get_superseded(), stats.get_success_rate());
+  std::printf("      latency mean %7.1f ms, p50 %7.1f ms (exact %7.1f), p95 %7.1f ms (exact %7.1f), "
+              "attempts mean %.2f\n",
+              stats.get_mean_latency_ms(), stats.get_latency_percentile_ms(0.5f), exact_percentile(samples, 0.5f),
+              stats.get_latency_percentile_ms(0.95f), exact_percentile(samples, 0.95f), stats.get_mean_attempts());
+  std::printf("      attempts");
+  for (size_t i = 0; i < ESPNowSwitchStats::ATTEMPT_BUCKETS; i++)
+    std::printf(" %zu%s:%u", i + 1, i == ESPNowSwitchStats::ATTEMPT_BUCKETS - 1 ? "+" : "", stats.get_attempts_bucket(i));
+  std::printf("\n");
+  return ok;
+}
+
+int main() {
+  bool ok = true;
+  uint32_t seed = 1;
+  for (const auto &profile : PROFILES)
+    ok &= run(profile, seed++);
+  return ok ? 0 : 1;
+}
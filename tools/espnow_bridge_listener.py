@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""Receive and print ESP-NOW frames forwarded by the espnow_bridge component.
+
+Stands in for the upstream server while testing a bridge on a Linux host:
+
+    python3 tools/espnow_bridge_listener.py --port 18888
+
+With ``listen_port:`` set on the bridge, frames can be sent the other way too:
+
+    python3 tools/espnow_bridge_listener.py --device 192.168.1.50:18889 \\
+        --send AA:BB:CC:DD:EE:FF 48656c6c6f
+
+The bridge only accepts datagrams from ``remote_address`` (or ``allowed_remotes:``)
+and drops frames that start with the component protocol magic (E5 4E).
+
+Datagram layout (little endian), identical in both directions:
+
+    offset  size  field
+    0       2     magic "EB"
+    2       1     version (1)
+    3       1     record count
+    4       2     sequence, counts datagrams per direction
+    6       ...   records
+
+Each record:
+
+    0       6     address (source on uplink, destination on downlink)
+    6       1     rssi (int8, dBm, uplink only)
+    7       1     flags (bit 0: broadcast)
+    8       1     payload size
+    9       n     payload
+"""
+
+import argparse
+import socket
+import struct
+import sys
+
+MAGIC = b"EB"
+VERSION = 1
+HEADER = struct.Struct("<2sBBH")
+RECORD = struct.Struct("<6sbBB")
+FLAG_BROADCAST = 0x01
+
+
+def format_mac(address):
+    return ":".join(f"{b:02X}" for b in address)
+
+
+def parse_mac(text):
+    parts = text.split(":")
+    if len(parts) != 6:
+        raise argparse.ArgumentTypeError(f"invalid MAC address {text}")
+    return bytes(int(p, 16) for p in parts)
+
+
+def decode(datagram):
+    """Return (sequence, [(address, rssi, flags, payload), ...]) or None for foreign datagrams."""
+    if len(datagram) < HEADER.size:
+        return None
+    magic, version, count, sequence = HEADER.unpack_from(datagram, 0)
+    if magic != MAGIC or version != VERSION:
+        return None
+    records = []
+    offset = HEADER.size
+    for _ in range(count):
+        if offset + RECORD.size > len(datagram):
+            break
+        address, rssi, flags, size = RECORD.unpack_from(datagram, offset)
+        offset += RECORD.size
+        records.append((address, rssi, flags, datagram[offset : offset + size]))
+        offset += size
+    return sequence, records
+
+
+def encode(sequence, records):
+    out = bytearray(HEADER.pack(MAGIC, VERSION, len(records), sequence & 0xFFFF))
+    for address, flags, payload in records:
+        out += RECORD.pack(address, 0, flags, len(payload))
+        out += payload
+    return bytes(out)
+
+
+def listen(port):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(("", port))
+    print(f"Listening on UDP port {port}")
+    expected = {}
+    while True:
+        datagram, sender = sock.recvfrom(2048)
+        decoded = decode(datagram)
+        if decoded is None:
+            print(f"{sender[0]}: ignoring {len(datagram)} byte datagram")
+            continue
+        sequence, records = decoded
+        last = expected.get(sender[0])
+        if last is not None and sequence != last:
+            print(f"{sender[0]}: lost {(sequence - last) & 0xFFFF} datagrams")
+        expected[sender[0]] = (sequence + 1) & 0xFFFF
+        for address, rssi, flags, payload in records:
+            kind = "bcast" if flags & FLAG_BROADCAST else "ucast"
+            print(
+                f"{sender[0]} #{sequence} {format_mac(address)} {rssi:4d}dBm {kind} "
+                f"[{len(payload)}] {payload.hex()}"
+            )
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--port", type=int, default=18888, help="UDP port to listen on")
+    parser.add_argument("--device", help="bridge host:listen_port for --send")
+    parser.add_argument(
+        "--send",
+        nargs=2,
+        metavar=("MAC", "HEX"),
+        help="send one frame through the bridge, FF:FF:FF:FF:FF:FF broadcasts",
+    )
+    args = parser.parse_args()
+
+    if args.send:
+        if not args.device:
+            parser.error("--send requires --device")
+        host, _, port = args.device.rpartition(":")
+        address = parse_mac(args.send[0])
+        flags = FLAG_BROADCAST if address == b"\xff" * 6 else 0
+        datagram = encode(0, [(address, flags, bytes.fromhex(args.send[1]))])
+        with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as sock:
+            sock.sendto(datagram, (host, int(port)))
+        print(f"Sent {len(datagram)} bytes to {args.device}")
+        return 0
+
+    try:
+        listen(args.port)
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+"""Convert an ESP-NOW capture dump from the device log into a pcap file.
+
+Enable ``capture:`` under ``espnow:`` and run the ``espnow.capture.dump`` action.
+Save the log (serial or ``esphome logs``) and convert it:
+
+    python3 tools/espnow_capture_to_pcap.py device.log capture.pcap
+
+Every frame is written with link type USER0 (147). The packet bytes are the raw
+capture record:
+
+    offset  size  field
+    0       4     timestamp_us (little endian, micros() on the device)
+    4       6     peer address (source for RX, destination for TX)
+    10      1     rssi (int8, dBm, RX only)
+    11      1     direction (0 = RX, 1 = TX, 2 = TX status)
+    12      1     status (0 = ok, 1 = failed)
+    13      1     original payload size
+    14      n     payload, truncated to the configured snap length
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+LINKTYPE_USER0 = 147
+HEADER_SIZE = 14
+
+BEGIN_RE = re.compile(r"ESPNOWCAP-BEGIN snap=(\d+)")
+RECORD_RE = re.compile(r"ESPNOWCAP:([0-9a-fA-F]+)")
+
+
+def parse_records(lines):
+    """Yield raw record bytes from the most recent dump in the log."""
+    dumps = []
+    current = None
+    for line in lines:
+        if BEGIN_RE.search(line):
+            current = []
+            dumps.append(current)
+            continue
+        match = RECORD_RE.search(line)
+        if match and current is not None:
+            current.append(bytes.fromhex(match.group(1)))
+    return dumps[-1] if dumps else []
+
+
+def write_pcap(records, out):
+    out.write(struct.pack("<IHHiIII", 0xA1B2C3D4, 2, 4, 0, 0, 65535, LINKTYPE_USER0))
+    # micros() wraps every ~71 minutes; unwrap so timestamps stay monotonic
+    offset = 0
+    last = None
+    for raw in records:
+        if len(raw) < HEADER_SIZE:
+            continue
+        (timestamp,) = struct.unpack_from("<I", raw, 0)
+        if last is not None and timestamp < last:
+            offset += 1 << 32
+        last = timestamp
+        timestamp += offset
+        orig_len = HEADER_SIZE + raw[13]
+        out.write(
+            struct.pack(
+                "<IIII",
+                timestamp // 1_000_000,
+                timestamp % 1_000_000,
+                len(raw),
+                orig_len,
+            )
+        )
+        out.write(raw)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", help="log file containing an ESPNOWCAP dump, '-' for stdin")
+    parser.add_argument("output", help="pcap file to write")
+    args = parser.parse_args()
+
+    if args.log == "-":
+        records = parse_records(sys.stdin)
+    else:
+        with open(args.log, encoding="utf-8", errors="replace") as f:
+            records = parse_records(f)
+    if not records:
+        print("No ESPNOWCAP dump found", file=sys.stderr)
+        return 1
+
+    with open(args.output, "wb") as out:
+        write_pcap(records, out)
+    print(f"Wrote {len(records)} frames to {args.output}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())